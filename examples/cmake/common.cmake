@@ -140,6 +140,7 @@ set(SYSTEM_LINK_LIBS
     onnxruntime
     vx_tidl_rt
     pthread
+    rt
     dl
     yaml-cpp
     stdc++fs
@@ -156,11 +157,20 @@ set(SYSTEM_LINK_LIBS
     onnxruntime
     vx_tidl_rt
     pthread
+    rt
     dl
     yaml-cpp
     )
 endif()  
 
+# The XNNPACK delegate of the TFLite runner needs a tensorflow-lite library
+# built with XNNPACK and its dependencies
+option(TFL_ENABLE_XNNPACK "Enable the TFLite XNNPACK delegate option" OFF)
+if(TFL_ENABLE_XNNPACK)
+  add_definitions(-DTFL_ENABLE_XNNPACK)
+  list(APPEND SYSTEM_LINK_LIBS XNNPACK pthreadpool cpuinfo clog)
+endif()
+
 # Function for building a node:
 # ARG0: app name
 # ARG1: source list
@@ -183,6 +193,7 @@ function(build_app)
                           ${COMMON_LINK_LIBS}
                           ${TARGET_LINK_LIBS}
                           ${SYSTEM_LINK_LIBS}
+                          runner
                           post_process
                           pre_process
                           utils
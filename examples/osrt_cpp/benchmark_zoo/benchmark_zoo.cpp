@@ -0,0 +1,229 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include "benchmark_zoo.h"
+
+/* Default report of benchmark_zoo when --report is not given. */
+#define DEFAULT_REPORT_PATH "benchmark_zoo.json"
+
+/**
+ *  \brief collects the model directories, the ones holding a param.yaml,
+ *         under root. Model directories are not searched further.
+ *  \param  root directory to search
+ *  \param  dirs filled with the model directories, in name order
+ */
+static void findModels(const std::string &root, std::vector<std::string> *dirs)
+{
+    DIR *dir = opendir(root.c_str());
+    if (dir == nullptr)
+        return;
+    bool hasParams = false;
+    std::vector<std::string> subdirs;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..")
+            continue;
+        std::string path = root + "/" + name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+            continue;
+        if (S_ISDIR(st.st_mode))
+            subdirs.push_back(path);
+        else if (name == "param.yaml")
+            hasParams = true;
+    }
+    closedir(dir);
+    if (hasParams)
+    {
+        dirs->push_back(root);
+        return;
+    }
+    std::sort(subdirs.begin(), subdirs.end());
+    for (const std::string &subdir : subdirs)
+        findModels(subdir, dirs);
+}
+
+/**
+ *  \brief loads and benchmarks the model of one directory
+ *  \param  dir model directory
+ *  \param  s user input options, -z is replaced by dir
+ *  \param  inputs input images
+ *  \param  record filled with the results, status failed when the model
+ *          could not be loaded or run
+ */
+static void benchmarkModel(const std::string &dir, Settings s, const std::vector<std::string> &inputs,
+                           BenchRecord *record)
+{
+    record->modelPath = dir;
+    s.model_zoo_path = dir;
+    ModelInfo model(dir);
+    model.m_labelsPath = s.labels_file_path;
+    if (model.initialize() == RETURN_FAIL)
+    {
+        LOG_ERROR("Failed to initialize model %s\n", dir.c_str());
+        return;
+    }
+    if (model.m_infConfig.modelFile.empty() && model.m_infConfig.rtType != "tidlrt")
+    {
+        LOG_ERROR("no model file name in %s\n", dir.c_str());
+        return;
+    }
+    if (tidl::runner::runBenchmark(&model, &s, inputs, record) == RETURN_FAIL)
+        LOG_ERROR("Failed to benchmark %s\n", dir.c_str());
+}
+
+int main(int argc, char *argv[])
+{
+    Settings s;
+    /* only the timings matter, results are written with -o json or binary */
+    s.output_mode = OUTPUT_MODE_NONE;
+    if (parseArgs(argc, argv, &s) == RETURN_FAIL)
+    {
+        LOG_ERROR("Failed to parse the args\n");
+        return RETURN_FAIL;
+    }
+    dumpArgs(&s);
+    logSetLevel((LogLevel)s.log_level);
+    if (s.model_zoo_path.empty())
+    {
+        LOG_ERROR("-z must give the root of the model zoo\n");
+        return RETURN_FAIL;
+    }
+    if (s.output_mode == OUTPUT_MODE_IMAGE)
+    {
+        LOG_WARN("results are not rendered, use -o json or binary to keep them\n");
+        s.output_mode = OUTPUT_MODE_NONE;
+    }
+
+    std::vector<std::string> models;
+    findModels(s.model_zoo_path, &models);
+    if (models.empty())
+    {
+        LOG_ERROR("no param.yaml under %s\n", s.model_zoo_path.c_str());
+        return RETURN_FAIL;
+    }
+
+    /* real inputs when given, a noise image otherwise */
+    std::vector<std::string> inputs;
+    std::string synthetic;
+    if (!s.synthetic_input && getInputList(&s, &inputs) == RETURN_FAIL)
+        return RETURN_FAIL;
+    if (inputs.empty())
+    {
+        if (tidl::runner::createSyntheticInput(tidl::runner::SYNTHETIC_WIDTH, tidl::runner::SYNTHETIC_HEIGHT,
+                                               &synthetic) == RETURN_FAIL)
+            return RETURN_FAIL;
+        inputs.push_back(synthetic);
+    }
+
+    /* every model is loaded, warmed up and run in this process, up to
+    parallel_models of them at a time */
+    std::vector<BenchRecord> records(models.size());
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+    size_t num_threads = std::min((size_t)s.parallel_models, models.size());
+    LOG_INFO("benchmarking %zu models, %zu at a time\n", models.size(), num_threads);
+    for (size_t t = 0; t < num_threads; t++)
+    {
+        threads.emplace_back([&] {
+            for (size_t i = next++; i < models.size(); i = next++)
+            {
+                LOG_INFO("[%zu/%zu] %s\n", i + 1, models.size(), models[i].c_str());
+                benchmarkModel(models[i], s, inputs, &records[i]);
+                /* the buffers of this model would count in the peak
+                memory of the next ones */
+                SharedTensorPool::get().trim();
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+    if (!synthetic.empty())
+        unlink(synthetic.c_str());
+
+    BenchReport report;
+    size_t failed = 0;
+    printf("\n%-60s %-9s %-7s %10s %10s %10s %12s\n", "model", "runtime", "status", "load ms", "p50 ms", "p99 ms",
+           "infer/s");
+    for (const BenchRecord &record : records)
+    {
+        report.add(record);
+        double p50 = 0, p99 = 0;
+        for (const std::pair<std::string, LatencySummary> &stage : record.stages)
+        {
+            if (stage.first == "inference")
+            {
+                p50 = stage.second.p50Ms;
+                p99 = stage.second.p99Ms;
+            }
+        }
+        printf("%-60s %-9s %-7s %10.1f %10.3f %10.3f %12.2f\n", record.modelPath.c_str(), record.runtime.c_str(),
+               record.status.c_str(), record.loadMs, p50, p99, record.inferencesPerS);
+        if (record.status != "ok")
+            failed++;
+    }
+    printf("%zu models, %zu failed\n\n", records.size(), failed);
+    if (report.write(s.report_path.empty() ? DEFAULT_REPORT_PATH : s.report_path) == RETURN_FAIL)
+        return RETURN_FAIL;
+    return failed == 0 ? RETURN_SUCCESS : RETURN_FAIL;
+}
@@ -0,0 +1,333 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Throughput benchmark of the shared memory frame ring against a unix socket,
+ * with a synthetic producer. In the default mode the process forks a
+ * consumer and streams the same frames through both transports; with
+ * --produce 1 it only produces frames into a ring, to feed a runner started
+ * with --frame_ring. */
+
+/* Standard headers. */
+#include <algorithm>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+/* Module headers. */
+#include "../runner/frame_ring.h"
+#include "../runner/server_protocol.h"
+#include "../utils/include/utility_functs.h"
+
+using namespace tidl::runner;
+using std::string;
+using std::vector;
+
+/**
+ *  \brief benchmark options
+ */
+struct BenchOptions
+{
+    string name{"/edgeai_frame_ring"};
+    uint32_t width{1280};
+    uint32_t height{720};
+    uint32_t slots{4};
+    long frames{1000};
+    double rate{0};
+    bool produce{false};
+};
+
+static void displayUsage()
+{
+    printf("frame_ring_bench [options]\n"
+           "--name, -n: shared memory name of the ring, /edgeai_frame_ring by default\n"
+           "--width, -w: frame width, 1280 by default\n"
+           "--height, -e: frame height, 720 by default\n"
+           "--slots, -s: ring slots, 4 by default\n"
+           "--frames, -c: frames to send, 1000 by default\n"
+           "--rate, -r: frames per second, 0 to send as fast as possible\n"
+           "--produce, -p: [0|1] only produce into the ring, for a runner started with --frame_ring\n");
+}
+
+/**
+ *  \brief fills a frame with a pattern moving with the frame number, as a
+ *         camera would write every byte
+ */
+static void fillFrame(uint8_t *data, size_t size, uint64_t frameId)
+{
+    memset(data, (int)(frameId & 0xff), size);
+    data[0] = (uint8_t)(frameId >> 8);
+}
+
+/**
+ *  \brief reads every cache line of a frame, the least a consumer does
+ */
+static uint64_t touchFrame(const uint8_t *data, size_t size)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; i += 64)
+        sum += data[i];
+    return sum;
+}
+
+/**
+ *  \brief waits until the time frame n is due at the given rate
+ */
+static void pace(uint64_t startUs, long n, double rate)
+{
+    if (rate <= 0)
+        return;
+    int64_t wait = (int64_t)(startUs + n * 1000000 / rate) - (int64_t)FrameRing::nowUs();
+    if (wait > 0)
+        usleep(wait);
+}
+
+static void printStats(const char *transport, vector<double> *latencies, uint64_t startUs, size_t frameBytes)
+{
+    if (latencies->empty())
+    {
+        printf("%-8s no frame received\n", transport);
+        return;
+    }
+    double wall_s = (FrameRing::nowUs() - startUs) / 1000000.0;
+    std::sort(latencies->begin(), latencies->end());
+    double sum = 0;
+    for (double us : *latencies)
+        sum += us;
+    size_t n = latencies->size();
+    printf("%-8s %8zu frames %10.1f frames/s %10.1f MB/s   latency us: mean %9.1f p50 %9.1f p99 %9.1f max %9.1f\n",
+           transport, n, n / wall_s, n * frameBytes / wall_s / 1e6, sum / n, (*latencies)[n / 2],
+           (*latencies)[std::min(n - 1, n * 99 / 100)], latencies->back());
+}
+
+static int produceRing(const BenchOptions &o, FrameRing *ring, size_t frameBytes)
+{
+    uint64_t start = FrameRing::nowUs();
+    for (long n = 0; n < o.frames; n++)
+    {
+        pace(start, n, o.rate);
+        uint8_t *slot = ring->acquireSlot(-1);
+        fillFrame(slot, frameBytes, n);
+        FrameInfo info;
+        info.frameId = n;
+        info.format = FRAME_FORMAT_RGB;
+        info.width = o.width;
+        info.height = o.height;
+        info.length = frameBytes;
+        if (RETURN_FAIL == ring->publish(info))
+            return RETURN_FAIL;
+    }
+    ring->close();
+    return RETURN_SUCCESS;
+}
+
+static void consumeRing(const BenchOptions &o, size_t frameBytes)
+{
+    FrameRing ring;
+    if (RETURN_FAIL == ring.attach(o.name, 5000))
+        exit(EXIT_FAILURE);
+    vector<double> latencies;
+    uint64_t checksum = 0;
+    uint64_t start = FrameRing::nowUs();
+    FrameInfo info;
+    const uint8_t *data;
+    while ((data = ring.acquireFrame(&info, -1)) != nullptr)
+    {
+        checksum += touchFrame(data, info.length);
+        latencies.push_back(FrameRing::nowUs() - info.timestampUs);
+        ring.release();
+    }
+    printStats("shm ring", &latencies, start, frameBytes);
+    printf("         consumer slept %llu times, checksum %llu\n", (unsigned long long)ring.getWaits(),
+           (unsigned long long)checksum);
+    exit(EXIT_SUCCESS);
+}
+
+/**
+ *  \brief sends the same frames over a unix socket pair, the copy the ring
+ *         avoids
+ */
+static void runSocket(const BenchOptions &o, size_t frameBytes)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+    {
+        perror("socketpair");
+        return;
+    }
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+        vector<uint8_t> frame(frameBytes);
+        vector<double> latencies;
+        uint64_t checksum = 0;
+        uint64_t start = FrameRing::nowUs();
+        FrameInfo info;
+        while (recvAll(fds[1], &info, sizeof(info)) && recvAll(fds[1], frame.data(), info.length))
+        {
+            checksum += touchFrame(frame.data(), info.length);
+            latencies.push_back(FrameRing::nowUs() - info.timestampUs);
+        }
+        printStats("socket", &latencies, start, frameBytes);
+        exit(EXIT_SUCCESS);
+    }
+    close(fds[1]);
+    /* the producer renders into its own buffer then sends it */
+    vector<uint8_t> frame(frameBytes);
+    uint64_t start = FrameRing::nowUs();
+    for (long n = 0; n < o.frames; n++)
+    {
+        pace(start, n, o.rate);
+        fillFrame(frame.data(), frameBytes, n);
+        FrameInfo info;
+        info.frameId = n;
+        info.format = FRAME_FORMAT_RGB;
+        info.width = o.width;
+        info.height = o.height;
+        info.length = frameBytes;
+        info.timestampUs = FrameRing::nowUs();
+        if (!sendAll(fds[0], &info, sizeof(info)) || !sendAll(fds[0], frame.data(), frameBytes))
+            break;
+    }
+    close(fds[0]);
+    waitpid(pid, nullptr, 0);
+}
+
+int main(int argc, char *argv[])
+{
+    BenchOptions o;
+    static struct option long_options[] = {
+        {"name", required_argument, nullptr, 'n'},
+        {"width", required_argument, nullptr, 'w'},
+        {"height", required_argument, nullptr, 'e'},
+        {"slots", required_argument, nullptr, 's'},
+        {"frames", required_argument, nullptr, 'c'},
+        {"rate", required_argument, nullptr, 'r'},
+        {"produce", required_argument, nullptr, 'p'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}};
+    int c;
+    while ((c = getopt_long(argc, argv, "n:w:e:s:c:r:p:h", long_options, nullptr)) != -1)
+    {
+        switch (c)
+        {
+        case 'n':
+            o.name = optarg;
+            break;
+        case 'w':
+            o.width = strtoul(optarg, nullptr, 10);
+            break;
+        case 'e':
+            o.height = strtoul(optarg, nullptr, 10);
+            break;
+        case 's':
+            o.slots = strtoul(optarg, nullptr, 10);
+            break;
+        case 'c':
+            o.frames = strtol(optarg, nullptr, 10);
+            break;
+        case 'r':
+            o.rate = strtod(optarg, nullptr);
+            break;
+        case 'p':
+            o.produce = strtol(optarg, nullptr, 10);
+            break;
+        default:
+            displayUsage();
+            return EXIT_FAILURE;
+        }
+    }
+    const size_t frameBytes = (size_t)o.width * o.height * 3;
+    if (frameBytes == 0 || o.slots == 0)
+    {
+        displayUsage();
+        return EXIT_FAILURE;
+    }
+
+    FrameRing ring;
+    if (RETURN_FAIL == ring.create(o.name, o.slots, frameBytes))
+        return EXIT_FAILURE;
+    if (o.produce)
+    {
+        printf("producing %ld frames of %ux%u into %s\n", o.frames, o.width, o.height, o.name.c_str());
+        return produceRing(o, &ring, frameBytes) == RETURN_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    printf("%ld frames of %ux%u RGB, %zu bytes, %u slots, %s\n", o.frames, o.width, o.height, frameBytes,
+           ring.numSlots(), o.rate > 0 ? (std::to_string(o.rate) + " frames/s").c_str() : "as fast as possible");
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+        consumeRing(o, frameBytes);
+    int status = produceRing(o, &ring, frameBytes);
+    waitpid(pid, nullptr, 0);
+    printf("         producer slept %llu times\n", (unsigned long long)ring.getWaits());
+    fflush(stdout);
+    runSocket(o, frameBytes);
+    return status == RETURN_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
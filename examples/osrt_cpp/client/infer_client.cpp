@@ -0,0 +1,389 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Small client of the runners' --serve mode. It sends images to the server,
+ * by path or as decoded RGB frames, and doubles as a load test: with several
+ * connections and requests it reports the throughput and the end to end
+ * latency next to the inference time measured by the server. */
+
+/* Standard headers. */
+#include <algorithm>
+#include <atomic>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/* Third-party headers. */
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+/* Module headers. */
+#include "../post_process/result_writer.h"
+#include "../runner/server_protocol.h"
+
+using namespace tidl::runner;
+using std::string;
+using std::vector;
+
+/**
+ *  \brief connection to the inference server
+ */
+class InferClient
+{
+public:
+    InferClient() : m_fd(-1) {}
+
+    ~InferClient()
+    {
+        if (m_fd >= 0)
+            close(m_fd);
+    }
+
+    /**
+     * Connects to the server.
+     *
+     * @param path unix socket the server listens on
+     * @returns true on success
+     */
+    bool connectTo(const string &path)
+    {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_fd < 0 || connect(m_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+        {
+            fprintf(stderr, "Could not connect to %s: %s\n", path.c_str(), strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Sends one request and waits for its reply.
+     *
+     * @param kind SERVER_REQUEST_IMAGE_PATH or SERVER_REQUEST_RGB_FRAME
+     * @param modelId model index on the server
+     * @param width frame width, 0 for a path
+     * @param height frame height, 0 for a path
+     * @param data path or packed RGB frame
+     * @param size bytes of data
+     * @param reply filled with the reply header
+     * @param records filled with the result record
+     * @returns true when a reply was received, check reply->status
+     */
+    bool infer(ServerRequestKind kind, uint32_t modelId, uint32_t width, uint32_t height,
+               const void *data, size_t size, ServerReplyHeader *reply, string *records)
+    {
+        ServerRequestHeader request;
+        request.magic = TI_SERVER_REQUEST_MAGIC;
+        request.version = TI_SERVER_PROTOCOL_VERSION;
+        request.kind = kind;
+        request.modelId = modelId;
+        request.width = width;
+        request.height = height;
+        request.length = size;
+        if (!sendAll(m_fd, &request, sizeof(request)) || !sendAll(m_fd, data, size) ||
+            !recvAll(m_fd, reply, sizeof(*reply)) || reply->magic != TI_SERVER_REPLY_MAGIC)
+            return false;
+        records->resize(reply->length);
+        return recvAll(m_fd, &(*records)[0], records->size());
+    }
+
+private:
+    int m_fd;
+};
+
+/**
+ *  \brief an input, by path or decoded
+ */
+struct Input
+{
+    string path;
+    cv::Mat rgb;
+};
+
+static void displayUsage()
+{
+    printf("infer_client [options] image...\n"
+           "--socket, -s: server socket, %s by default\n"
+           "--model, -m: model index on the server, 0 for its -z model\n"
+           "--image, -i: input image, may be repeated, the other arguments are images too\n"
+           "--frames, -f: [0|1] send decoded RGB frames instead of paths\n"
+           "--requests, -n: number of requests, cycling over the images, one per image by default\n"
+           "--connections, -p: connections sending requests in parallel\n"
+           "--verbose, -v: [0|1] print every result record\n",
+           TI_SERVER_DEFAULT_SOCKET);
+}
+
+/**
+ *  \brief prints a result record as received from the server
+ */
+static void printRecords(const string &input, const string &records)
+{
+    using namespace tidl::postprocess;
+    if (records.size() < sizeof(ResultRecordHeader))
+    {
+        /* JSON records are printed as they are */
+        printf("%s: %s", input.c_str(), records.c_str());
+        return;
+    }
+    ResultRecordHeader header;
+    memcpy(&header, records.data(), sizeof(header));
+    if (header.magic != TI_RESULT_RECORD_MAGIC)
+    {
+        printf("%s: %s", input.c_str(), records.c_str());
+        return;
+    }
+    static const char *tasks[] = {"classification", "detection", "segmentation"};
+    printf("%s: %s, %u entries\n", input.c_str(), header.task < 3 ? tasks[header.task] : "unknown", header.count);
+    const char *entry = records.data() + sizeof(header) + header.inputLength;
+    const char *end = records.data() + records.size();
+    for (uint32_t i = 0; i < header.count; i++)
+    {
+        if (header.task == RESULT_TASK_CLASSIFICATION && entry + sizeof(ClassificationEntry) <= end)
+        {
+            ClassificationEntry e;
+            memcpy(&e, entry, sizeof(e));
+            printf("  class %d score %f\n", e.classId, e.score);
+            entry += sizeof(e);
+        }
+        else if (header.task == RESULT_TASK_DETECTION && entry + sizeof(DetectionEntry) <= end)
+        {
+            DetectionEntry e;
+            memcpy(&e, entry, sizeof(e));
+            printf("  class %d score %f box %f %f %f %f\n", e.classId, e.score, e.box[0], e.box[1], e.box[2],
+                   e.box[3]);
+            entry += sizeof(e);
+        }
+    }
+}
+
+static double nowMs()
+{
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+    string socketPath = TI_SERVER_DEFAULT_SOCKET;
+    uint32_t modelId = 0;
+    bool frames = false;
+    long numRequests = 0;
+    int numConnections = 1;
+    bool verbose = false;
+    vector<string> paths;
+
+    static struct option long_options[] = {
+        {"socket", required_argument, nullptr, 's'},
+        {"model", required_argument, nullptr, 'm'},
+        {"image", required_argument, nullptr, 'i'},
+        {"frames", required_argument, nullptr, 'f'},
+        {"requests", required_argument, nullptr, 'n'},
+        {"connections", required_argument, nullptr, 'p'},
+        {"verbose", required_argument, nullptr, 'v'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}};
+    int c;
+    while ((c = getopt_long(argc, argv, "s:m:i:f:n:p:v:h", long_options, nullptr)) != -1)
+    {
+        switch (c)
+        {
+        case 's':
+            socketPath = optarg;
+            break;
+        case 'm':
+            modelId = strtoul(optarg, nullptr, 10);
+            break;
+        case 'i':
+            paths.push_back(optarg);
+            break;
+        case 'f':
+            frames = strtol(optarg, nullptr, 10);
+            break;
+        case 'n':
+            numRequests = strtol(optarg, nullptr, 10);
+            break;
+        case 'p':
+            numConnections = std::max(1, (int)strtol(optarg, nullptr, 10));
+            break;
+        case 'v':
+            verbose = strtol(optarg, nullptr, 10);
+            break;
+        default:
+            displayUsage();
+            return EXIT_FAILURE;
+        }
+    }
+    for (int i = optind; i < argc; i++)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+    {
+        displayUsage();
+        return EXIT_FAILURE;
+    }
+
+    vector<Input> inputs(paths.size());
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        /* the server resolves relative paths from its own directory */
+        char *absolute = realpath(paths[i].c_str(), nullptr);
+        inputs[i].path = absolute != nullptr ? absolute : paths[i];
+        free(absolute);
+        if (frames)
+        {
+            cv::Mat bgr = cv::imread(paths[i], cv::IMREAD_COLOR);
+            if (bgr.empty())
+            {
+                fprintf(stderr, "Could not decode %s\n", paths[i].c_str());
+                return EXIT_FAILURE;
+            }
+            cv::cvtColor(bgr, inputs[i].rgb, cv::COLOR_BGR2RGB);
+        }
+    }
+    if (numRequests <= 0)
+        numRequests = inputs.size();
+
+    /* every connection takes the next request until all are sent */
+    std::atomic<long> next(0);
+    std::atomic<long> failed(0);
+    vector<vector<double>> latencies(numConnections);
+    vector<double> inferMs(numConnections, 0);
+    double start = nowMs();
+    vector<std::thread> threads;
+    for (int t = 0; t < numConnections; t++)
+    {
+        threads.emplace_back([&, t] {
+            InferClient client;
+            if (!client.connectTo(socketPath))
+            {
+                failed++;
+                return;
+            }
+            ServerReplyHeader reply;
+            string records;
+            for (long n = next++; n < numRequests; n = next++)
+            {
+                const Input &input = inputs[n % inputs.size()];
+                double sent = nowMs();
+                bool received = frames ? client.infer(SERVER_REQUEST_RGB_FRAME, modelId, input.rgb.cols,
+                                                      input.rgb.rows, input.rgb.data,
+                                                      input.rgb.total() * input.rgb.elemSize(), &reply, &records)
+                                       : client.infer(SERVER_REQUEST_IMAGE_PATH, modelId, 0, 0, input.path.data(),
+                                                      input.path.size(), &reply, &records);
+                if (!received)
+                {
+                    fprintf(stderr, "connection %d lost\n", t);
+                    failed++;
+                    return;
+                }
+                if (reply.status != 0)
+                {
+                    failed++;
+                    continue;
+                }
+                latencies[t].push_back(nowMs() - sent);
+                inferMs[t] += reply.inferMs;
+                if (verbose)
+                    printRecords(input.path, records);
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+    double wall_ms = nowMs() - start;
+
+    vector<double> all;
+    double infer_ms = 0;
+    for (int t = 0; t < numConnections; t++)
+    {
+        all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+        infer_ms += inferMs[t];
+    }
+    if (all.empty())
+    {
+        fprintf(stderr, "no request succeeded\n");
+        return EXIT_FAILURE;
+    }
+    std::sort(all.begin(), all.end());
+    double sum_ms = 0;
+    for (double ms : all)
+        sum_ms += ms;
+    printf("%zu requests, %ld failed, %d connections, %f requests/s\n", all.size(), failed.load(), numConnections,
+           all.size() * 1000 / wall_ms);
+    printf("latency ms: mean %f, p50 %f, p99 %f, max %f, inference on the server %f\n", sum_ms / all.size(),
+           all[all.size() / 2], all[std::min(all.size() - 1, all.size() * 99 / 100)], all.back(),
+           infer_ms / all.size());
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
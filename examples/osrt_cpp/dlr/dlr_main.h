@@ -63,45 +63,13 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef DLR_MAIN_H_
 #define DLR_MAIN_H_
 
-#include <iostream>
-#include <cstdio>
-#include <fstream>
-#include <numeric>
-#include <algorithm>
-#include <functional>
-#include <vector>
-#include <limits>
-#include <stdexcept>
-#include <dlr.h>
-#include <libgen.h>
-#include <utility>
-#include <thread>
-#include <chrono>
-#include <mutex>
-#include <pthread.h>
-
-#include <memory.h>
-#include <unistd.h>
-#include <getopt.h>
-#include <opencv2/core/core.hpp>
-#include <opencv2/highgui/highgui.hpp>
-#include <opencv2/imgproc/imgproc.hpp>
-#include "opencv2/imgcodecs.hpp"
-#include "opencv2/imgproc/imgproc_c.h"
-
-#include "itidl_rt.h"
-#include "post_process/post_process.h"
-#include "pre_process/pre_process.h"
+#include "runner/runner.h"
 #include "utils/include/arg_parsing.h"
-#include "utils/include/utility_functs.h"
 #include "utils/include/ti_logger.h"
 #include "utils/include/model_info.h"
 
 using namespace tidl::arg_parsing;
 using namespace tidl::modelInfo;
-using namespace tidl::utility_functs;
 using namespace tidl::utils;
-using namespace tidl::postprocess;
-using namespace tidl::preprocess;
 
 #endif //DLR_MAIN_H
\ No newline at end of file
@@ -63,32 +63,13 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef ONNX_EXAMPLES_MAIN_H_
 #define ONNX_EXAMPLES_MAIN_H_
 
-#include <getopt.h>
-#include <iostream>
-#include <cstdarg>
-#include <cstdio>
-#include <fstream>
-#include <string>
-#include <sys/time.h>
-#include <list>
-
-#include <onnxruntime/core/session/onnxruntime_cxx_api.h>
-#include <onnxruntime/core/providers/tidl/tidl_provider_factory.h>
-#include <onnxruntime/core/providers/cpu/cpu_provider_factory.h>
-
-#include "itidl_rt.h"
-#include "post_process/post_process.h"
-#include "pre_process/pre_process.h"
+#include "runner/runner.h"
 #include "utils/include/arg_parsing.h"
-#include "utils/include/utility_functs.h"
 #include "utils/include/ti_logger.h"
 #include "utils/include/model_info.h"
 
 using namespace tidl::arg_parsing;
 using namespace tidl::modelInfo;
-using namespace tidl::utility_functs;
 using namespace tidl::utils;
-using namespace tidl::postprocess;
-using namespace tidl::preprocess;
 
 #endif /* ONNX_EXAMPLES_MAIN_H_*/
\ No newline at end of file
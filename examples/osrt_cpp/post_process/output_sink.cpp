@@ -0,0 +1,268 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Third-party headers. */
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+/* Module headers. */
+#include "output_sink.h"
+
+namespace tidl
+{
+    namespace postprocess
+    {
+        using namespace tidl::arg_parsing;
+
+        OutputSink::OutputSink(int32_t maxPending) : m_maxPending(maxPending > 0 ? maxPending : 1),
+                                                     m_inFlight(0),
+                                                     m_stop(false),
+                                                     m_written(0),
+                                                     m_dropped(0),
+                                                     m_coalesced(0)
+        {
+            m_thread = std::thread(&OutputSink::run, this);
+        }
+
+        OutputSink::~OutputSink()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_workCond.notify_one();
+            m_thread.join();
+
+            if (m_dropped || m_coalesced)
+            {
+                LOG_WARN("output sink dropped %lu and coalesced %lu frames\n",
+                         (unsigned long)m_dropped, (unsigned long)m_coalesced);
+            }
+        }
+
+        void OutputSink::pushFrame(const cv::Mat &rgb,
+                                   const std::string &path,
+                                   ImageFormat format)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            /* a newer frame for the same file makes the pending one useless */
+            for (Item &item : m_queue)
+            {
+                if (!item.frame.empty() && item.path == path)
+                {
+                    item.frame = rgb;
+                    item.format = format;
+                    m_coalesced++;
+                    return;
+                }
+            }
+
+            if (m_queue.size() >= m_maxPending)
+            {
+                auto oldest = m_queue.end();
+                for (auto it = m_queue.begin(); it != m_queue.end(); ++it)
+                {
+                    if (!it->frame.empty())
+                    {
+                        oldest = it;
+                        break;
+                    }
+                }
+                if (oldest == m_queue.end())
+                {
+                    /* queue is full of records, which are never dropped */
+                    m_dropped++;
+                    return;
+                }
+                m_queue.erase(oldest);
+                m_dropped++;
+            }
+
+            m_queue.emplace_back();
+            Item &item = m_queue.back();
+            item.frame = rgb;
+            item.format = format;
+            item.path = path;
+            item.file = nullptr;
+            lock.unlock();
+            m_workCond.notify_one();
+        }
+
+        void OutputSink::pushRecord(FILE *file, std::string &record)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_spaceCond.wait(lock, [this] { return m_queue.size() < m_maxPending; });
+
+            m_queue.emplace_back();
+            Item &item = m_queue.back();
+            item.format = IMAGE_FORMAT_JPEG;
+            item.file = file;
+            item.record.swap(record);
+            record.clear();
+            lock.unlock();
+            m_workCond.notify_one();
+        }
+
+        void OutputSink::flush()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_spaceCond.wait(lock, [this] { return m_queue.empty() && m_inFlight == 0; });
+        }
+
+        uint64_t OutputSink::getWritten() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_written;
+        }
+
+        uint64_t OutputSink::getDropped() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_dropped;
+        }
+
+        uint64_t OutputSink::getCoalesced() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_coalesced;
+        }
+
+        void OutputSink::run()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true)
+            {
+                m_workCond.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+                if (m_queue.empty())
+                {
+                    /* stop requested and everything is written */
+                    break;
+                }
+
+                Item item = std::move(m_queue.front());
+                m_queue.pop_front();
+                m_inFlight++;
+                lock.unlock();
+                m_spaceCond.notify_all();
+
+                write(item);
+
+                lock.lock();
+                m_inFlight--;
+                m_written++;
+                if (m_queue.empty())
+                {
+                    m_spaceCond.notify_all();
+                }
+            }
+        }
+
+        void OutputSink::write(Item &item)
+        {
+            if (item.frame.empty())
+            {
+                if (fwrite(item.record.data(), 1, item.record.size(), item.file) != item.record.size())
+                {
+                    LOG_ERROR("Failed to write result record\n");
+                }
+                return;
+            }
+
+            if (!writeFrame(item))
+            {
+                LOG_ERROR("Saving the image %s, FAILED\n", item.path.c_str());
+            }
+        }
+
+        bool OutputSink::writeFrame(Item &item)
+        {
+            const cv::Mat &rgb = item.frame;
+            if (item.format == IMAGE_FORMAT_PPM)
+            {
+                /* PPM stores RGB as is, no conversion or encoding needed */
+                FILE *fp = fopen(item.path.c_str(), "wb");
+                if (fp == nullptr)
+                {
+                    return false;
+                }
+                bool ok = fprintf(fp, "P6\n%d %d\n255\n", rgb.cols, rgb.rows) > 0;
+                size_t rowBytes = rgb.cols * rgb.elemSize();
+                for (int32_t row = 0; ok && row < rgb.rows; row++)
+                {
+                    ok = fwrite(rgb.ptr(row), 1, rowBytes, fp) == rowBytes;
+                }
+                fclose(fp);
+                return ok;
+            }
+
+            cv::cvtColor(rgb, m_bgr, cv::COLOR_RGB2BGR);
+            if (item.format == IMAGE_FORMAT_PNG)
+            {
+                std::vector<int> params = {cv::IMWRITE_PNG_COMPRESSION, 1};
+                return cv::imwrite(item.path, m_bgr, params);
+            }
+            return cv::imwrite(item.path, m_bgr);
+        }
+
+    } // namespace tidl::postprocess
+}
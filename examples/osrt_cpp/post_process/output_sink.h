@@ -0,0 +1,192 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _OUTPUT_SINK_H_
+#define _OUTPUT_SINK_H_
+
+/* Standard headers. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/* Third-party headers. */
+#include <opencv2/core/core.hpp>
+
+/* Module headers. */
+#include "../utils/include/arg_parsing.h"
+
+namespace tidl
+{
+    namespace postprocess
+    {
+        /**
+         * \brief Background writer for rendered frames and result records.
+         *
+         * The inference thread only queues work; colour conversion, encoding
+         * and file IO run on a thread owned by the sink, so disk and encode
+         * latency do not show up in inference latency.
+         *
+         * The queue is bounded by maxPending. Under backpressure a frame
+         * replaces a frame still pending for the same path (coalesced),
+         * otherwise the oldest pending frame is dropped. Records are never
+         * dropped, pushRecord() blocks until there is room instead.
+         */
+        class OutputSink
+        {
+        public:
+            /**
+             * Constructor, starts the writer thread.
+             *
+             * @param maxPending number of queued items before frames are
+             *          coalesced or dropped and records block
+             */
+            explicit OutputSink(int32_t maxPending);
+
+            /** Destructor, writes everything still queued and joins the
+             * writer thread. */
+            ~OutputSink();
+
+            /**
+             * Queues an RGB frame to be converted, encoded and written.
+             * The frame data is shared, not copied, so the caller must not
+             * modify it afterwards; assigning a new image to the cv::Mat is
+             * fine.
+             *
+             * @param rgb frame in RGB order, CV_8UC3
+             * @param path output file
+             * @param format encoding of the file
+             */
+            void pushFrame(const cv::Mat &rgb,
+                           const std::string &path,
+                           tidl::arg_parsing::ImageFormat format);
+
+            /**
+             * Queues a record to be appended to file. The contents of record
+             * are taken and record is left empty.
+             *
+             * @param file open file owned by the caller, must stay open until
+             *          flush() returns
+             * @param record bytes to write
+             */
+            void pushRecord(FILE *file, std::string &record);
+
+            /** Blocks until everything queued so far has been written. */
+            void flush();
+
+            /** Number of frames and records written so far. */
+            uint64_t getWritten() const;
+
+            /** Number of frames dropped so far. */
+            uint64_t getDropped() const;
+
+            /** Number of frames replaced by a newer one for the same path. */
+            uint64_t getCoalesced() const;
+
+        private:
+            OutputSink(const OutputSink &) = delete;
+            OutputSink &operator=(const OutputSink &) = delete;
+
+            struct Item
+            {
+                /* frame to encode, empty for a record */
+                cv::Mat frame;
+                tidl::arg_parsing::ImageFormat format;
+                std::string path;
+
+                /* record to append to file */
+                FILE *file;
+                std::string record;
+            };
+
+            void run();
+            void write(Item &item);
+            bool writeFrame(Item &item);
+
+            size_t m_maxPending;
+            std::deque<Item> m_queue;
+
+            /* items taken by the writer thread but not yet written */
+            size_t m_inFlight;
+            bool m_stop;
+
+            mutable std::mutex m_mutex;
+            std::condition_variable m_workCond;
+            std::condition_variable m_spaceCond;
+
+            uint64_t m_written;
+            uint64_t m_dropped;
+            uint64_t m_coalesced;
+
+            /* BGR copy of the frame being encoded, reused between frames */
+            cv::Mat m_bgr;
+
+            std::thread m_thread;
+        };
+
+    } // namespace tidl::postprocess
+}
+
+#endif // _OUTPUT_SINK_H_
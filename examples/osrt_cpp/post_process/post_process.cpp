@@ -73,7 +73,8 @@ namespace tidl
         /**
          * Use OpenCV to do in-place update of a buffer with post processing
          * content like drawing bounding box around a detected object in the
-         * frame. Typically used for object classification models.
+         * frame and its class name above it. Typically used for object
+         * detection models.
          * Although OpenCV expects BGR data, this function adjusts the color
          * values so that the post processing can be done on a RGB buffer
          * without extra performance impact.
@@ -91,13 +92,18 @@ namespace tidl
         int overlayBoundingBox(cv::Mat *img, std::vector<std::vector<float>> *od_formatted_vec, ModelInfo *modelInfo)
         {
             cv::Scalar box_color = (20, 120, 20);
+            cv::Scalar text_color(200, 0, 0);
             int boxThickness = 2;
+            float txtSize = static_cast<float>((*img).cols) / TI_POSTPROC_DEFAULT_WIDTH;
+            TextRenderer &renderer = getTextRenderer();
+            const PostprocessImageConfig &config = modelInfo->m_postProcCfg;
             /* extracting index of x1x2y1y1format  [x1y1 x2y2 label score] */
-            std::vector<int32_t> format = modelInfo->m_postProcCfg.formatter;
+            std::vector<int32_t> format = config.formatter;
             int x1Index = format[0];
             int y1Index = format[1];
             int x2Index = format[2];
             int y2Index = format[3];
+            int labelIndex = format[4];
             /* hard coded colour of box */
             for (auto it = (*od_formatted_vec).begin(); it != (*od_formatted_vec).end(); ++it)
             {
@@ -109,6 +115,19 @@ namespace tidl
                 cv::Point topleft = cv::Point(xmin * (*img).cols, ymax * (*img).rows);
                 cv::Point bottomright = cv::Point(xmax * (*img).cols, ymin * (*img).rows);
                 cv::rectangle((*img), topleft, bottomright, box_color, boxThickness, cv::LINE_8);
+
+                /* label the box with the class name, the sprite of each class
+                name is rasterized only once */
+                if (config.classnames != nullptr)
+                {
+                    int32_t classId = config.getLabelIndex((int32_t)(*it)[labelIndex]);
+                    if (classId >= 0 && classId < config.numClassnames)
+                    {
+                        cv::Point org = cv::Point(xmin * (*img).cols, ymin * (*img).rows - boxThickness - 2);
+                        const char *name = config.classnames[classId];
+                        renderer.drawText((*img), name, strlen(name), org, txtSize, text_color);
+                    }
+                }
             }
             return RETURN_SUCCESS;
         }
@@ -269,6 +288,8 @@ namespace tidl
          *          representing the probability with which that class is detected and
          *          class index in this image.
          * @param labels labels in indexed form to print
+         * @param labelOffset offset added to the class index to get the line in
+         *          labels
          * @param outDataWidth
          * @param outDataHeight
          * @param N Number of results to be displayed
@@ -276,7 +297,8 @@ namespace tidl
          */
         uchar *overlayTopNClasses(uchar *frame,
                                   std::vector<std::pair<float, int>> &top_results,
-                                  std::vector<string> *labels,
+                                  const tidl::utils::LabelStore *labels,
+                                  int32_t labelOffset,
                                   int32_t outDataWidth,
                                   int32_t outDataHeight,
                                   int32_t N)
@@ -285,22 +307,26 @@ namespace tidl
             float txtSize = static_cast<float>(outDataWidth) / TI_POSTPROC_DEFAULT_WIDTH;
             int rowSize = 40 * outDataWidth / 500;
             Scalar text_color(200, 0, 0);
+            TextRenderer &renderer = getTextRenderer();
 
             Mat img = Mat(outDataHeight, outDataWidth, CV_8UC3, frame);
 
             std::string title = "Top " + std::to_string(N) + " detected classes:";
-            putText(img, title.c_str(), Point(5, 2 * rowSize),
-                    FONT_HERSHEY_SIMPLEX, txtSize, text_color, 1);
+            renderer.drawText(img, title, Point(5, 2 * rowSize), txtSize, text_color);
             int i = 0;
             for (auto result : top_results)
             {
                 const float confidence = result.first;
                 int index = result.second;
                 int32_t row = i + 3;
-                string str = std::to_string(confidence);
-                str.append((*labels)[index]);
-                putText(img, str, Point(5, row * rowSize),
-                        FONT_HERSHEY_SIMPLEX, txtSize, text_color, 1);
+                /* confidence changes every frame, draw it from the glyph
+                cache and the label from the string cache */
+                int32_t advance = renderer.drawGlyphs(img, std::to_string(confidence),
+                                                      Point(5, row * rowSize),
+                                                      txtSize, text_color);
+                tidl::utils::LabelView label = labels->line(index + labelOffset);
+                renderer.drawText(img, label.data, label.size, Point(5 + advance, row * rowSize),
+                                  txtSize, text_color);
                 i++;
             }
             return frame;
@@ -431,10 +457,13 @@ namespace tidl
          *  \param  modelInfo
          *  \param nboxes num of detections
          *  \param output_count num of output tensors
+         *  \param writer receives the boxes instead of img when headless
+         *  \param input path of the input image, used in the written record
          * @returns int status
          */
         int prepDetectionResult(cv::Mat *img, vector<vector<float>> *f_tensor_unformatted, vector<vector<int64_t>> tensor_shapes_vec,
-                                ModelInfo *modelInfo, size_t output_count, int nboxes)
+                                ModelInfo *modelInfo, size_t output_count, int nboxes,
+                                ResultWriter *writer, const string &input)
         {
             LOG_INFO("preparing detection result \n");
             vector<vector<float>> od_formatted_vec;
@@ -510,6 +539,10 @@ namespace tidl
                     }
                 }
             }
+            if (writer->isHeadless())
+            {
+                return writer->writeDetection(input, od_formatted_vec, modelInfo->m_postProcCfg);
+            }
             overlayBoundingBox(img, &od_formatted_vec, modelInfo);
             return RETURN_SUCCESS;
         }
@@ -81,6 +81,8 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "../utils/include/model_info.h"
 #include "../utils/include/utility_functs.h"
+#include "text_renderer.h"
+#include "result_writer.h"
 
 #define TI_POSTPROC_DEFAULT_WIDTH 1280
 
@@ -94,7 +96,8 @@ namespace tidl
         /**
          * Use OpenCV to do in-place update of a buffer with post processing
          * content like drawing bounding box around a detected object in the
-         * frame. Typically used for object classification models.
+         * frame and its class name above it. Typically used for object
+         * detection models.
          * Although OpenCV expects BGR data, this function adjusts the color
          * values so that the post processing can be done on a RGB buffer
          * without extra performance impact.
@@ -176,6 +179,8 @@ namespace tidl
          *          representing the probability with which that class is detected and
          *          class index in this image.
          * @param labels labels in indexed form to print
+         * @param labelOffset offset added to the class index to get the line in
+         *          labels
          * @param outDataWidth
          * @param outDataHeight
          * @param N Number of results to be displayed
@@ -183,7 +188,8 @@ namespace tidl
          */
         uchar *overlayTopNClasses(uchar *frame,
                                   std::vector<std::pair<float, int>> &top_results,
-                                  std::vector<string> *labels,
+                                  const tidl::utils::LabelStore *labels,
+                                  int32_t labelOffset,
                                   int32_t outDataWidth,
                                   int32_t outDataHeight,
                                   int32_t N);
@@ -232,10 +238,13 @@ namespace tidl
          *  \param  modelInfo
          *  \param nboxes num of detections
          *  \param output_count num of output tensors
+         *  \param writer receives the boxes instead of img when headless
+         *  \param input path of the input image, used in the written record
          * @returns int status
          */
         int prepDetectionResult(cv::Mat *img, vector<vector<float>> *f_tensor_unformatted, vector<vector<int64_t>> tensor_shapes_vec,
-                                ModelInfo *modelInfo, size_t output_count, int nboxes);
+                                ModelInfo *modelInfo, size_t output_count, int nboxes,
+                                ResultWriter *writer, const string &input);
     } // namespace tidl::postprocess
 
 #endif // _POST_PROCESS_H_
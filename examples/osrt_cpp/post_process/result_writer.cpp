@@ -0,0 +1,478 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <string.h>
+#include <cmath>
+
+/* Module headers. */
+#include "result_writer.h"
+
+namespace tidl
+{
+    namespace postprocess
+    {
+        using namespace tidl::arg_parsing;
+
+        /* Converts a class id read from the model output, false when it is
+        not finite or outside [0, TI_RESULT_MAX_CLASS_ID]. Converting a NaN
+        or out of range float to int is undefined. */
+        static inline bool toClassId(float value, int32_t *classId)
+        {
+            if (!std::isfinite(value) || value < 0 || value > TI_RESULT_MAX_CLASS_ID)
+            {
+                return false;
+            }
+            *classId = (int32_t)value;
+            return true;
+        }
+
+        template <class T>
+        static inline bool toClassId(T value, int32_t *classId)
+        {
+            if (value < 0 || value > TI_RESULT_MAX_CLASS_ID)
+            {
+                return false;
+            }
+            *classId = (int32_t)value;
+            return true;
+        }
+
+        ResultWriter::ResultWriter() : m_mode(OUTPUT_MODE_IMAGE),
+                                       m_file(nullptr),
+                                       m_sink(nullptr),
+                                       m_buffered(false)
+        {
+        }
+
+        ResultWriter::~ResultWriter()
+        {
+            close();
+        }
+
+        int32_t ResultWriter::open(OutputMode mode,
+                                   const std::string &modelName,
+                                   const std::string &path,
+                                   OutputSink *sink)
+        {
+            close();
+            m_mode = mode;
+            m_modelName = modelName;
+            m_sink = sink;
+            if (mode != OUTPUT_MODE_JSON && mode != OUTPUT_MODE_BINARY)
+            {
+                return RETURN_SUCCESS;
+            }
+
+            m_file = fopen(path.c_str(), mode == OUTPUT_MODE_JSON ? "w" : "wb");
+            if (m_file == nullptr)
+            {
+                LOG_ERROR("Could not create result file %s\n", path.c_str());
+                return RETURN_FAIL;
+            }
+            LOG_INFO("writing %s results to %s\n", getOutputModeName(mode), path.c_str());
+            return RETURN_SUCCESS;
+        }
+
+        int32_t ResultWriter::openBuffer(OutputMode mode, const std::string &modelName)
+        {
+            close();
+            if (mode != OUTPUT_MODE_JSON && mode != OUTPUT_MODE_BINARY)
+            {
+                LOG_ERROR("%s results cannot be buffered\n", getOutputModeName(mode));
+                return RETURN_FAIL;
+            }
+            m_mode = mode;
+            m_modelName = modelName;
+            m_sink = nullptr;
+            m_buffered = true;
+            m_buffer.clear();
+            return RETURN_SUCCESS;
+        }
+
+        void ResultWriter::takeRecords(std::string *records)
+        {
+            records->swap(m_buffer);
+            m_buffer.clear();
+        }
+
+        void ResultWriter::close()
+        {
+            m_buffered = false;
+            if (m_file != nullptr)
+            {
+                if (m_sink != nullptr)
+                {
+                    m_sink->flush();
+                }
+                fclose(m_file);
+                m_file = nullptr;
+            }
+        }
+
+        std::string ResultWriter::getDefaultPath(OutputMode mode,
+                                                 ImageFormat format,
+                                                 const std::string &modelName)
+        {
+            std::string path = "test_data/cpp_inference_out" + modelName;
+            switch (mode)
+            {
+            case OUTPUT_MODE_JSON:
+                return path + ".json";
+            case OUTPUT_MODE_BINARY:
+                return path + ".bin";
+            default:
+                return path + "." + getImageFormatName(format);
+            }
+        }
+
+        void ResultWriter::beginJson(const std::string &input, const char *task)
+        {
+            m_record.assign("{\"model\":\"");
+            appendEscaped(m_modelName.data(), m_modelName.size());
+            m_record.append("\",\"input\":\"");
+            appendEscaped(input.data(), input.size());
+            m_record.append("\",\"task\":\"");
+            m_record.append(task);
+            m_record.append("\"");
+        }
+
+        void ResultWriter::appendEscaped(const char *str, size_t length)
+        {
+            for (size_t i = 0; i < length; i++)
+            {
+                char c = str[i];
+                if (c == '"' || c == '\\')
+                {
+                    m_record.push_back('\\');
+                    m_record.push_back(c);
+                }
+                else if ((unsigned char)c < 0x20)
+                {
+                    char esc[8];
+                    snprintf(esc, sizeof(esc), "\\u%04x", (unsigned char)c);
+                    m_record.append(esc);
+                }
+                else
+                {
+                    m_record.push_back(c);
+                }
+            }
+        }
+
+        void ResultWriter::appendNumber(const char *prefix, float value)
+        {
+            char num[32];
+            m_record.append(prefix);
+            if (!std::isfinite(value))
+            {
+                /* JSON has no NaN or Infinity */
+                m_record.append("null");
+                return;
+            }
+            snprintf(num, sizeof(num), "%.6g", value);
+            m_record.append(num);
+        }
+
+        void ResultWriter::beginBinary(ResultTask task, uint32_t count, const std::string &input)
+        {
+            ResultRecordHeader header;
+            header.magic = TI_RESULT_RECORD_MAGIC;
+            header.version = TI_RESULT_RECORD_VERSION;
+            header.task = task;
+            header.count = count;
+            header.inputLength = input.size();
+            m_record.clear();
+            appendBinary(&header, sizeof(header));
+            appendBinary(input.data(), input.size());
+        }
+
+        void ResultWriter::appendBinary(const void *data, size_t size)
+        {
+            m_record.append(reinterpret_cast<const char *>(data), size);
+        }
+
+        int32_t ResultWriter::flushRecord()
+        {
+            if (m_mode == OUTPUT_MODE_JSON)
+            {
+                m_record.push_back('\n');
+            }
+            if (m_buffered)
+            {
+                m_buffer.append(m_record);
+                return RETURN_SUCCESS;
+            }
+            if (m_sink != nullptr)
+            {
+                m_sink->pushRecord(m_file, m_record);
+                return RETURN_SUCCESS;
+            }
+            if (fwrite(m_record.data(), 1, m_record.size(), m_file) != m_record.size())
+            {
+                LOG_ERROR("Failed to write result record\n");
+                return RETURN_FAIL;
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int32_t ResultWriter::writeClassification(const std::string &input,
+                                                  const std::vector<std::pair<float, int>> &topResults,
+                                                  const tidl::utils::LabelStore *labels,
+                                                  int32_t labelOffset)
+        {
+            if (!isWriting())
+            {
+                return RETURN_SUCCESS;
+            }
+
+            if (m_mode == OUTPUT_MODE_JSON)
+            {
+                char num[64];
+                beginJson(input, "classification");
+                m_record.append(",\"topN\":[");
+                for (size_t i = 0; i < topResults.size(); i++)
+                {
+                    snprintf(num, sizeof(num), "%s{\"id\":%d",
+                             i ? "," : "", topResults[i].second);
+                    m_record.append(num);
+                    appendNumber(",\"score\":", topResults[i].first);
+                    if (labels != nullptr)
+                    {
+                        tidl::utils::LabelView label = labels->line(topResults[i].second + labelOffset);
+                        m_record.append(",\"label\":\"");
+                        appendEscaped(label.data, label.size);
+                        m_record.append("\"");
+                    }
+                    m_record.append("}");
+                }
+                m_record.append("]}");
+            }
+            else
+            {
+                beginBinary(RESULT_TASK_CLASSIFICATION, topResults.size(), input);
+                for (const auto &result : topResults)
+                {
+                    ClassificationEntry entry;
+                    entry.classId = result.second;
+                    entry.score = result.first;
+                    appendBinary(&entry, sizeof(entry));
+                }
+            }
+            return flushRecord();
+        }
+
+        int32_t ResultWriter::writeDetection(const std::string &input,
+                                             const std::vector<std::vector<float>> &odFormattedVec,
+                                             const tidl::modelInfo::PostprocessImageConfig &config)
+        {
+            if (!isWriting())
+            {
+                return RETURN_SUCCESS;
+            }
+
+            /* element order within each box [x1 y1 x2 y2 label score] */
+            const std::vector<int32_t> &format = config.formatter;
+            const int32_t boxIndex[4] = {format[0], format[1], format[2], format[3]};
+            const int32_t labelIndex = format[4];
+            const int32_t scoreIndex = format[5];
+
+            if (m_mode == OUTPUT_MODE_JSON)
+            {
+                char num[64];
+                beginJson(input, "detection");
+                m_record.append(",\"boxes\":[");
+                for (size_t i = 0; i < odFormattedVec.size(); i++)
+                {
+                    const std::vector<float> &det = odFormattedVec[i];
+                    int32_t label = -1;
+                    toClassId(det[labelIndex], &label);
+                    snprintf(num, sizeof(num), "%s{\"id\":%d", i ? "," : "", label);
+                    m_record.append(num);
+                    appendNumber(",\"score\":", det[scoreIndex]);
+                    appendNumber(",\"box\":[", det[boxIndex[0]]);
+                    appendNumber(",", det[boxIndex[1]]);
+                    appendNumber(",", det[boxIndex[2]]);
+                    appendNumber(",", det[boxIndex[3]]);
+                    m_record.append("]");
+                    int32_t classId = (label < 0) ? -1 : config.getLabelIndex(label);
+                    if (config.classnames != nullptr && classId >= 0 && classId < config.numClassnames)
+                    {
+                        const char *name = config.classnames[classId];
+                        m_record.append(",\"label\":\"");
+                        appendEscaped(name, strlen(name));
+                        m_record.append("\"");
+                    }
+                    m_record.append("}");
+                }
+                m_record.append("]}");
+            }
+            else
+            {
+                beginBinary(RESULT_TASK_DETECTION, odFormattedVec.size(), input);
+                for (const auto &det : odFormattedVec)
+                {
+                    DetectionEntry entry;
+                    for (int32_t k = 0; k < 4; k++)
+                    {
+                        entry.box[k] = det[boxIndex[k]];
+                    }
+                    entry.score = det[scoreIndex];
+                    entry.classId = -1;
+                    toClassId(det[labelIndex], &entry.classId);
+                    appendBinary(&entry, sizeof(entry));
+                }
+            }
+            return flushRecord();
+        }
+
+        template <class T>
+        int32_t ResultWriter::writeSegmentation(const std::string &input,
+                                                const T *classes,
+                                                int32_t width,
+                                                int32_t height)
+        {
+            if (!isWriting())
+            {
+                return RETURN_SUCCESS;
+            }
+
+            /* reduce the mask to per class pixel counts */
+            m_histogram.clear();
+            const int32_t numPixels = width * height;
+            for (int32_t i = 0; i < numPixels; i++)
+            {
+                int32_t classId;
+                if (!toClassId(classes[i], &classId))
+                {
+                    continue;
+                }
+                if ((size_t)classId >= m_histogram.size())
+                {
+                    m_histogram.resize(classId + 1, 0);
+                }
+                m_histogram[classId]++;
+            }
+
+            uint32_t count = 0;
+            for (uint32_t pixels : m_histogram)
+            {
+                count += (pixels != 0);
+            }
+
+            if (m_mode == OUTPUT_MODE_JSON)
+            {
+                char num[64];
+                beginJson(input, "segmentation");
+                snprintf(num, sizeof(num), ",\"width\":%d,\"height\":%d,\"classes\":[", width, height);
+                m_record.append(num);
+                bool first = true;
+                for (size_t i = 0; i < m_histogram.size(); i++)
+                {
+                    if (m_histogram[i] == 0)
+                    {
+                        continue;
+                    }
+                    snprintf(num, sizeof(num), "%s{\"id\":%d,\"pixels\":%u}",
+                             first ? "" : ",", (int32_t)i, m_histogram[i]);
+                    m_record.append(num);
+                    first = false;
+                }
+                m_record.append("]}");
+            }
+            else
+            {
+                beginBinary(RESULT_TASK_SEGMENTATION, count, input);
+                SegmentationInfo info;
+                info.width = width;
+                info.height = height;
+                appendBinary(&info, sizeof(info));
+                for (size_t i = 0; i < m_histogram.size(); i++)
+                {
+                    if (m_histogram[i] == 0)
+                    {
+                        continue;
+                    }
+                    SegmentationEntry entry;
+                    entry.classId = i;
+                    entry.pixels = m_histogram[i];
+                    appendBinary(&entry, sizeof(entry));
+                }
+            }
+            return flushRecord();
+        }
+
+        template int32_t ResultWriter::writeSegmentation<float>(const std::string &input,
+                                                                const float *classes,
+                                                                int32_t width,
+                                                                int32_t height);
+        template int32_t ResultWriter::writeSegmentation<int32_t>(const std::string &input,
+                                                                  const int32_t *classes,
+                                                                  int32_t width,
+                                                                  int32_t height);
+        template int32_t ResultWriter::writeSegmentation<int64_t>(const std::string &input,
+                                                                  const int64_t *classes,
+                                                                  int32_t width,
+                                                                  int32_t height);
+
+    } // namespace tidl::postprocess
+}
@@ -0,0 +1,297 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _RESULT_WRITER_H_
+#define _RESULT_WRITER_H_
+
+/* Standard headers. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/* Module headers. */
+#include "../utils/include/arg_parsing.h"
+#include "../utils/include/label_store.h"
+#include "../utils/include/model_info.h"
+#include "output_sink.h"
+
+/** Magic at the start of every binary record, "TIRR". */
+#define TI_RESULT_RECORD_MAGIC      (0x52524954)
+#define TI_RESULT_RECORD_VERSION    (1)
+
+/** Largest class id counted in a segmentation mask, larger ids are skipped
+ * so a corrupt mask cannot grow the histogram without bound. */
+#define TI_RESULT_MAX_CLASS_ID      (65535)
+
+namespace tidl
+{
+    namespace postprocess
+    {
+        /** Kind of result held in a record. */
+        enum ResultTask
+        {
+            RESULT_TASK_CLASSIFICATION = 0,
+            RESULT_TASK_DETECTION,
+            RESULT_TASK_SEGMENTATION
+        };
+
+        /**
+         * \brief Header of a binary record. It is followed by inputLength bytes
+         *        of input path (not NUL terminated) and count entries whose
+         *        layout depends on task:
+         *        - classification: ClassificationEntry
+         *        - detection: DetectionEntry
+         *        - segmentation: one SegmentationInfo then SegmentationEntry
+         *
+         *        All fields are little endian as written by the target.
+         */
+        struct ResultRecordHeader
+        {
+            uint32_t magic;
+            uint16_t version;
+            uint16_t task;
+            uint32_t count;
+            uint32_t inputLength;
+        };
+
+        struct ClassificationEntry
+        {
+            int32_t classId;
+            float score;
+        };
+
+        struct DetectionEntry
+        {
+            /** x1 y1 x2 y2 normalized to the frame size. */
+            float box[4];
+            float score;
+            /** -1 when the model output is not a valid class id. */
+            int32_t classId;
+        };
+
+        struct SegmentationInfo
+        {
+            int32_t width;
+            int32_t height;
+        };
+
+        struct SegmentationEntry
+        {
+            int32_t classId;
+            uint32_t pixels;
+        };
+
+        /**
+         * \brief Emits inference results as compact records instead of an
+         *        annotated image.
+         *
+         * In OUTPUT_MODE_JSON each result is written as one JSON object per
+         * line, in OUTPUT_MODE_BINARY as one ResultRecordHeader followed by
+         * its entries. OUTPUT_MODE_NONE accepts every result and writes
+         * nothing. The writer is not used in OUTPUT_MODE_IMAGE, where the
+         * runners overlay the results and save a JPEG instead.
+         */
+        class ResultWriter
+        {
+        public:
+            /** Constructor, the writer starts closed. */
+            ResultWriter();
+
+            /** Destructor, closes the output file. */
+            ~ResultWriter();
+
+            /**
+             * Opens the output for the given mode. Nothing is opened for
+             * OUTPUT_MODE_NONE and OUTPUT_MODE_IMAGE.
+             *
+             * @param mode output mode selected on the command line
+             * @param modelName model name written in each JSON record
+             * @param path file the records are written to
+             * @param sink background writer the records are handed to,
+             *          nullptr to write them on the calling thread
+             * @returns RETURN_SUCCESS, RETURN_FAIL if the file cannot be
+             *          created
+             */
+            int32_t open(tidl::arg_parsing::OutputMode mode,
+                         const std::string &modelName,
+                         const std::string &path,
+                         OutputSink *sink);
+
+            /**
+             * Opens the writer for the given mode with the records kept in
+             * memory, to be taken with takeRecords(), instead of written to
+             * a file. Used to send results back over a socket.
+             *
+             * @param mode OUTPUT_MODE_JSON or OUTPUT_MODE_BINARY
+             * @param modelName model name written in each JSON record
+             * @returns RETURN_SUCCESS, RETURN_FAIL for the other modes
+             */
+            int32_t openBuffer(tidl::arg_parsing::OutputMode mode,
+                               const std::string &modelName);
+
+            /**
+             * Moves the records written since the last call into records.
+             * Only used after openBuffer().
+             *
+             * @param records filled with the records, replacing its contents
+             */
+            void takeRecords(std::string *records);
+
+            /** Flushes and closes the output file, waiting for the sink to
+             * write the pending records first. */
+            void close();
+
+            /** Returns true when results are emitted as records, or dropped,
+             * instead of being rendered on the image. */
+            bool isHeadless() const { return m_mode != tidl::arg_parsing::OUTPUT_MODE_IMAGE; }
+
+            /** Returns the default output path for a model and mode, the
+             * image saved in OUTPUT_MODE_IMAGE and the records of the other
+             * modes land next to each other.
+             *
+             * @param mode output mode
+             * @param format encoding of the image in OUTPUT_MODE_IMAGE
+             * @param modelName model name from param.yaml
+             */
+            static std::string getDefaultPath(tidl::arg_parsing::OutputMode mode,
+                                              tidl::arg_parsing::ImageFormat format,
+                                              const std::string &modelName);
+
+            /**
+             * Writes the top N classes of one input.
+             *
+             * @param input path of the input the result belongs to
+             * @param topResults pairs of confidence and class index
+             * @param labels labels file, may be nullptr
+             * @param labelOffset offset added to the class index to get the
+             *          line in labels
+             * @returns RETURN_SUCCESS, RETURN_FAIL on a write error
+             */
+            int32_t writeClassification(const std::string &input,
+                                        const std::vector<std::pair<float, int>> &topResults,
+                                        const tidl::utils::LabelStore *labels,
+                                        int32_t labelOffset);
+
+            /**
+             * Writes the detected boxes of one input.
+             *
+             * @param input path of the input the result belongs to
+             * @param odFormattedVec boxes over threshold as produced for
+             *          overlayBoundingBox
+             * @param config post process config giving the element order
+             * @returns RETURN_SUCCESS, RETURN_FAIL on a write error
+             */
+            int32_t writeDetection(const std::string &input,
+                                   const std::vector<std::vector<float>> &odFormattedVec,
+                                   const tidl::modelInfo::PostprocessImageConfig &config);
+
+            /**
+             * Writes the pixel count of every class present in a
+             * segmentation mask.
+             *
+             * @param input path of the input the result belongs to
+             * @param classes class id of every pixel, width * height values.
+             *          Non finite ids and ids outside [0, TI_RESULT_MAX_CLASS_ID]
+             *          are not counted
+             * @param width mask width
+             * @param height mask height
+             * @returns RETURN_SUCCESS, RETURN_FAIL on a write error
+             */
+            template <class T>
+            int32_t writeSegmentation(const std::string &input,
+                                      const T *classes,
+                                      int32_t width,
+                                      int32_t height);
+
+        private:
+            ResultWriter(const ResultWriter &) = delete;
+            ResultWriter &operator=(const ResultWriter &) = delete;
+
+            void beginJson(const std::string &input, const char *task);
+            void appendEscaped(const char *str, size_t length);
+            void appendNumber(const char *prefix, float value);
+            void beginBinary(ResultTask task, uint32_t count, const std::string &input);
+            void appendBinary(const void *data, size_t size);
+            int32_t flushRecord();
+            bool isWriting() const { return m_file != nullptr || m_buffered; }
+
+            tidl::arg_parsing::OutputMode m_mode;
+            std::string m_modelName;
+            FILE *m_file;
+            OutputSink *m_sink;
+
+            /* Records kept in memory after openBuffer(). */
+            bool m_buffered;
+            std::string m_buffer;
+
+            /* Record being built, reused between calls. */
+            std::string m_record;
+
+            /* Per class pixel counts of the last segmentation mask. */
+            std::vector<uint32_t> m_histogram;
+        };
+
+    } // namespace tidl::postprocess
+}
+
+#endif // _RESULT_WRITER_H_
@@ -0,0 +1,240 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <algorithm>
+
+/* Module headers. */
+#include "text_renderer.h"
+
+namespace tidl
+{
+    namespace postprocess
+    {
+        /* Sprite cache key resolution, font scales are compared in 1/1000
+        steps */
+#define TI_TEXT_SCALE_RES (1000)
+
+        /**
+         *  \brief Rounded division by 255 that stays in integer arithmetic so
+         *  the blend loop below can be vectorized by the compiler.
+         *
+         *  \param  v : value in the range [0, 255*255]
+         *  \return v/255 rounded to nearest
+         */
+        static inline uint32_t div255(uint32_t v)
+        {
+            v += 128;
+            return (v + (v >> 8)) >> 8;
+        }
+
+        TextRenderer::TextRenderer(int32_t fontFace, int32_t thickness, size_t maxSprites)
+            : m_fontFace(fontFace), m_thickness(thickness), m_maxSprites(maxSprites)
+        {
+        }
+
+        /**
+         *  \brief Looks up the sprite for text at fontScale and rasterizes it
+         *  with cv::putText if it is not cached yet.
+         *
+         *  \param  text : string to rasterize
+         *  \param  length : length of text in bytes
+         *  \param  fontScale : font scale factor
+         *  \return shared pointer to the cached sprite
+         */
+        TextRenderer::SpritePtr TextRenderer::getSprite(const char *text, size_t length, double fontScale)
+        {
+            int32_t scaleKey = static_cast<int32_t>(fontScale * TI_TEXT_SCALE_RES + 0.5);
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_lookupKey.first.assign(text, length);
+            m_lookupKey.second = scaleKey;
+
+            auto it = m_sprites.find(m_lookupKey);
+            if (it != m_sprites.end())
+            {
+                return it->second;
+            }
+
+            /* Bound the cache, sprites still referenced by a caller stay alive
+            through their shared pointer. */
+            if (m_sprites.size() >= m_maxSprites)
+            {
+                m_sprites.clear();
+            }
+
+            double scale = static_cast<double>(scaleKey) / TI_TEXT_SCALE_RES;
+            int32_t baseLine = 0;
+            const std::string &str = m_lookupKey.first;
+            cv::Size size = cv::getTextSize(str, m_fontFace, scale, m_thickness, &baseLine);
+            Sprite *sprite = new Sprite;
+
+            sprite->pad = m_thickness + 1;
+            sprite->ascent = size.height + sprite->pad;
+            sprite->advance = size.width;
+            sprite->alpha = cv::Mat::zeros(size.height + baseLine + 2 * sprite->pad,
+                                           size.width + 2 * sprite->pad, CV_8UC1);
+            cv::putText(sprite->alpha, str, cv::Point(sprite->pad, sprite->ascent),
+                        m_fontFace, scale, cv::Scalar(255), m_thickness, cv::LINE_AA);
+
+            SpritePtr ptr(sprite);
+            m_sprites[m_lookupKey] = ptr;
+            return ptr;
+        }
+
+        /**
+         *  \brief Alpha blends the sprite into a 3 channel 8 bit frame using
+         *  dst = (dst * (255 - a) + color * a) / 255, clipped to the frame.
+         *
+         *  \param  img : frame of type CV_8UC3
+         *  \param  sprite : sprite to blend
+         *  \param  org : bottom-left corner of the text in img
+         *  \param  color : text color
+         *  \return void
+         */
+        void TextRenderer::blendSprite(cv::Mat &img, const Sprite &sprite,
+                                       cv::Point org, const cv::Scalar &color)
+        {
+            int32_t x0 = org.x - sprite.pad;
+            int32_t y0 = org.y - sprite.ascent;
+            int32_t sx = std::max(0, -x0);
+            int32_t sy = std::max(0, -y0);
+            int32_t ex = std::min(sprite.alpha.cols, img.cols - x0);
+            int32_t ey = std::min(sprite.alpha.rows, img.rows - y0);
+
+            if ((sx >= ex) || (sy >= ey))
+            {
+                return;
+            }
+
+            const uint32_t c0 = static_cast<uint32_t>(std::min(std::max(color[0], 0.0), 255.0));
+            const uint32_t c1 = static_cast<uint32_t>(std::min(std::max(color[1], 0.0), 255.0));
+            const uint32_t c2 = static_cast<uint32_t>(std::min(std::max(color[2], 0.0), 255.0));
+            const int32_t width = ex - sx;
+
+            for (int32_t y = sy; y < ey; y++)
+            {
+                const uint8_t *__restrict a = sprite.alpha.ptr<uint8_t>(y) + sx;
+                uint8_t *__restrict d = img.ptr<uint8_t>(y0 + y) + (x0 + sx) * 3;
+
+                /* Branch free so that the loop vectorizes, fully transparent
+                pixels just write back their own value. */
+                for (int32_t x = 0; x < width; x++)
+                {
+                    uint32_t ia = a[x];
+                    uint32_t na = 255 - ia;
+
+                    d[3 * x + 0] = div255(d[3 * x + 0] * na + c0 * ia);
+                    d[3 * x + 1] = div255(d[3 * x + 1] * na + c1 * ia);
+                    d[3 * x + 2] = div255(d[3 * x + 2] * na + c2 * ia);
+                }
+            }
+        }
+
+        int32_t TextRenderer::drawText(cv::Mat &img, const std::string &text, cv::Point org,
+                                       double fontScale, const cv::Scalar &color)
+        {
+            return drawText(img, text.data(), text.size(), org, fontScale, color);
+        }
+
+        int32_t TextRenderer::drawText(cv::Mat &img, const char *text, size_t length, cv::Point org,
+                                       double fontScale, const cv::Scalar &color)
+        {
+            if (length == 0)
+            {
+                return 0;
+            }
+
+            SpritePtr sprite = getSprite(text, length, fontScale);
+            blendSprite(img, *sprite, org, color);
+            return sprite->advance;
+        }
+
+        int32_t TextRenderer::drawGlyphs(cv::Mat &img, const std::string &text, cv::Point org,
+                                         double fontScale, const cv::Scalar &color)
+        {
+            int32_t advance = 0;
+
+            for (size_t i = 0; i < text.size(); i++)
+            {
+                SpritePtr sprite = getSprite(&text[i], 1, fontScale);
+                blendSprite(img, *sprite, cv::Point(org.x + advance, org.y), color);
+                advance += sprite->advance;
+            }
+
+            return advance;
+        }
+
+        void TextRenderer::clear()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_sprites.clear();
+        }
+
+        TextRenderer &getTextRenderer()
+        {
+            static TextRenderer renderer;
+            return renderer;
+        }
+
+    } // namespace tidl::postprocess
+}
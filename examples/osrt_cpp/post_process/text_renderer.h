@@ -0,0 +1,199 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _TEXT_RENDERER_H_
+#define _TEXT_RENDERER_H_
+
+/* Standard headers. */
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+
+/* Third-party headers. */
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace tidl
+{
+    namespace postprocess
+    {
+        /**
+         * \brief Text renderer that rasterizes every string once per font scale
+         *        into an 8 bit alpha sprite and alpha blends the cached sprite
+         *        into the frame on later calls.
+         *
+         * Strings which stay the same from frame to frame (class names, titles)
+         * are cached as a whole with drawText(). Strings which change every
+         * frame (confidence values) are composed from cached single glyph
+         * sprites with drawGlyphs(), so the cache does not grow with them.
+         */
+        class TextRenderer
+        {
+        public:
+            /** Constructor.
+             *
+             * @param fontFace OpenCV font face used for rasterization
+             * @param thickness stroke thickness used for rasterization
+             * @param maxSprites number of sprites kept before the cache is
+             *        flushed
+             */
+            TextRenderer(int32_t fontFace = cv::FONT_HERSHEY_SIMPLEX,
+                         int32_t thickness = 1,
+                         size_t maxSprites = 1024);
+
+            /**
+             * Draws a string, rasterizing it only on the first call for a
+             * given font scale. Same origin convention as cv::putText, org is
+             * the bottom-left corner of the text.
+             *
+             * @param img RGB/BGR frame of type CV_8UC3 to draw on
+             * @param text string to draw
+             * @param org bottom-left corner of the text in img
+             * @param fontScale font scale factor
+             * @param color text color in the channel order of img
+             * @returns horizontal advance of the drawn text in pixels
+             */
+            int32_t drawText(cv::Mat &img, const std::string &text, cv::Point org,
+                             double fontScale, const cv::Scalar &color);
+
+            /**
+             * Same as above for text that is not NUL terminated, e.g. a label
+             * view into a memory mapped file. Does not allocate once the
+             * sprite is cached.
+             *
+             * @param img RGB/BGR frame of type CV_8UC3 to draw on
+             * @param text start of the string to draw
+             * @param length length of the string in bytes
+             * @param org bottom-left corner of the text in img
+             * @param fontScale font scale factor
+             * @param color text color in the channel order of img
+             * @returns horizontal advance of the drawn text in pixels
+             */
+            int32_t drawText(cv::Mat &img, const char *text, size_t length, cv::Point org,
+                             double fontScale, const cv::Scalar &color);
+
+            /**
+             * Draws a string glyph by glyph from cached single character
+             * sprites. Use for text that changes every frame.
+             *
+             * @param img RGB/BGR frame of type CV_8UC3 to draw on
+             * @param text string to draw
+             * @param org bottom-left corner of the text in img
+             * @param fontScale font scale factor
+             * @param color text color in the channel order of img
+             * @returns horizontal advance of the drawn text in pixels
+             */
+            int32_t drawGlyphs(cv::Mat &img, const std::string &text, cv::Point org,
+                               double fontScale, const cv::Scalar &color);
+
+            /** Drops all the cached sprites. */
+            void clear();
+
+        private:
+            /* Rasterized string. */
+            struct Sprite
+            {
+                /* Coverage of the text, CV_8UC1. */
+                cv::Mat alpha;
+
+                /* Distance from the top of the sprite to the baseline. */
+                int32_t ascent;
+
+                /* Horizontal pen advance of the string. */
+                int32_t advance;
+
+                /* Padding around the rasterized text. */
+                int32_t pad;
+            };
+
+            typedef std::shared_ptr<const Sprite> SpritePtr;
+
+            SpritePtr getSprite(const char *text, size_t length, double fontScale);
+
+            static void blendSprite(cv::Mat &img, const Sprite &sprite,
+                                    cv::Point org, const cv::Scalar &color);
+
+            int32_t m_fontFace;
+            int32_t m_thickness;
+            size_t m_maxSprites;
+
+            /* Sprites keyed by the string and the font scale in 1/1000 units. */
+            std::map<std::pair<std::string, int32_t>, SpritePtr> m_sprites;
+            std::mutex m_mutex;
+
+            /* Lookup key reused under m_mutex to avoid an allocation per
+            lookup. */
+            std::pair<std::string, int32_t> m_lookupKey;
+        };
+
+        /**
+         * Returns the process wide text renderer shared by the overlay
+         * functions.
+         */
+        TextRenderer &getTextRenderer();
+
+    } // namespace tidl::postprocess
+}
+
+#endif // _TEXT_RENDERER_H_
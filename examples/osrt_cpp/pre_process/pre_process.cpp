@@ -79,19 +79,31 @@ namespace tidl
 {
     namespace preprocess
     {
+        cv::Mat decodeImage(const std::string &input_bmp_name)
+        {
+            cv::Mat image = cv::imread(input_bmp_name, cv::IMREAD_COLOR);
+            if (image.empty())
+            {
+                LOG_ERROR("Could not decode %s\n", input_bmp_name.c_str());
+                return image;
+            }
+            cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
+            return image;
+        }
+
         /**
-  *  \brief Use OpenCV to open an image and resize according to requirment 
-  * of model, scalar modification on based on mean and scale
+  *  \brief Resize a decoded RGB frame according to requirment of model,
+  * scalar modification on based on mean and scale
   *
-  * @param input_bmp_name
+  * @param frame RGB frame, used as is when it already has the model size
   * @param out out data array
   * @param preProcessImageConfig prepprocess image config parsed from YAML
-  * @returns original frame with some in-place post processing done
+  * @returns resized frame
   */
         template <class T>
-        cv::Mat preprocImage(const std::string &input_bmp_name,
+        cv::Mat preprocFrame(const cv::Mat &frame,
                              T *out,
-                             tidl::modelInfo::PreprocessImageConfig preProcessImageConfig)
+                             const tidl::modelInfo::PreprocessImageConfig &preProcessImageConfig)
         {
             int i;
             uint8_t *pSrc;
@@ -99,11 +111,13 @@ namespace tidl
             int wanted_width = preProcessImageConfig.outDataWidth,
                 wanted_height = preProcessImageConfig.outDataHeight,
                 wanted_channels = preProcessImageConfig.numChans;
-            std::vector<float> mean = preProcessImageConfig.mean;
-            std::vector<float> scale = preProcessImageConfig.scale;
-            cv::Mat image = cv::imread(input_bmp_name, cv::IMREAD_COLOR);
-            cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
-            cv::resize(image, image, cv::Size(wanted_width, wanted_height), 0, 0, cv::INTER_AREA);
+            const std::vector<float> &mean = preProcessImageConfig.mean;
+            const std::vector<float> &scale = preProcessImageConfig.scale;
+            cv::Mat image = frame;
+            if (frame.cols != wanted_width || frame.rows != wanted_height)
+            {
+                cv::resize(frame, image, cv::Size(wanted_width, wanted_height), 0, 0, cv::INTER_AREA);
+            }
             if (image.channels() != wanted_channels)
             {
                 LOG_ERROR("Warning : Number of channels wanted differs from number of channels in the actual image \n");
@@ -138,6 +152,23 @@ namespace tidl
             return image;
         }
 
+        /**
+  *  \brief Use OpenCV to open an image and resize according to requirment 
+  * of model, scalar modification on based on mean and scale
+  *
+  * @param input_bmp_name
+  * @param out out data array
+  * @param preProcessImageConfig prepprocess image config parsed from YAML
+  * @returns original frame with some in-place post processing done
+  */
+        template <class T>
+        cv::Mat preprocImage(const std::string &input_bmp_name,
+                             T *out,
+                             tidl::modelInfo::PreprocessImageConfig preProcessImageConfig)
+        {
+            return preprocFrame<T>(decodeImage(input_bmp_name), out, preProcessImageConfig);
+        }
+
         template cv::Mat preprocImage<uint8_t>(const std::string &input_bmp_name,
                                                uint8_t *out,
                                                tidl::modelInfo::PreprocessImageConfig preProcessImageConfig);
@@ -146,6 +177,14 @@ namespace tidl
                                              float *out,
                                              tidl::modelInfo::PreprocessImageConfig preProcessImageConfig);
 
+        template cv::Mat preprocFrame<uint8_t>(const cv::Mat &frame,
+                                               uint8_t *out,
+                                               const tidl::modelInfo::PreprocessImageConfig &preProcessImageConfig);
+
+        template cv::Mat preprocFrame<float>(const cv::Mat &frame,
+                                             float *out,
+                                             const tidl::modelInfo::PreprocessImageConfig &preProcessImageConfig);
+
     } // namespace tidl::preprocess
 }
 #endif // _PRE_PROCESS_H_
@@ -81,6 +81,31 @@ namespace tidl
     namespace preprocess
     {
 
+        /**
+         *  \brief Use OpenCV to open an image and convert it to RGB
+         *
+         * @param input_bmp_name
+         * @returns RGB frame, empty if the image could not be decoded
+         */
+        cv::Mat decodeImage(const std::string &input_bmp_name);
+
+        /**
+         *  \brief Resize a frame returned by decodeImage() according to
+         * requirment of model, scalar modification on based on mean and
+         * scale. A frame that already has the model size is not resized,
+         * so one resize can be shared by models of the same input size.
+         *
+         * @param frame RGB frame
+         * @param out out data array
+         * @param preProcessImageConfig prepprocess image config parsed from YAML
+         * @returns resized frame, sharing the data of frame when it was not
+         *          resized
+         */
+        template <class T>
+        cv::Mat preprocFrame(const cv::Mat &frame,
+                             T *out,
+                             const tidl::modelInfo::PreprocessImageConfig &preProcessImageConfig);
+
         /**
          *  \brief Use OpenCV to open an image and resize according to requirment of
          * model, scalar modification on based on mean and scale
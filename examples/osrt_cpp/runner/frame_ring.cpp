@@ -0,0 +1,410 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <new>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Module headers. */
+#include "frame_ring.h"
+#include "../utils/include/ti_logger.h"
+#include "../utils/include/utility_functs.h"
+
+namespace tidl
+{
+    namespace runner
+    {
+        using namespace tidl::utils;
+
+        /* slot data and the header are aligned to cache lines */
+        static const size_t RING_ALIGNMENT = 64;
+
+        /**
+         *  \brief  start of the shared memory, followed by the slots
+         */
+        struct FrameRing::Header
+        {
+            std::atomic<uint32_t> magic;
+            uint32_t version;
+            uint32_t numSlots;
+            uint32_t reserved;
+            uint64_t slotSize;
+            uint64_t slotStride;
+
+            /* written by the producer */
+            alignas(RING_ALIGNMENT) std::atomic<uint32_t> tail;
+            std::atomic<uint32_t> closed;
+            /* bumped on every publish and on close, the consumer sleeps on
+            it */
+            std::atomic<uint32_t> events;
+            std::atomic<uint32_t> consumerWaiting;
+
+            /* written by the consumer, the producer sleeps on head */
+            alignas(RING_ALIGNMENT) std::atomic<uint32_t> head;
+            std::atomic<uint32_t> producerWaiting;
+        };
+
+        static size_t alignUp(size_t size)
+        {
+            return (size + RING_ALIGNMENT - 1) / RING_ALIGNMENT * RING_ALIGNMENT;
+        }
+
+        size_t FrameRing::getHeaderSize()
+        {
+            return alignUp(sizeof(FrameRing::Header));
+        }
+
+        FrameRing::FrameRing() : m_owner(false),
+                                 m_header(nullptr),
+                                 m_mappedSize(0),
+                                 m_numSlots(0),
+                                 m_slotSize(0),
+                                 m_slotStride(0),
+                                 m_waits(0)
+        {
+        }
+
+        FrameRing::~FrameRing()
+        {
+            if (m_owner && m_header != nullptr)
+                close();
+            detach();
+        }
+
+        uint64_t FrameRing::nowUs()
+        {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+        }
+
+        bool FrameRing::map(int fd, size_t size)
+        {
+            void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (addr == MAP_FAILED)
+            {
+                LOG_ERROR("Could not map frame ring %s: %s\n", m_name.c_str(), strerror(errno));
+                return false;
+            }
+            m_header = static_cast<Header *>(addr);
+            m_mappedSize = size;
+            return true;
+        }
+
+        void FrameRing::detach()
+        {
+            if (m_header != nullptr)
+            {
+                munmap(m_header, m_mappedSize);
+                m_header = nullptr;
+                m_mappedSize = 0;
+            }
+            m_numSlots = 0;
+            m_slotSize = 0;
+            m_slotStride = 0;
+            if (m_owner)
+            {
+                shm_unlink(m_name.c_str());
+                m_owner = false;
+            }
+        }
+
+        int32_t FrameRing::create(const std::string &name, uint32_t numSlots, size_t slotSize)
+        {
+            detach();
+            m_name = name;
+            uint32_t slots = 1;
+            while (slots < numSlots)
+                slots *= 2;
+            size_t stride = alignUp(sizeof(FrameInfo)) + alignUp(slotSize);
+            size_t size = getHeaderSize() + slots * stride;
+
+            /* a ring left by a producer that did not exit cleanly */
+            shm_unlink(name.c_str());
+            int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+            if (fd < 0)
+            {
+                LOG_ERROR("Could not create frame ring %s: %s\n", name.c_str(), strerror(errno));
+                return RETURN_FAIL;
+            }
+            bool mapped = ftruncate(fd, size) == 0 && map(fd, size);
+            ::close(fd);
+            if (!mapped)
+            {
+                shm_unlink(name.c_str());
+                return RETURN_FAIL;
+            }
+            m_owner = true;
+
+            Header *header = new (m_header) Header();
+            header->version = TI_FRAME_RING_VERSION;
+            header->numSlots = slots;
+            header->slotSize = slotSize;
+            header->slotStride = stride;
+            header->tail = 0;
+            header->closed = 0;
+            header->events = 0;
+            header->consumerWaiting = 0;
+            header->head = 0;
+            header->producerWaiting = 0;
+            m_numSlots = slots;
+            m_slotSize = slotSize;
+            m_slotStride = stride;
+            /* the consumer only trusts the header once the magic is set */
+            header->magic.store(TI_FRAME_RING_MAGIC, std::memory_order_release);
+            LOG_INFO("frame ring %s: %u slots of %zu bytes\n", name.c_str(), slots, slotSize);
+            return RETURN_SUCCESS;
+        }
+
+        int32_t FrameRing::attach(const std::string &name, int32_t timeoutMs)
+        {
+            detach();
+            m_name = name;
+            uint64_t deadline = nowUs() + (uint64_t)timeoutMs * 1000;
+            while (true)
+            {
+                int fd = shm_open(name.c_str(), O_RDWR, 0);
+                if (fd >= 0)
+                {
+                    struct stat st;
+                    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= getHeaderSize() && map(fd, st.st_size))
+                    {
+                        ::close(fd);
+                        const Header *header = m_header;
+                        if (header->magic.load(std::memory_order_acquire) == TI_FRAME_RING_MAGIC)
+                        {
+                            /* the layout is read once and kept, the producer
+                            can not move the slots out of the mapping later.
+                            Slots are indexed by masking with numSlots - 1, a
+                            count that is not a power of two would index out
+                            of the ring */
+                            const uint32_t version = header->version;
+                            const uint32_t slots = header->numSlots;
+                            const uint64_t size = header->slotSize;
+                            const uint64_t stride = header->slotStride;
+                            const bool powerOfTwo = slots != 0 && (slots & (slots - 1)) == 0;
+                            if (version != TI_FRAME_RING_VERSION || !powerOfTwo || size > stride ||
+                                stride < alignUp(sizeof(FrameInfo)) + size ||
+                                stride > (m_mappedSize - getHeaderSize()) / slots)
+                            {
+                                LOG_ERROR("frame ring %s has an unsupported layout\n", name.c_str());
+                                detach();
+                                return RETURN_FAIL;
+                            }
+                            m_numSlots = slots;
+                            m_slotSize = size;
+                            m_slotStride = stride;
+                            return RETURN_SUCCESS;
+                        }
+                        detach();
+                    }
+                    else
+                    {
+                        ::close(fd);
+                    }
+                }
+                if (nowUs() >= deadline)
+                {
+                    LOG_ERROR("frame ring %s not found\n", name.c_str());
+                    return RETURN_FAIL;
+                }
+                usleep(10000);
+            }
+        }
+
+        FrameInfo *FrameRing::slotInfo(uint32_t index) const
+        {
+            char *base = reinterpret_cast<char *>(m_header) + getHeaderSize();
+            return reinterpret_cast<FrameInfo *>(base + (index & (m_numSlots - 1)) * m_slotStride);
+        }
+
+        uint8_t *FrameRing::slotData(uint32_t index) const
+        {
+            return reinterpret_cast<uint8_t *>(slotInfo(index)) + alignUp(sizeof(FrameInfo));
+        }
+
+        size_t FrameRing::slotSize() const
+        {
+            return m_slotSize;
+        }
+
+        uint32_t FrameRing::numSlots() const
+        {
+            return m_numSlots;
+        }
+
+        bool FrameRing::wait(std::atomic<uint32_t> *word, std::atomic<uint32_t> *waiting,
+                             uint32_t value, int64_t deadlineUs)
+        {
+            bool waited = true;
+            waiting->fetch_add(1);
+            if (word->load() == value)
+            {
+                struct timespec timeout;
+                struct timespec *ptimeout = nullptr;
+                if (deadlineUs >= 0)
+                {
+                    int64_t remaining = deadlineUs - (int64_t)nowUs();
+                    timeout.tv_sec = remaining / 1000000;
+                    timeout.tv_nsec = (remaining % 1000000) * 1000;
+                    ptimeout = &timeout;
+                    waited = remaining > 0;
+                }
+                if (waited)
+                {
+                    /* not FUTEX_PRIVATE, the word is shared between
+                    processes */
+                    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, value, ptimeout,
+                            nullptr, 0);
+                    m_waits++;
+                }
+            }
+            waiting->fetch_sub(1);
+            return waited;
+        }
+
+        void FrameRing::wake(std::atomic<uint32_t> *word, std::atomic<uint32_t> *waiting)
+        {
+            if (waiting->load() > 0)
+                syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+
+        uint8_t *FrameRing::acquireSlot(int32_t timeoutMs)
+        {
+            int64_t deadline = timeoutMs < 0 ? -1 : (int64_t)(nowUs() + (uint64_t)timeoutMs * 1000);
+            uint32_t tail = m_header->tail.load(std::memory_order_relaxed);
+            while (true)
+            {
+                uint32_t head = m_header->head.load(std::memory_order_acquire);
+                if (tail - head < m_numSlots)
+                    return slotData(tail);
+                if (!wait(&m_header->head, &m_header->producerWaiting, head, deadline))
+                    return nullptr;
+            }
+        }
+
+        int32_t FrameRing::publish(const FrameInfo &info)
+        {
+            if (info.length > m_slotSize)
+            {
+                LOG_ERROR("frame of %u bytes does not fit slots of %zu bytes\n", info.length, m_slotSize);
+                return RETURN_FAIL;
+            }
+            uint32_t tail = m_header->tail.load(std::memory_order_relaxed);
+            FrameInfo *slot = slotInfo(tail);
+            *slot = info;
+            slot->timestampUs = nowUs();
+            m_header->tail.store(tail + 1);
+            m_header->events.fetch_add(1);
+            wake(&m_header->events, &m_header->consumerWaiting);
+            return RETURN_SUCCESS;
+        }
+
+        void FrameRing::close()
+        {
+            m_header->closed.store(1);
+            m_header->events.fetch_add(1);
+            wake(&m_header->events, &m_header->consumerWaiting);
+        }
+
+        const uint8_t *FrameRing::acquireFrame(FrameInfo *info, int32_t timeoutMs)
+        {
+            int64_t deadline = timeoutMs < 0 ? -1 : (int64_t)(nowUs() + (uint64_t)timeoutMs * 1000);
+            uint32_t head = m_header->head.load(std::memory_order_relaxed);
+            while (true)
+            {
+                /* read the event count first, a frame or a close after it
+                ends the wait */
+                uint32_t events = m_header->events.load();
+                if (m_header->tail.load() != head)
+                    break;
+                if (m_header->closed.load())
+                    return nullptr;
+                if (!wait(&m_header->events, &m_header->consumerWaiting, events, deadline))
+                    return nullptr;
+            }
+            *info = *slotInfo(head);
+            return slotData(head);
+        }
+
+        void FrameRing::release()
+        {
+            m_header->head.fetch_add(1);
+            wake(&m_header->head, &m_header->producerWaiting);
+        }
+
+        bool FrameRing::isDrained() const
+        {
+            return m_header->closed.load() && m_header->head.load() == m_header->tail.load();
+        }
+
+    } // namespace tidl::runner
+}
@@ -0,0 +1,240 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _TI_EDGEAI_FRAME_RING_H_
+#define _TI_EDGEAI_FRAME_RING_H_
+
+/* Standard headers. */
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+/** Magic at the start of the shared memory, "TIFR". */
+#define TI_FRAME_RING_MAGIC     (0x52464954)
+#define TI_FRAME_RING_VERSION   (1)
+
+namespace tidl
+{
+    namespace runner
+    {
+        /** Layout of the data of a frame slot. */
+        enum FrameFormat
+        {
+            /** Packed RGB, width * height * 3 bytes, preprocessed by the
+             * consumer. */
+            FRAME_FORMAT_RGB = 0,
+            /** Already preprocessed input tensor of the model, bound as
+             * is. */
+            FRAME_FORMAT_TENSOR
+        };
+
+        /**
+         * \brief Description of a frame written in a slot.
+         */
+        struct FrameInfo
+        {
+            uint64_t frameId;
+            /** CLOCK_MONOTONIC time the producer published the frame. */
+            uint64_t timestampUs;
+            uint32_t format;
+            uint32_t width;
+            uint32_t height;
+            uint32_t length;
+        };
+
+        /**
+         * \brief Ring of fixed size frame slots in POSIX shared memory,
+         *        between one producer process, typically the capture, and
+         *        one consumer process running inference. Frames are written
+         *        and read in place in the slots, nothing is copied between
+         *        the processes.
+         *
+         * The producer create()s the ring, which it unlinks when destroyed,
+         * and the consumer attach()es to it by name. The write and read
+         * counters are atomics in the shared memory, each on its own cache
+         * line, and a side waiting on an empty or full ring sleeps on a
+         * futex in the shared memory. The futex is only woken when the
+         * other side announced it waits, so a busy pipeline makes no system
+         * call.
+         *
+         * Producer:
+         * - acquireSlot() for the data of the next free slot, write into it
+         * - publish() it with its FrameInfo
+         * - close() at the end of the stream
+         *
+         * Consumer:
+         * - acquireFrame() for the oldest published frame, use it in place
+         * - release() it to give the slot back to the producer
+         */
+        class FrameRing
+        {
+        public:
+            /** Constructor, the ring starts detached. */
+            FrameRing();
+
+            /** Destructor, detaches and, for the producer, unlinks the
+             * shared memory. */
+            ~FrameRing();
+
+            /**
+             * Creates the shared memory of a ring, producer side. A ring
+             * left with the same name is replaced.
+             *
+             * @param name shared memory name, as given to shm_open()
+             * @param numSlots number of slots, rounded up to a power of two
+             * @param slotSize bytes of data per slot
+             * @returns RETURN_SUCCESS or RETURN_FAIL
+             */
+            int32_t create(const std::string &name, uint32_t numSlots, size_t slotSize);
+
+            /**
+             * Attaches to a ring created by a producer, consumer side.
+             *
+             * @param name shared memory name given to create()
+             * @param timeoutMs time to wait for the producer to create it
+             * @returns RETURN_SUCCESS or RETURN_FAIL
+             */
+            int32_t attach(const std::string &name, int32_t timeoutMs);
+
+            /**
+             * Producer side, waits for a free slot.
+             *
+             * @param timeoutMs longest wait, -1 to wait forever
+             * @returns data of the slot, slotSize() bytes, nullptr on
+             *          timeout
+             */
+            uint8_t *acquireSlot(int32_t timeoutMs);
+
+            /**
+             * Producer side, hands the slot returned by acquireSlot() to the
+             * consumer. The timestamp is set here.
+             *
+             * @param info frame description, length at most slotSize()
+             * @returns RETURN_SUCCESS or RETURN_FAIL
+             */
+            int32_t publish(const FrameInfo &info);
+
+            /** Producer side, tells the consumer no more frames will come. */
+            void close();
+
+            /**
+             * Consumer side, waits for the next frame.
+             *
+             * @param info filled with the frame description
+             * @param timeoutMs longest wait, -1 to wait forever
+             * @returns data of the frame, valid until release(), nullptr
+             *          on timeout or when the producer closed the ring and
+             *          every frame was read
+             */
+            const uint8_t *acquireFrame(FrameInfo *info, int32_t timeoutMs);
+
+            /** Consumer side, gives the frame of acquireFrame() back. */
+            void release();
+
+            /** Returns true once the producer closed the ring and every
+             * frame was read. */
+            bool isDrained() const;
+
+            /** Bytes of data per slot. */
+            size_t slotSize() const;
+
+            /** Number of slots. */
+            uint32_t numSlots() const;
+
+            /** Number of times a side had to sleep on the futex. */
+            uint64_t getWaits() const { return m_waits; }
+
+            /** CLOCK_MONOTONIC time in microseconds, the clock of
+             * FrameInfo::timestampUs. */
+            static uint64_t nowUs();
+
+        private:
+            FrameRing(const FrameRing &) = delete;
+            FrameRing &operator=(const FrameRing &) = delete;
+
+            struct Header;
+            static size_t getHeaderSize();
+            bool map(int fd, size_t size);
+            void detach();
+            FrameInfo *slotInfo(uint32_t index) const;
+            uint8_t *slotData(uint32_t index) const;
+            bool wait(std::atomic<uint32_t> *word, std::atomic<uint32_t> *waiting,
+                      uint32_t value, int64_t deadlineUs);
+            void wake(std::atomic<uint32_t> *word, std::atomic<uint32_t> *waiting);
+
+            std::string m_name;
+            bool m_owner;
+            Header *m_header;
+            size_t m_mappedSize;
+            /* layout checked at create() or attach(), slots are only
+            indexed from these copies, never from the shared header */
+            uint32_t m_numSlots;
+            size_t m_slotSize;
+            size_t m_slotStride;
+            uint64_t m_waits;
+        };
+
+    } // namespace tidl::runner
+}
+
+#endif // _TI_EDGEAI_FRAME_RING_H_
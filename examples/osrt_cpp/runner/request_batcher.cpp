@@ -0,0 +1,216 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <string.h>
+#include <algorithm>
+
+/* Module headers. */
+#include "request_batcher.h"
+#include "../utils/include/latency_histogram.h"
+#include "../utils/include/ti_logger.h"
+#include "../utils/include/utility_functs.h"
+
+namespace tidl
+{
+    namespace runner
+    {
+        using namespace tidl::inferer;
+        using namespace tidl::utils;
+
+        RequestBatcher::RequestBatcher(Inferer *inferer, size_t queueDepth) : m_inferer(inferer),
+                                                                              m_queue(queueDepth),
+                                                                              m_sampleBytes(0),
+                                                                              m_dirty(0),
+                                                                              m_maxBatch(0),
+                                                                              m_maxWaitUs(0),
+                                                                              m_dynamic(false),
+                                                                              m_lastBatch(0)
+        {
+        }
+
+        int32_t RequestBatcher::init(const TensorView &sample, int32_t maxBatch, double maxWaitUs, bool shared)
+        {
+            if (maxBatch <= 0 || sample.shape.empty())
+            {
+                LOG_ERROR("invalid batch %d\n", maxBatch);
+                return RETURN_FAIL;
+            }
+            m_maxBatch = maxBatch;
+            m_maxWaitUs = maxWaitUs;
+            m_dynamic = m_inferer->describeIO().inputs[0].shape[0] < 0;
+            m_sampleBytes = sample.getSizeBytes();
+
+            m_batch = sample;
+            m_batch.shape[0] = maxBatch;
+            m_batchBuffer = SharedTensorPool::get().acquire(m_batch.getSizeBytes(), SharedTensorPool::MIN_ALIGNMENT,
+                                                            shared);
+            m_batch.data = m_batchBuffer.data();
+            if (m_batch.data == nullptr)
+            {
+                LOG_ERROR("Could not allocate memory for a batch of %d\n", maxBatch);
+                return RETURN_FAIL;
+            }
+            /* pooled buffers hold whatever their last owner left */
+            m_dirty = maxBatch;
+            m_pending.reserve(maxBatch);
+            return RETURN_SUCCESS;
+        }
+
+        int32_t RequestBatcher::warmup(const void *sample, int32_t runs)
+        {
+            for (int32_t i = 0; i < m_maxBatch; i++)
+                memcpy(m_batch.as<uint8_t>() + i * m_sampleBytes, sample, m_sampleBytes);
+            m_dirty = m_maxBatch;
+            if (RETURN_FAIL == m_inferer->bindInput(0, m_batch))
+                return RETURN_FAIL;
+            for (int32_t i = 0; i < runs; i++)
+            {
+                if (RETURN_FAIL == m_inferer->run())
+                    return RETURN_FAIL;
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int32_t RequestBatcher::runBatch(std::vector<BatchResult> *results)
+        {
+            results->clear();
+
+            /* flush when the batch is full, when the oldest request has
+            waited long enough or when no more requests will come */
+            for (;;)
+            {
+                BatchRequest request;
+                while ((int32_t)m_pending.size() < m_maxBatch && m_queue.pop(&request))
+                    m_pending.push_back(request);
+                if ((int32_t)m_pending.size() == m_maxBatch)
+                    break;
+                bool drained = m_queue.isClosed() && m_queue.size() == 0;
+                if (drained)
+                {
+                    if (m_pending.empty())
+                        return RETURN_SUCCESS;
+                    break;
+                }
+
+                /* sleep until the next request or until the oldest one has
+                waited long enough */
+                int64_t waitUs = -1;
+                if (!m_pending.empty())
+                {
+                    double nowUs = getMonotonicNs() / 1000.0;
+                    waitUs = std::max<int64_t>(0, (int64_t)(m_pending[0].arrivalUs + m_maxWaitUs - nowUs));
+                    if (waitUs == 0)
+                        break;
+                }
+                if (m_queue.popWait(&request, waitUs))
+                    m_pending.push_back(request);
+                else if (!m_pending.empty() && !m_queue.isClosed())
+                    break;
+            }
+
+            const int32_t count = m_pending.size();
+            uint8_t *base = m_batch.as<uint8_t>();
+            for (int32_t i = 0; i < count; i++)
+                memcpy(base + i * m_sampleBytes, m_pending[i].sample, m_sampleBytes);
+
+            /* a padded run must not see the samples of earlier requests */
+            TensorView view = m_batch;
+            if (m_dynamic)
+            {
+                view.shape[0] = count;
+            }
+            else if (m_dirty > count)
+            {
+                memset(base + count * m_sampleBytes, 0, (m_dirty - count) * m_sampleBytes);
+            }
+            m_dirty = count;
+            m_lastBatch = view.shape[0];
+
+            results->resize(count);
+            for (int32_t i = 0; i < count; i++)
+                (*results)[i].request = m_pending[i];
+            m_pending.clear();
+            if (RETURN_FAIL == m_inferer->bindInput(0, view) || RETURN_FAIL == m_inferer->run())
+                return RETURN_FAIL;
+
+            /* slice the outputs that carry the batch in their first
+            dimension */
+            const std::vector<TensorView> &outputs = m_inferer->outputs();
+            for (int32_t i = 0; i < count; i++)
+            {
+                std::vector<TensorView> &sliced = (*results)[i].outputs;
+                sliced = outputs;
+                for (TensorView &output : sliced)
+                {
+                    if (output.shape.empty() || output.shape[0] != m_lastBatch || m_lastBatch == 1)
+                        continue;
+                    size_t bytes = output.getSizeBytes() / m_lastBatch;
+                    output.data = static_cast<uint8_t *>(output.data) + i * bytes;
+                    output.shape[0] = 1;
+                }
+            }
+            return RETURN_SUCCESS;
+        }
+
+    } // namespace tidl::runner
+}
@@ -0,0 +1,217 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _TI_EDGEAI_REQUEST_BATCHER_H_
+#define _TI_EDGEAI_REQUEST_BATCHER_H_
+
+/* Standard headers. */
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/* Module headers. */
+#include "../utils/include/inferer.h"
+#include "../utils/include/shared_tensor_pool.h"
+#include "spsc_queue.h"
+
+namespace tidl
+{
+    namespace runner
+    {
+        /**
+         * \brief One request of a RequestBatcher, a preprocessed sample of
+         *        the model input with batch 1.
+         */
+        struct BatchRequest
+        {
+            /** Caller defined id, returned with the outputs. */
+            size_t id;
+
+            /** Sample copied into the batch, must stay valid until the
+             * batch holding the request has run. */
+            const void *sample;
+
+            /** Arrival time in microseconds, from getMonotonicNs(). */
+            double arrivalUs;
+        };
+
+        /**
+         * \brief Outputs of one request of a batch.
+         */
+        struct BatchResult
+        {
+            BatchRequest request;
+
+            /** Outputs of the request, the batch outputs sliced along their
+             * first dimension. Outputs whose first dimension is not the
+             * batch are shared by all the requests. Valid until the next
+             * run of the inferer. */
+            std::vector<tidl::inferer::TensorView> outputs;
+        };
+
+        /**
+         * \brief Groups requests into batches of one model.
+         *
+         * A producer thread submit()s requests, a consumer thread calls
+         * runBatch(), which waits until maxBatch requests are queued, until
+         * the oldest one has waited maxWaitUs or until the producer closed
+         * the batcher, then runs them in one inference and returns the
+         * outputs of each request. A model with a dynamic first dimension
+         * is bound with the number of requests, a fixed batch is padded
+         * with zeroed samples.
+         *
+         * Producer:
+         *   batcher.submit({id, sample, getMonotonicNs() / 1000.0});
+         *   ...
+         *   batcher.close();
+         *
+         * Consumer:
+         *   std::vector<BatchResult> results;
+         *   while (RETURN_SUCCESS == batcher.runBatch(&results) && !results.empty())
+         *       for (const BatchResult &result : results) ...
+         */
+        class RequestBatcher
+        {
+        public:
+            /**
+             * Constructor.
+             *
+             * @param inferer loaded backend, already set to maxBatch with
+             *        setBatchSize()
+             * @param queueDepth maximum number of queued requests, submit()
+             *        blocks beyond it
+             */
+            RequestBatcher(tidl::inferer::Inferer *inferer, size_t queueDepth);
+
+            /**
+             * Allocates the batch input.
+             *
+             * @param sample model input with a batch of 1, its data is
+             *        not used
+             * @param maxBatch requests per run
+             * @param maxWaitUs longest time the oldest request waits for
+             *        the batch to fill
+             * @param shared allocate the batch in memory shared with the
+             *        accelerator
+             * @returns RETURN_SUCCESS or RETURN_FAIL
+             */
+            int32_t init(const tidl::inferer::TensorView &sample, int32_t maxBatch, double maxWaitUs, bool shared);
+
+            /**
+             * Fills every slot of the batch with one sample and runs it,
+             * the slots are zeroed again by the next runBatch().
+             *
+             * @param sample sample with a batch of 1
+             * @param runs number of runs
+             * @returns RETURN_SUCCESS or RETURN_FAIL
+             */
+            int32_t warmup(const void *sample, int32_t runs);
+
+            /** Producer side, queues a request, blocks while the queue is
+             * full. */
+            void submit(const BatchRequest &request) { m_queue.pushWait(request); }
+
+            /** Producer side, no more requests will be submitted. */
+            void close() { m_queue.close(); }
+
+            /**
+             * Consumer side, waits for the next batch and runs it.
+             *
+             * @param results filled with the outputs of every request of
+             *        the batch, in arrival order, empty once the batcher is
+             *        closed and every request has run
+             * @returns RETURN_SUCCESS, RETURN_FAIL when the batch could not
+             *          run, results then holds its requests with no
+             *          outputs
+             */
+            int32_t runBatch(std::vector<BatchResult> *results);
+
+            /** Returns the bound batch of the last run, including padding. */
+            int32_t getLastBatch() const { return m_lastBatch; }
+
+        private:
+            RequestBatcher(const RequestBatcher &) = delete;
+            RequestBatcher &operator=(const RequestBatcher &) = delete;
+
+            tidl::inferer::Inferer *m_inferer;
+            SpscQueue<BatchRequest> m_queue;
+
+            /* batch input, m_dirty slots from the start hold samples that
+            the next padded run has to clear */
+            tidl::utils::PooledBuffer m_batchBuffer;
+            tidl::inferer::TensorView m_batch;
+            size_t m_sampleBytes;
+            int32_t m_dirty;
+
+            int32_t m_maxBatch;
+            double m_maxWaitUs;
+            bool m_dynamic;
+            int32_t m_lastBatch;
+
+            /* requests waiting for the batch to fill */
+            std::vector<BatchRequest> m_pending;
+        };
+
+    } // namespace tidl::runner
+}
+
+#endif // _TI_EDGEAI_REQUEST_BATCHER_H_
@@ -0,0 +1,2152 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <algorithm>
+#include <errno.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <stdio.h>
+#include <sys/time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Module headers. */
+#include "runner.h"
+#include "frame_ring.h"
+#include "request_batcher.h"
+#include "server.h"
+#include "spsc_queue.h"
+#include "../post_process/post_process.h"
+#include "../post_process/output_sink.h"
+#include "../pre_process/pre_process.h"
+#include "../utils/include/bench_report.h"
+#include "../utils/include/latency_histogram.h"
+#include "../utils/include/shared_tensor_pool.h"
+#include "../utils/include/ti_logger.h"
+#include "../utils/include/utility_functs.h"
+
+namespace tidl
+{
+    namespace runner
+    {
+        using namespace tidl::arg_parsing;
+        using namespace tidl::modelInfo;
+        using namespace tidl::inferer;
+        using namespace tidl::postprocess;
+        using namespace tidl::preprocess;
+        using namespace tidl::utility_functs;
+        using namespace tidl::utils;
+        using std::string;
+        using std::vector;
+
+        InfererOptions getInfererOptions(const ModelInfo *modelInfo, const Settings *s)
+        {
+            InfererOptions options;
+            options.accel = s->accel;
+            options.deviceMem = s->device_mem;
+            options.numThreads = s->number_of_threads;
+            options.artifactsPath = s->artifact_path;
+            options.devType = s->device_type;
+            options.ioBinding = s->io_binding;
+            options.modelCacheDir = s->ort_cache_dir;
+            options.intraOpThreads = s->intra_op_threads;
+            options.interOpThreads = s->inter_op_threads;
+            options.executionMode = s->execution_mode;
+            options.allowSpinning = s->allow_spinning;
+            options.cpuAffinity = s->cpu_affinity;
+            options.xnnpack = s->xnnpack;
+            options.logLevel = s->log_level;
+            return options;
+        }
+
+        /**
+         *  \brief  checks the model input against the YAML parsed
+         *          preprocessing configuration
+         *  \param  info model input
+         *  \param  cfg preprocessing configuration
+         * @returns int status
+         */
+        static int checkInput(const TensorInfo &info, const PreprocessImageConfig &cfg)
+        {
+            const vector<int64_t> &dims = info.shape;
+            if (dims.size() == 4)
+            {
+                int64_t channels, height, width;
+                if (cfg.dataLayout == "NHWC")
+                {
+                    height = dims[1];
+                    width = dims[2];
+                    channels = dims[3];
+                }
+                else
+                {
+                    channels = dims[1];
+                    height = dims[2];
+                    width = dims[3];
+                }
+                if (channels != cfg.numChans)
+                {
+                    LOG_INFO("missmatch in YAML parsed wanted channels:%d and model channels:%jd\n", cfg.numChans, channels);
+                }
+                if (height != cfg.outDataHeight)
+                {
+                    LOG_INFO("missmatch in YAML parsed wanted height:%d and model height:%jd\n", cfg.outDataHeight, height);
+                }
+                if (width != cfg.outDataWidth)
+                {
+                    LOG_INFO("missmatch in YAML parsed wanted width:%d and model width:%jd\n", cfg.outDataWidth, width);
+                }
+            }
+            /* preprocImage() writes the YAML parsed size, it must fit in the
+            model input */
+            int64_t wanted = (int64_t)cfg.outDataWidth * cfg.outDataHeight * cfg.numChans;
+            if (wanted > info.getNumElements())
+            {
+                LOG_ERROR("YAML parsed input of %jd elements does not fit model input of %jd\n",
+                          wanted, info.getNumElements());
+                return RETURN_FAIL;
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int preprocInput(ModelInfo *modelInfo, const string &path, const TensorView &input, cv::Mat *img)
+        {
+            if (access(path.c_str(), R_OK) != 0)
+            {
+                LOG_ERROR("can not read input %s\n", path.c_str());
+                return RETURN_FAIL;
+            }
+            cv::Mat frame = decodeImage(path);
+            if (frame.empty())
+                return RETURN_FAIL;
+            return preprocFrame(modelInfo, frame, input, img);
+        }
+
+        int preprocFrame(ModelInfo *modelInfo, const cv::Mat &frame, const TensorView &input, cv::Mat *img)
+        {
+            switch (input.type)
+            {
+            case DlInferType_Float32:
+                *img = tidl::preprocess::preprocFrame<float>(frame, input.as<float>(), modelInfo->m_preProcCfg);
+                break;
+            case DlInferType_UInt8:
+            {
+                /* if model is already quantized update the scale and mean for
+                preperocess computation */
+                PreprocessImageConfig cfg = modelInfo->m_preProcCfg;
+                cfg.scale = {1, 1, 1};
+                cfg.mean = {0, 0, 0};
+                *img = tidl::preprocess::preprocFrame<uint8_t>(frame, input.as<uint8_t>(), cfg);
+                break;
+            }
+            default:
+                LOG_ERROR("cannot handle input type %s yet\n", getTypeName(input.type));
+                return RETURN_FAIL;
+            }
+            return RETURN_SUCCESS;
+        }
+
+        /**
+         *  \brief  prepare the classification result inplace
+         *  \param  img cv image to do inplace transform
+         *  \param  outputs outputs of the last run
+         *  \param  s settings
+         *  \param  modelInfo pointer to modelInfo holding the labels
+         *  \param  writer receives the results instead of img when headless
+         *  \param  input path of the input image
+         * @returns int status
+         */
+        static int prepClassificationResult(cv::Mat *img, const vector<TensorView> &outputs, Settings *s,
+                                            ModelInfo *modelInfo, ResultWriter *writer, const string &input)
+        {
+            LOG_INFO("preparing classification result \n");
+            const float threshold = 0.001f;
+            vector<std::pair<float, int>> top_results;
+            const TensorView &output = outputs[0];
+
+            /* assume output dims to be something like (1, 1, ... ,size) */
+            int output_size = output.shape.empty() ? 0 : output.shape.back();
+            int outputoffset;
+            if (output_size == 1001)
+                outputoffset = 0;
+            else
+                outputoffset = 1;
+            switch (output.type)
+            {
+            case DlInferType_Float32:
+                getTopN<float>(output.as<float>(), output_size,
+                               s->number_of_results, threshold, &top_results, true);
+                break;
+            case DlInferType_Int64:
+                getTopN<int64_t>(output.as<int64_t>(), output_size,
+                                 s->number_of_results, threshold, &top_results, true);
+                break;
+            case DlInferType_UInt8:
+                getTopN<uint8_t>(output.as<uint8_t>(), output_size,
+                                 s->number_of_results, threshold, &top_results, false);
+                break;
+            default:
+                LOG_ERROR("cannot handle output type %s yet\n", getTypeName(output.type));
+                return RETURN_FAIL;
+            }
+
+            const tidl::utils::LabelStore *labels = modelInfo->m_labels.get();
+            if (labels == nullptr)
+            {
+                LOG_ERROR("label file not found!!! \n");
+                return RETURN_FAIL;
+            }
+            for (const auto &result : top_results)
+            {
+                const float confidence = result.first;
+                const int index = result.second;
+                tidl::utils::LabelView label = labels->line(index + outputoffset);
+                if (label.empty())
+                    LOG_INFO("%f: %d :<no label>\n", confidence, index);
+                else
+                    LOG_INFO("%f: %d :%.*s\n", confidence, index, (int)label.size, label.data);
+            }
+            if (writer->isHeadless())
+            {
+                return writer->writeClassification(input, top_results, labels, outputoffset);
+            }
+            (*img).data = overlayTopNClasses((*img).data, top_results, labels, outputoffset, (*img).cols, (*img).rows, s->number_of_results);
+            return RETURN_SUCCESS;
+        }
+
+        /**
+         *  \brief  number of values per detection in a tensor
+         *  \param  shape tensor shape
+         * @returns last dimension ignoring all dimensions with value 1,
+         *          since they do not actually add a dimension
+         */
+        static int64_t getNumValues(const vector<int64_t> &shape)
+        {
+            vector<int64_t> temp;
+            for (int64_t dim : shape)
+            {
+                if (dim != 1)
+                    temp.push_back(dim);
+            }
+            if (temp.size() <= 1)
+                return 1;
+            return temp.back();
+        }
+
+        /**
+         *  \brief  prepare the detection result inplace
+         *  \param  img cv image to do inplace transform
+         *  \param  outputs outputs of the last run
+         *  \param  modelInfo YAML parsed model info
+         *  \param  writer receives the results instead of img when headless
+         *  \param  input path of the input image
+         * @returns int status
+         */
+        static int prepDetection(cv::Mat *img, const vector<TensorView> &outputs, ModelInfo *modelInfo,
+                                 ResultWriter *writer, const string &input)
+        {
+            LOG_INFO("preparing detection result \n");
+            const string &rtType = modelInfo->m_infConfig.rtType;
+            vector<vector<int64_t>> tensor_shapes_vec;
+            vector<vector<float>> f_tensor_unformatted;
+            size_t num_tensors = outputs.size();
+            int nboxes;
+
+            if (num_tensors == 0)
+            {
+                LOG_ERROR("model has no outputs\n");
+                return RETURN_FAIL;
+            }
+            if (rtType == "tflitert")
+            {
+                /* num of detection in op tensor is assumed to be given by
+                last tensor */
+                nboxes = (int)outputs[num_tensors - 1].getFloat(0);
+                /* TODO verify this holds true for every tfl model */
+                tensor_shapes_vec = {{nboxes, 4}, {nboxes, 1}, {nboxes, 1}, {nboxes, 1}};
+                num_tensors -= 1;
+            }
+            else
+            {
+                for (const TensorView &output : outputs)
+                {
+                    tensor_shapes_vec.push_back(output.shape);
+                }
+                /* num of detection is given by the first op tensor */
+                nboxes = outputs[0].getNumElements() / getNumValues(outputs[0].shape);
+                if (rtType == "tvmdlr")
+                {
+                    /* TVM compiled models keep the score and label ahead of
+                    the box */
+                    modelInfo->m_postProcCfg.formatter = {2, 3, 4, 5, 0, 1};
+                    modelInfo->m_postProcCfg.formatterName = "DetectionBoxSL2BoxLS";
+                }
+            }
+            LOG_INFO("detected objects:%d \n", nboxes);
+
+            /* append all output tensors in to single vector<vector<float>> */
+            for (size_t i = 0; i < num_tensors && i < tensor_shapes_vec.size(); i++)
+            {
+                const TensorView &output = outputs[i];
+                int64_t num_val_tensor = rtType == "tflitert" ? tensor_shapes_vec[i].back()
+                                                              : getNumValues(tensor_shapes_vec[i]);
+                int64_t num_elements = output.getNumElements();
+                for (int64_t j = 0; j < nboxes; j++)
+                {
+                    vector<float> temp;
+                    for (int64_t k = 0; k < num_val_tensor && j * num_val_tensor + k < num_elements; k++)
+                    {
+                        temp.push_back(output.getFloat(j * num_val_tensor + k));
+                    }
+                    f_tensor_unformatted.push_back(temp);
+                }
+            }
+            return prepDetectionResult(img, &f_tensor_unformatted, tensor_shapes_vec, modelInfo,
+                                       num_tensors, nboxes, writer, input);
+        }
+
+        /**
+         *  \brief  blend or write a segmentation class map
+         *  \param  img cv image to do inplace transform
+         *  \param  classes class map of width x height
+         *  \param  width class map width
+         *  \param  height class map height
+         *  \param  alpha for img masking
+         *  \param  writer receives the mask summary instead of img when
+         *          headless
+         *  \param  input path of the input image
+         * @returns int status
+         */
+        template <class T>
+        static int blendOrWrite(cv::Mat *img, T *classes, int width, int height, float alpha,
+                                ResultWriter *writer, const string &input)
+        {
+            if (writer->isHeadless())
+                return writer->writeSegmentation<T>(input, classes, width, height);
+            (*img).data = blendSegMask<T>((*img).data, classes, (*img).cols, (*img).rows, width, height, alpha);
+            return RETURN_SUCCESS;
+        }
+
+        /**
+         *  \brief  prepare the segmentation result inplace
+         *  \param  img cv image to do inplace transform
+         *  \param  outputs outputs of the last run
+         *  \param  modelInfo YAML parsed model info
+         *  \param  writer receives the mask summary instead of img when
+         *          headless
+         *  \param  input path of the input image
+         * @returns int status
+         */
+        static int prepSegResult(cv::Mat *img, const vector<TensorView> &outputs, ModelInfo *modelInfo,
+                                 ResultWriter *writer, const string &input)
+        {
+            LOG_INFO("preparing segmentation result \n");
+            const TensorView &mask = outputs[0];
+            const vector<int64_t> &shape = mask.shape;
+            float alpha = modelInfo->m_postProcCfg.alpha;
+            int width, height, nclasses = 1;
+
+            if (modelInfo->m_infConfig.rtType == "tflitert")
+            {
+                /* tflite models give the merged class map at the input
+                resolution */
+                width = modelInfo->m_preProcCfg.outDataWidth;
+                height = modelInfo->m_preProcCfg.outDataHeight;
+            }
+            else
+            {
+                /* assuming [1, nclasses, height, width] or [1, height, width] */
+                if (shape.size() < 2)
+                {
+                    LOG_ERROR("unexpected segmentation output rank %zu\n", shape.size());
+                    return RETURN_FAIL;
+                }
+                height = shape[shape.size() - 2];
+                width = shape[shape.size() - 1];
+                if (shape.size() >= 3)
+                    nclasses = shape[shape.size() - 3];
+            }
+            LOG_INFO("nclasses :%d\n", nclasses);
+
+            /* if out data is of different size than the image, resize the
+            image to the out data */
+            if (!writer->isHeadless() && ((*img).cols != width || (*img).rows != height))
+            {
+                cv::resize((*img), (*img), cv::Size(width, height), 0, 0, cv::INTER_AREA);
+            }
+
+            switch (mask.type)
+            {
+            case DlInferType_Int32:
+                return blendOrWrite<int32_t>(img, mask.as<int32_t>(), width, height, alpha, writer, input);
+            case DlInferType_Int64:
+                return blendOrWrite<int64_t>(img, mask.as<int64_t>(), width, height, alpha, writer, input);
+            case DlInferType_Float32:
+                if (nclasses > 1)
+                {
+                    /* classwise array is not merged by the model and need to
+                    be merged */
+                    vector<float> arr(width * height);
+                    argMax<float>(arr.data(), mask.as<float>(), width, height, nclasses);
+                    return blendOrWrite<float>(img, arr.data(), width, height, alpha, writer, input);
+                }
+                return blendOrWrite<float>(img, mask.as<float>(), width, height, alpha, writer, input);
+            default:
+                LOG_ERROR("op tensor type %s not supported\n", getTypeName(mask.type));
+                return RETURN_FAIL;
+            }
+        }
+
+        int processResult(ModelInfo *modelInfo, Settings *s, const Inferer *inferer, cv::Mat *img,
+                          ResultWriter *writer, const string &input)
+        {
+            return processResult(modelInfo, s, inferer->outputs(), img, writer, input);
+        }
+
+        int processResult(ModelInfo *modelInfo, Settings *s, const vector<TensorView> &outputs, cv::Mat *img,
+                          ResultWriter *writer, const string &input)
+        {
+            if (outputs.empty())
+            {
+                LOG_ERROR("no outputs to process\n");
+                return RETURN_FAIL;
+            }
+            const string &taskType = modelInfo->m_preProcCfg.taskType;
+            if (taskType == "classification")
+                return prepClassificationResult(img, outputs, s, modelInfo, writer, input);
+            else if (taskType == "detection")
+                return prepDetection(img, outputs, modelInfo, writer, input);
+            else if (taskType == "segmentation")
+                return prepSegResult(img, outputs, modelInfo, writer, input);
+            LOG_ERROR("task type %s not supported\n", taskType.c_str());
+            return RETURN_FAIL;
+        }
+
+        /**
+         *  \brief  sets up the input of a loaded backend, its own buffer when
+         *          it has one, memory owned by inputBuffer otherwise
+         *  \param  s user input options
+         *  \param  inferer loaded backend
+         *  \param  inputBuffer owns the input memory when the backend does
+         *          not
+         *  \param  input filled with the input to preprocess into and bind
+         * @returns int status
+         */
+        static int prepareInput(Settings *s, Inferer *inferer, PooledBuffer *inputBuffer, TensorView *input)
+        {
+            /* fill the backend owned input in place when there is one */
+            *input = inferer->getInput(0);
+            for (int64_t &dim : input->shape)
+            {
+                if (dim < 0)
+                    dim = 1;
+            }
+            if (input->data == nullptr)
+            {
+                *inputBuffer = SharedTensorPool::get().acquire(input->getSizeBytes(), SharedTensorPool::MIN_ALIGNMENT,
+                                                               s->accel || s->device_mem);
+                input->data = inputBuffer->data();
+                if (input->data == nullptr)
+                {
+                    LOG_ERROR("Could not allocate memory for input\n");
+                    return RETURN_FAIL;
+                }
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int loadInferer(ModelInfo *modelInfo, Settings *s, const InfererOptions &options,
+                        std::unique_ptr<Inferer> *inferer, PooledBuffer *inputBuffer, TensorView *input)
+        {
+            *inferer = createInferer(modelInfo->m_infConfig.rtType);
+            if (!*inferer)
+                return RETURN_FAIL;
+            if (RETURN_FAIL == (*inferer)->load(modelInfo->m_infConfig, options))
+                return RETURN_FAIL;
+            (*inferer)->dumpIO();
+
+            const Inferer::IODescription &io = (*inferer)->describeIO();
+            if (io.inputs.size() != 1)
+            {
+                LOG_ERROR("Supports only single input models \n");
+                return RETURN_FAIL;
+            }
+            if (RETURN_FAIL == checkInput(io.inputs[0], modelInfo->m_preProcCfg))
+                return RETURN_FAIL;
+            return prepareInput(s, inferer->get(), inputBuffer, input);
+        }
+
+        int runThreadSweep(ModelInfo *modelInfo, Settings *s, const string &path)
+        {
+            const bool ort = modelInfo->m_infConfig.rtType == "onnxrt";
+            const InfererOptions base = getInfererOptions(modelInfo, s);
+
+            /* 1, 2, 4 ... threads up to the number of cpus */
+            int32_t ncpu = base.cpuAffinity.empty() ? (int32_t)std::thread::hardware_concurrency()
+                                                    : (int32_t)base.cpuAffinity.size();
+            ncpu = std::max(ncpu, 1);
+            vector<int32_t> threads;
+            for (int32_t t = 1; t < ncpu; t *= 2)
+                threads.push_back(t);
+            threads.push_back(ncpu);
+
+            vector<InfererOptions> configs;
+            for (int32_t t : threads)
+            {
+                InfererOptions options = base;
+                if (!ort)
+                {
+                    options.numThreads = t;
+                    configs.push_back(options);
+                    continue;
+                }
+                options.intraOpThreads = t;
+                for (const char *mode : {"sequential", "parallel"})
+                {
+                    options.executionMode = mode;
+                    for (int32_t spin : {1, 0})
+                    {
+                        options.allowSpinning = spin;
+                        configs.push_back(options);
+                    }
+                }
+            }
+
+            int num_iter = s->loop_count > 0 ? s->loop_count : 1;
+            printf("\n%s thread sweep on %s, %d runs per configuration\n",
+                   modelInfo->m_infConfig.rtType.c_str(), path.c_str(), num_iter);
+            LatencyHistogram::printHeader(ort ? "threads mode spin (ms)" : "threads (ms)", 24);
+            double best_ms = 0;
+            string best;
+            for (const InfererOptions &options : configs)
+            {
+                char name[64];
+                if (ort)
+                    snprintf(name, sizeof(name), "%d %s %s", options.intraOpThreads, options.executionMode.c_str(),
+                             options.allowSpinning ? "spin" : "nospin");
+                else
+                    snprintf(name, sizeof(name), "%d", options.numThreads);
+
+                std::unique_ptr<Inferer> inferer;
+                PooledBuffer inputBuffer;
+                TensorView input;
+                cv::Mat img;
+                if (RETURN_FAIL == loadInferer(modelInfo, s, options, &inferer, &inputBuffer, &input) ||
+                    RETURN_FAIL == preprocInput(modelInfo, path, input, &img) ||
+                    RETURN_FAIL == inferer->bindInput(0, input))
+                {
+                    printf("%-24s %8s\n", name, "failed");
+                    continue;
+                }
+
+                /* TVM starts a thread pool per calling thread on its first
+                run and keeps its size and pinning, so every configuration
+                runs on a thread of its own */
+                bool failed = false;
+                LatencyHistogram runHist;
+                std::thread runner([&] {
+                    for (int i = 0; i < s->number_of_warmup_runs && !failed; i++)
+                        failed = RETURN_FAIL == inferer->run();
+                    for (int i = 0; i < num_iter && !failed; i++)
+                    {
+                        uint64_t start_ns = getMonotonicNs();
+                        failed = RETURN_FAIL == inferer->run();
+                        runHist.record(getMonotonicNs() - start_ns);
+                    }
+                });
+                runner.join();
+                if (failed)
+                {
+                    printf("%-24s %8s\n", name, "failed");
+                    continue;
+                }
+                runHist.print(name, 24);
+                double mean_ms = runHist.summarize().meanMs;
+                if (best.empty() || mean_ms < best_ms)
+                {
+                    best_ms = mean_ms;
+                    best = name;
+                }
+            }
+            if (!best.empty())
+                printf("fastest: %s, %.2f infer/s\n", best.c_str(), best_ms > 0 ? 1000 / best_ms : 0.0);
+            return RETURN_SUCCESS;
+        }
+
+        /**
+         *  \brief  path of the rendered frame of one input
+         *  \param  defaultPath output path of the model
+         *  \param  input path of the input image
+         *  \param  single true when the run has a single input
+         * @returns defaultPath, suffixed with the input name when there are
+         *          several inputs
+         */
+        static string getFramePath(const string &defaultPath, const string &input, bool single)
+        {
+            if (single)
+                return defaultPath;
+            size_t slash = input.rfind('/');
+            string stem = input.substr(slash == string::npos ? 0 : slash + 1);
+            size_t dot = stem.rfind('.');
+            if (dot != string::npos)
+                stem.erase(dot);
+            dot = defaultPath.rfind('.');
+            return defaultPath.substr(0, dot) + "_" + stem + defaultPath.substr(dot);
+        }
+
+        /**
+         *  \brief  one model instance of runWorkers() with its input
+         */
+        struct Worker
+        {
+            std::unique_ptr<Inferer> inferer;
+            PooledBuffer inputBuffer;
+            TensorView input;
+        };
+
+        int runWorkers(ModelInfo *modelInfo, Settings *s, const vector<string> &inputs)
+        {
+            const int num_workers = s->num_workers;
+            const InfererOptions options = getInfererOptions(modelInfo, s);
+
+            /* every worker runs its own runtime thread pool */
+            int32_t threads = options.numThreads > 0 ? options.numThreads : 1;
+            if (modelInfo->m_infConfig.rtType == "onnxrt" && options.intraOpThreads > 0)
+                threads = options.intraOpThreads;
+            int32_t ncpu = (int32_t)std::thread::hardware_concurrency();
+            if (ncpu > 0 && num_workers * threads > ncpu)
+            {
+                LOG_WARN("%d workers of %d threads oversubscribe the %d cpus, consider -t %d\n",
+                         num_workers, threads, ncpu, std::max(ncpu / num_workers, 1));
+            }
+
+            /* with a cpu list, each worker runtime is pinned to its share
+            where the backend starts its thread pool */
+            vector<vector<int32_t>> worker_cpus(num_workers, options.cpuAffinity);
+            if ((int)options.cpuAffinity.size() >= num_workers)
+            {
+                size_t share = options.cpuAffinity.size() / num_workers;
+                for (int w = 0; w < num_workers; w++)
+                {
+                    worker_cpus[w].assign(options.cpuAffinity.begin() + w * share,
+                                          options.cpuAffinity.begin() + (w + 1) * share);
+                }
+            }
+
+            /* the first instance loads the model, the others share what the
+            backend allows, the resident memory tells the cost of each */
+            vector<std::unique_ptr<Worker>> workers;
+            size_t rss_start = getResidentBytes();
+            workers.emplace_back(new Worker);
+            Worker *first = workers[0].get();
+            InfererOptions worker_options = options;
+            worker_options.cpuAffinity = worker_cpus[0];
+            if (RETURN_FAIL == loadInferer(modelInfo, s, worker_options, &first->inferer, &first->inputBuffer, &first->input))
+                return RETURN_FAIL;
+            size_t rss_first = getResidentBytes();
+            for (int w = 1; w < num_workers; w++)
+            {
+                std::unique_ptr<Worker> worker(new Worker);
+                worker_options.cpuAffinity = worker_cpus[w];
+                worker->inferer = first->inferer->createWorker(modelInfo->m_infConfig, worker_options);
+                if (!worker->inferer)
+                {
+                    LOG_ERROR("Could not create worker %d\n", w);
+                    return RETURN_FAIL;
+                }
+                if (RETURN_FAIL == prepareInput(s, worker->inferer.get(), &worker->inputBuffer, &worker->input))
+                    return RETURN_FAIL;
+                workers.push_back(std::move(worker));
+            }
+            size_t rss_all = getResidentBytes();
+
+            const string &model_name = modelInfo->m_preProcCfg.modelName;
+            const string output_path = ResultWriter::getDefaultPath(s->output_mode, s->image_format, model_name);
+            OutputSink sink(s->output_queue_depth);
+            ResultWriter writer;
+            if (RETURN_FAIL == writer.open(s->output_mode, model_name, output_path, &sink))
+                return RETURN_FAIL;
+
+            const int num_iter = s->loop_count > 0 ? s->loop_count : 1;
+            printf("\n%s on %zu inputs, %d runs per input, 1 to %d workers\n",
+                   first->inferer->getName(), inputs.size(), num_iter, num_workers);
+            printf("%8s %10s %10s %10s %10s\n", "workers", "mean ms", "wall s", "infer/s", "speedup");
+
+            /* one thread per worker for the whole run: the runtime may
+            start its thread pool on the thread of the first run (TVM does,
+            with the cpu list of the worker), so every worker is warmed up
+            on the thread that runs it in every pass. A pass is a new
+            generation that the first active workers handle */
+            std::mutex mutex;
+            std::condition_variable start_cv, done_cv;
+            std::function<void(int)> work;
+            size_t generation = 0;
+            int active = 0, running = num_workers;
+            bool stop = false;
+            std::atomic<size_t> warmup_failed(0);
+            vector<std::thread> worker_threads;
+            for (int w = 0; w < num_workers; w++)
+            {
+                worker_threads.emplace_back([&, w] {
+                    Worker *worker = workers[w].get();
+                    cv::Mat img;
+                    bool ok = RETURN_SUCCESS == preprocInput(modelInfo, inputs[0], worker->input, &img) &&
+                              RETURN_SUCCESS == worker->inferer->bindInput(0, worker->input);
+                    for (int i = 0; i < s->number_of_warmup_runs && ok; i++)
+                        ok = RETURN_SUCCESS == worker->inferer->run();
+                    if (!ok)
+                        warmup_failed++;
+
+                    size_t seen = 0;
+                    std::unique_lock<std::mutex> lock(mutex);
+                    if (--running == 0)
+                        done_cv.notify_one();
+                    for (;;)
+                    {
+                        start_cv.wait(lock, [&] { return stop || generation != seen; });
+                        if (stop)
+                            return;
+                        seen = generation;
+                        if (w >= active)
+                            continue;
+                        lock.unlock();
+                        work(w);
+                        lock.lock();
+                        if (--running == 0)
+                            done_cv.notify_one();
+                    }
+                });
+            }
+            auto stopWorkers = [&] {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stop = true;
+                }
+                start_cv.notify_all();
+                for (std::thread &thread : worker_threads)
+                    thread.join();
+            };
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                done_cv.wait(lock, [&] { return running == 0; });
+            }
+            if (warmup_failed > 0)
+            {
+                LOG_ERROR("%zu workers failed to warm up\n", (size_t)warmup_failed);
+                stopWorkers();
+                return RETURN_FAIL;
+            }
+
+            double base_ips = 0, mean_ms = 0;
+            vector<LatencyHistogram> passHists(num_workers);
+            vector<LatencyHistogram> lastHists;
+            vector<size_t> last_done;
+            size_t failed = 0;
+            for (int num_active = 1; num_active <= num_workers; num_active++)
+            {
+                /* only the last pass writes the results */
+                const bool last = num_active == num_workers;
+                std::atomic<size_t> next(0);
+                std::atomic<size_t> pass_failed(0);
+                std::mutex result_mutex;
+                vector<LatencyHistogram> runHists(num_active);
+                vector<size_t> done(num_active, 0);
+
+                auto pass = [&](int w) {
+                    Worker *worker = workers[w].get();
+                    for (size_t n = next++; n < inputs.size(); n = next++)
+                    {
+                        const string &path = inputs[n];
+                        cv::Mat img;
+                        if (RETURN_FAIL == preprocInput(modelInfo, path, worker->input, &img) ||
+                            RETURN_FAIL == worker->inferer->bindInput(0, worker->input))
+                        {
+                            pass_failed++;
+                            continue;
+                        }
+                        bool ok = true;
+                        for (int i = 0; i < num_iter && ok; i++)
+                        {
+                            uint64_t start_ns = getMonotonicNs();
+                            ok = RETURN_FAIL != worker->inferer->run();
+                            if (ok)
+                                runHists[w].record(getMonotonicNs() - start_ns);
+                        }
+                        if (!ok)
+                        {
+                            pass_failed++;
+                            continue;
+                        }
+                        done[w]++;
+                        if (!last)
+                            continue;
+
+                        std::lock_guard<std::mutex> lock(result_mutex);
+                        if (RETURN_FAIL == processResult(modelInfo, s, worker->inferer.get(), &img, &writer, path))
+                        {
+                            pass_failed++;
+                            continue;
+                        }
+                        if (!writer.isHeadless())
+                        {
+                            sink.pushFrame(img, getFramePath(output_path, path, inputs.size() == 1), s->image_format);
+                        }
+                    }
+                };
+
+                uint64_t pass_start_ns = getMonotonicNs();
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    work = pass;
+                    active = num_active;
+                    running = num_active;
+                    generation++;
+                    start_cv.notify_all();
+                    done_cv.wait(lock, [&] { return running == 0; });
+                }
+                double wall_s = (getMonotonicNs() - pass_start_ns) / 1e9;
+
+                LatencyHistogram &passHist = passHists[num_active - 1];
+                for (int w = 0; w < num_active; w++)
+                    passHist.merge(runHists[w]);
+                double ips = wall_s > 0 ? passHist.count() / wall_s : 0.0;
+                mean_ms = passHist.summarize().meanMs;
+                if (num_active == 1)
+                    base_ips = ips;
+                printf("%8d %10.3f %10.3f %10.2f %9.2fx\n", num_active, mean_ms, wall_s, ips,
+                       base_ips > 0 ? ips / base_ips : 0.0);
+                failed = pass_failed;
+                if (last)
+                {
+                    lastHists = runHists;
+                    last_done = done;
+                }
+            }
+            stopWorkers();
+
+            /* latency of the runs of every pass, then of every worker of
+            the last one */
+            printf("\n");
+            LatencyHistogram::printHeader("run (ms)", 16);
+            for (int w = 0; w < num_workers; w++)
+            {
+                string name = std::to_string(w + 1) + (w == 0 ? " worker" : " workers");
+                passHists[w].print(name.c_str(), 16);
+            }
+            for (int w = 0; w < num_workers; w++)
+            {
+                string name = "worker " + std::to_string(w) + " (" + std::to_string(last_done[w]) + ")";
+                lastHists[w].print(name.c_str(), 16);
+            }
+
+            printf("resident memory: %.2f MB for the first instance", (rss_first - rss_start) / (1024.0 * 1024.0));
+            if (num_workers > 1)
+                printf(", %.2f MB per additional worker", (rss_all - rss_first) / (1024.0 * 1024.0 * (num_workers - 1)));
+            printf("\n");
+            return failed == 0 ? RETURN_SUCCESS : RETURN_FAIL;
+        }
+
+        int runPipelined(ModelInfo *modelInfo, Settings *s, const vector<string> &inputs)
+        {
+            const int num_sets = s->tensor_sets;
+            std::unique_ptr<Inferer> inferer;
+            PooledBuffer inputBuffer;
+            TensorView input;
+            if (RETURN_FAIL == loadInferer(modelInfo, s, getInfererOptions(modelInfo, s), &inferer, &inputBuffer, &input) ||
+                RETURN_FAIL == inferer->setTensorSets(num_sets))
+                return RETURN_FAIL;
+
+            /* inputs and outputs of every set, taken once */
+            vector<PooledBuffer> setBuffers(num_sets);
+            vector<TensorView> setInputs(num_sets);
+            vector<vector<TensorView>> setOutputs(num_sets);
+            for (int k = 0; k < num_sets; k++)
+            {
+                if (RETURN_FAIL == inferer->selectTensorSet(k) ||
+                    RETURN_FAIL == prepareInput(s, inferer.get(), &setBuffers[k], &setInputs[k]))
+                    return RETURN_FAIL;
+                setOutputs[k] = inferer->outputs();
+            }
+
+            const string &model_name = modelInfo->m_preProcCfg.modelName;
+            const string output_path = ResultWriter::getDefaultPath(s->output_mode, s->image_format, model_name);
+            OutputSink sink(s->output_queue_depth);
+            ResultWriter writer;
+            ResultWriter dropWriter;
+            if (RETURN_FAIL == writer.open(s->output_mode, model_name, output_path, &sink) ||
+                RETURN_FAIL == dropWriter.open(OUTPUT_MODE_NONE, model_name, "", nullptr))
+                return RETURN_FAIL;
+
+            /* every pass goes over all the inputs, only the first pass
+            writes its results */
+            const int num_passes = s->loop_count > 0 ? s->loop_count : 1;
+            const size_t num_frames = inputs.size() * num_passes;
+
+            cv::Mat img;
+            if (RETURN_FAIL == inferer->selectTensorSet(0) ||
+                RETURN_FAIL == preprocInput(modelInfo, inputs[0], setInputs[0], &img) ||
+                RETURN_FAIL == inferer->bindInput(0, setInputs[0]))
+                return RETURN_FAIL;
+            LOG_INFO("%s run - Started for warmup runs\n", inferer->getName());
+            for (int i = 0; i < s->number_of_warmup_runs; i++)
+            {
+                if (RETURN_FAIL == inferer->run())
+                    return RETURN_FAIL;
+            }
+
+            /* single buffered: preprocess, run and post-process one after
+            the other on one set */
+            LatencyHistogram singleRunHist, singleFrameHist;
+            size_t failed = 0;
+            uint64_t single_start_ns = getMonotonicNs();
+            for (size_t n = 0; n < num_frames; n++)
+            {
+                const string &path = inputs[n % inputs.size()];
+                uint64_t frame_start_ns = getMonotonicNs();
+                if (RETURN_FAIL == preprocInput(modelInfo, path, setInputs[0], &img) ||
+                    RETURN_FAIL == inferer->bindInput(0, setInputs[0]))
+                {
+                    failed++;
+                    continue;
+                }
+                uint64_t run_start_ns = getMonotonicNs();
+                if (RETURN_FAIL == inferer->run())
+                {
+                    failed++;
+                    continue;
+                }
+                singleRunHist.record(getMonotonicNs() - run_start_ns);
+                if (RETURN_FAIL == processResult(modelInfo, s, setOutputs[0], &img, &dropWriter, path))
+                {
+                    failed++;
+                    continue;
+                }
+                singleFrameHist.record(getMonotonicNs() - frame_start_ns);
+            }
+            double single_s = (getMonotonicNs() - single_start_ns) / 1e9;
+
+            /* pipelined: the next frame is preprocessed into a free set and
+            the previous one post-processed while the current one runs */
+            enum SetState
+            {
+                SET_FREE,
+                SET_FILLED,
+                SET_DONE
+            };
+            vector<SetState> state(num_sets, SET_FREE);
+            vector<cv::Mat> imgs(num_sets);
+            vector<char> ok(num_sets, 0);
+            std::mutex mutex;
+            std::condition_variable cond;
+            auto waitFor = [&](int k, SetState wanted) {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [&] { return state[k] == wanted; });
+            };
+            auto setState = [&](int k, SetState next) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    state[k] = next;
+                }
+                cond.notify_all();
+            };
+
+            /* a frame is timed from the start of its preprocessing to the
+            end of its post-processing, each thread records its own
+            histogram */
+            std::atomic<size_t> pipe_failed(0);
+            LatencyHistogram pipeRunHist, pipeFrameHist;
+            vector<uint64_t> frame_start_ns(num_sets, 0);
+            uint64_t pipe_start_ns = getMonotonicNs();
+            std::thread pre([&] {
+                for (size_t n = 0; n < num_frames; n++)
+                {
+                    int k = n % num_sets;
+                    waitFor(k, SET_FREE);
+                    frame_start_ns[k] = getMonotonicNs();
+                    ok[k] = RETURN_SUCCESS == preprocInput(modelInfo, inputs[n % inputs.size()], setInputs[k], &imgs[k]);
+                    setState(k, SET_FILLED);
+                }
+            });
+            std::thread post([&] {
+                for (size_t n = 0; n < num_frames; n++)
+                {
+                    int k = n % num_sets;
+                    waitFor(k, SET_DONE);
+                    const string &path = inputs[n % inputs.size()];
+                    bool first = n < inputs.size();
+                    if (!ok[k] ||
+                        RETURN_FAIL == processResult(modelInfo, s, setOutputs[k], &imgs[k], first ? &writer : &dropWriter, path))
+                    {
+                        pipe_failed++;
+                    }
+                    else
+                    {
+                        pipeFrameHist.record(getMonotonicNs() - frame_start_ns[k]);
+                        if (first && !writer.isHeadless())
+                            sink.pushFrame(imgs[k], getFramePath(output_path, path, inputs.size() == 1), s->image_format);
+                    }
+                    setState(k, SET_FREE);
+                }
+            });
+            for (size_t n = 0; n < num_frames; n++)
+            {
+                int k = n % num_sets;
+                waitFor(k, SET_FILLED);
+                if (ok[k])
+                {
+                    ok[k] = RETURN_SUCCESS == inferer->selectTensorSet(k) &&
+                            RETURN_SUCCESS == inferer->bindInput(0, setInputs[k]);
+                    uint64_t run_start_ns = getMonotonicNs();
+                    ok[k] = ok[k] && RETURN_SUCCESS == inferer->run();
+                    if (ok[k])
+                        pipeRunHist.record(getMonotonicNs() - run_start_ns);
+                }
+                setState(k, SET_DONE);
+            }
+            pre.join();
+            post.join();
+            double pipe_s = (getMonotonicNs() - pipe_start_ns) / 1e9;
+
+            double single_fps = single_s > 0 ? num_frames / single_s : 0.0;
+            double pipe_fps = pipe_s > 0 ? num_frames / pipe_s : 0.0;
+            double run_ms = pipeRunHist.summarize().meanMs;
+            printf("\n%s on %zu frames, %d tensor sets\n", inferer->getName(), num_frames, num_sets);
+            printf("single buffered: %10.2f fps\n", single_fps);
+            printf("pipelined      : %10.2f fps, %.2fx, %.3f ms per run\n", pipe_fps,
+                   single_fps > 0 ? pipe_fps / single_fps : 0.0, run_ms);
+            printf("\n");
+            LatencyHistogram::printHeader("(ms)", 16);
+            singleRunHist.print("single run", 16);
+            singleFrameHist.print("single frame", 16);
+            pipeRunHist.print("pipelined run", 16);
+            pipeFrameHist.print("pipelined frame", 16);
+            return failed == 0 && pipe_failed == 0 ? RETURN_SUCCESS : RETURN_FAIL;
+        }
+
+        /**
+         *  \brief  time spent by one stage of runStagePipeline()
+         */
+        struct StageStats
+        {
+            /* frames handled and time spent on them */
+            size_t frames{0};
+            double busy_ms{0};
+            LatencyHistogram busy;
+
+            /* waits for work from the previous stage */
+            double starved_ms{0};
+
+            /* waits for room in the next stage */
+            double blocked_ms{0};
+
+            /* number of waits */
+            size_t stalls{0};
+
+            /* sum of the input queue size seen at every pop */
+            size_t queued{0};
+        };
+
+        /**
+         *  \brief  buffers of one frame in flight in runStagePipeline(),
+         *          taken once and reused for every frame
+         */
+        struct FrameSlot
+        {
+            size_t frame{0};
+            bool ok{false};
+            PooledBuffer inputBuffer;
+            TensorView input;
+            cv::Mat img;
+            vector<PooledBuffer> outputBuffers;
+            vector<TensorView> outputs;
+        };
+
+        /**
+         *  \brief  pops from a queue, sleeping while it is empty
+         *  \param  queue queue to pop from
+         *  \param  slot filled with the popped item
+         *  \param  stats stats of the popping stage
+         *  \param  starved true to count the wait as starved, as blocked
+         *          otherwise
+         */
+        static void popWait(SpscQueue<FrameSlot *> *queue, FrameSlot **slot, StageStats *stats, bool starved)
+        {
+            stats->queued += queue->size();
+            if (queue->pop(slot))
+                return;
+            uint64_t start_ns = getMonotonicNs();
+            queue->popWait(slot);
+            double ms = (getMonotonicNs() - start_ns) / 1e6;
+            if (starved)
+                stats->starved_ms += ms;
+            else
+                stats->blocked_ms += ms;
+            stats->stalls++;
+        }
+
+        /**
+         *  \brief  pushes to a queue, sleeping while it is full
+         *  \param  queue queue to push to
+         *  \param  slot item to push
+         *  \param  stats stats of the pushing stage
+         */
+        static void pushWait(SpscQueue<FrameSlot *> *queue, FrameSlot *slot, StageStats *stats)
+        {
+            if (queue->push(slot))
+                return;
+            uint64_t start_ns = getMonotonicNs();
+            queue->pushWait(slot);
+            stats->blocked_ms += (getMonotonicNs() - start_ns) / 1e6;
+            stats->stalls++;
+        }
+
+        /**
+         *  \brief  copies the outputs of the last run into a slot, the
+         *          buffers are only taken again when an output grows
+         *  \param  outputs outputs of the inferer
+         *  \param  slot slot to copy into
+         * @returns int status
+         */
+        static int copyOutputs(const vector<TensorView> &outputs, FrameSlot *slot)
+        {
+            slot->outputs.resize(outputs.size());
+            slot->outputBuffers.resize(outputs.size());
+            for (size_t i = 0; i < outputs.size(); i++)
+            {
+                size_t size = outputs[i].getSizeBytes();
+                PooledBuffer &buffer = slot->outputBuffers[i];
+                if (buffer.size() < size)
+                {
+                    buffer = SharedTensorPool::get().acquire(size, SharedTensorPool::MIN_ALIGNMENT, false);
+                    if (!buffer)
+                        return RETURN_FAIL;
+                }
+                memcpy(buffer.data(), outputs[i].data, size);
+                slot->outputs[i] = outputs[i];
+                slot->outputs[i].data = buffer.data();
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int runStagePipeline(ModelInfo *modelInfo, Settings *s, const vector<string> &inputs)
+        {
+            std::unique_ptr<Inferer> inferer;
+            PooledBuffer inputBuffer;
+            TensorView input;
+            if (RETURN_FAIL == loadInferer(modelInfo, s, getInfererOptions(modelInfo, s), &inferer, &inputBuffer, &input))
+                return RETURN_FAIL;
+
+            /* the slots own their input so that the next frame can be
+            preprocessed while the backend runs the current one */
+            const int depth = s->pipeline_depth;
+            vector<std::unique_ptr<FrameSlot>> slots;
+            SpscQueue<FrameSlot *> freeSlots(depth + 1);
+            SpscQueue<FrameSlot *> preprocessed(depth + 1);
+            SpscQueue<FrameSlot *> inferred(depth + 1);
+            for (int i = 0; i < depth; i++)
+            {
+                std::unique_ptr<FrameSlot> slot(new FrameSlot);
+                slot->input = input;
+                slot->inputBuffer = SharedTensorPool::get().acquire(input.getSizeBytes(), SharedTensorPool::MIN_ALIGNMENT,
+                                                                    s->accel || s->device_mem);
+                slot->input.data = slot->inputBuffer.data();
+                if (slot->input.data == nullptr)
+                {
+                    LOG_ERROR("Could not allocate memory for input\n");
+                    return RETURN_FAIL;
+                }
+                freeSlots.push(slot.get());
+                slots.push_back(std::move(slot));
+            }
+
+            const string &model_name = modelInfo->m_preProcCfg.modelName;
+            const string output_path = ResultWriter::getDefaultPath(s->output_mode, s->image_format, model_name);
+            OutputSink sink(s->output_queue_depth);
+            ResultWriter writer;
+            ResultWriter dropWriter;
+            if (RETURN_FAIL == writer.open(s->output_mode, model_name, output_path, &sink) ||
+                RETURN_FAIL == dropWriter.open(OUTPUT_MODE_NONE, model_name, "", nullptr))
+                return RETURN_FAIL;
+
+            FrameSlot *first = slots[0].get();
+            if (RETURN_FAIL == preprocInput(modelInfo, inputs[0], first->input, &first->img) ||
+                RETURN_FAIL == inferer->bindInput(0, first->input))
+                return RETURN_FAIL;
+            LOG_INFO("%s run - Started for warmup runs\n", inferer->getName());
+            for (int i = 0; i < s->number_of_warmup_runs; i++)
+            {
+                if (RETURN_FAIL == inferer->run())
+                    return RETURN_FAIL;
+            }
+
+            /* every pass goes over all the inputs, only the first pass
+            writes its results */
+            const int num_passes = s->loop_count > 0 ? s->loop_count : 1;
+            const size_t num_frames = inputs.size() * num_passes;
+            StageStats stats[3];
+            std::atomic<size_t> failed(0);
+
+            /* each stage thread only touches its own stats */
+            auto endBusy = [](StageStats *st, uint64_t start_ns) {
+                uint64_t ns = getMonotonicNs() - start_ns;
+                st->busy.record(ns);
+                st->busy_ms += ns / 1e6;
+                st->frames++;
+            };
+
+            uint64_t start_ns = getMonotonicNs();
+            std::thread pre([&] {
+                StageStats *st = &stats[0];
+                for (size_t n = 0; n < num_frames; n++)
+                {
+                    FrameSlot *slot;
+                    popWait(&freeSlots, &slot, st, false);
+                    uint64_t busy_start_ns = getMonotonicNs();
+                    slot->frame = n;
+                    slot->ok = RETURN_SUCCESS == preprocInput(modelInfo, inputs[n % inputs.size()], slot->input, &slot->img);
+                    endBusy(st, busy_start_ns);
+                    pushWait(&preprocessed, slot, st);
+                }
+                pushWait(&preprocessed, nullptr, st);
+            });
+            std::thread post([&] {
+                StageStats *st = &stats[2];
+                FrameSlot *slot;
+                for (popWait(&inferred, &slot, st, true); slot != nullptr; popWait(&inferred, &slot, st, true))
+                {
+                    uint64_t busy_start_ns = getMonotonicNs();
+                    const string &path = inputs[slot->frame % inputs.size()];
+                    bool firstPass = slot->frame < inputs.size();
+                    if (!slot->ok ||
+                        RETURN_FAIL == processResult(modelInfo, s, slot->outputs, &slot->img,
+                                                     firstPass ? &writer : &dropWriter, path))
+                    {
+                        failed++;
+                    }
+                    else if (firstPass && !writer.isHeadless())
+                    {
+                        sink.pushFrame(slot->img, getFramePath(output_path, path, inputs.size() == 1), s->image_format);
+                    }
+                    endBusy(st, busy_start_ns);
+                    pushWait(&freeSlots, slot, st);
+                }
+            });
+
+            /* the inference stage runs on this thread */
+            StageStats *st = &stats[1];
+            FrameSlot *slot;
+            for (popWait(&preprocessed, &slot, st, true); slot != nullptr; popWait(&preprocessed, &slot, st, true))
+            {
+                uint64_t busy_start_ns = getMonotonicNs();
+                if (slot->ok)
+                {
+                    slot->ok = RETURN_SUCCESS == inferer->bindInput(0, slot->input) &&
+                               RETURN_SUCCESS == inferer->run() &&
+                               RETURN_SUCCESS == copyOutputs(inferer->outputs(), slot);
+                }
+                endBusy(st, busy_start_ns);
+                pushWait(&inferred, slot, st);
+            }
+            pushWait(&inferred, nullptr, st);
+            pre.join();
+            post.join();
+            double wall_ms = (getMonotonicNs() - start_ns) / 1e6;
+
+            static const char *names[] = {"preprocess", "inference", "postprocess"};
+            double sum_ms = 0, max_ms = 0;
+            printf("\n%s on %zu frames, pipeline depth %d, %.3f s\n", inferer->getName(), num_frames, depth,
+                   wall_ms / 1000);
+            printf("%-12s %10s %10s %11s %11s %8s %10s\n", "stage", "ms/frame", "occupancy", "starved ms",
+                   "blocked ms", "stalls", "avg queue");
+            for (int i = 0; i < 3; i++)
+            {
+                const StageStats &stage = stats[i];
+                double frame_ms = stage.frames > 0 ? stage.busy_ms / stage.frames : 0.0;
+                sum_ms += frame_ms;
+                max_ms = std::max(max_ms, frame_ms);
+                printf("%-12s %10.3f %9.1f%% %11.1f %11.1f %8zu %10.2f\n", names[i], frame_ms,
+                       wall_ms > 0 ? 100 * stage.busy_ms / wall_ms : 0.0, stage.starved_ms, stage.blocked_ms,
+                       stage.stalls, num_frames > 0 ? (double)stage.queued / num_frames : 0.0);
+            }
+            printf("throughput %.2f fps, slowest stage bound %.2f fps, serial %.2f fps\n",
+                   wall_ms > 0 ? 1000 * num_frames / wall_ms : 0.0, max_ms > 0 ? 1000 / max_ms : 0.0,
+                   sum_ms > 0 ? 1000 / sum_ms : 0.0);
+            printf("\n");
+            LatencyHistogram::printHeader();
+            for (int i = 0; i < 3; i++)
+                stats[i].busy.print(names[i]);
+            return failed == 0 ? RETURN_SUCCESS : RETURN_FAIL;
+        }
+
+        /**
+         *  \brief  one model of runMultiModel() with its backend and output
+         */
+        struct ModelSlot
+        {
+            ModelInfo *modelInfo{nullptr};
+            std::unique_ptr<Inferer> inferer;
+            PooledBuffer inputBuffer;
+            TensorView input;
+            string outputPath;
+            ResultWriter writer;
+            LatencyHistogram soloHist;
+            LatencyHistogram concurrentHist;
+            size_t failed{0};
+        };
+
+        int runMultiModel(ModelInfo *modelInfo, Settings *s, const vector<string> &inputs)
+        {
+            /* the sink outlives the writers of the models, which flush it
+            when they close */
+            OutputSink sink(s->output_queue_depth);
+            vector<std::unique_ptr<ModelInfo>> extraInfos;
+            vector<std::unique_ptr<ModelSlot>> models;
+            models.emplace_back(new ModelSlot);
+            models[0]->modelInfo = modelInfo;
+            for (const string &dir : s->model_dirs)
+            {
+                std::unique_ptr<ModelInfo> info(new ModelInfo(dir));
+                info->m_labelsPath = s->labels_file_path;
+                if (info->initialize() == RETURN_FAIL)
+                {
+                    LOG_ERROR("Failed to initialize model %s\n", dir.c_str());
+                    return RETURN_FAIL;
+                }
+                models.emplace_back(new ModelSlot);
+                models.back()->modelInfo = info.get();
+                extraInfos.push_back(std::move(info));
+            }
+
+            const int num_iter = s->loop_count > 0 ? s->loop_count : 1;
+            cv::Mat frame = decodeImage(inputs[0]);
+            if (frame.empty())
+                return RETURN_FAIL;
+            for (std::unique_ptr<ModelSlot> &model : models)
+            {
+                ModelInfo *info = model->modelInfo;
+                if (RETURN_FAIL == loadInferer(info, s, getInfererOptions(info, s), &model->inferer,
+                                               &model->inputBuffer, &model->input))
+                    return RETURN_FAIL;
+                const string &model_name = info->m_preProcCfg.modelName;
+                model->outputPath = ResultWriter::getDefaultPath(s->output_mode, s->image_format, model_name);
+                if (RETURN_FAIL == model->writer.open(s->output_mode, model_name, model->outputPath, &sink))
+                    return RETURN_FAIL;
+
+                /* latency of the model running alone, to compare with the
+                concurrent runs */
+                cv::Mat img;
+                if (RETURN_FAIL == preprocFrame(info, frame, model->input, &img) ||
+                    RETURN_FAIL == model->inferer->bindInput(0, model->input))
+                    return RETURN_FAIL;
+                for (int i = 0; i < s->number_of_warmup_runs; i++)
+                {
+                    if (RETURN_FAIL == model->inferer->run())
+                        return RETURN_FAIL;
+                }
+                for (int i = 0; i < num_iter; i++)
+                {
+                    uint64_t start_ns = getMonotonicNs();
+                    if (RETURN_FAIL == model->inferer->run())
+                        return RETURN_FAIL;
+                    model->soloHist.record(getMonotonicNs() - start_ns);
+                }
+            }
+
+            /* frame handed to the model threads, written by this thread
+            while they wait */
+            std::map<std::pair<int, int>, cv::Mat> resized;
+            const string *current = nullptr;
+
+            auto work = [&](ModelSlot *model) {
+                ModelInfo *info = model->modelInfo;
+                const string &path = *current;
+                const PreprocessImageConfig &cfg = info->m_preProcCfg;
+                const cv::Mat &shared = resized.at(std::make_pair(cfg.outDataWidth, cfg.outDataHeight));
+                cv::Mat img;
+                if (RETURN_FAIL == preprocFrame(info, shared, model->input, &img) ||
+                    RETURN_FAIL == model->inferer->bindInput(0, model->input))
+                {
+                    model->failed++;
+                    return;
+                }
+                for (int i = 0; i < num_iter; i++)
+                {
+                    uint64_t start_ns = getMonotonicNs();
+                    if (RETURN_FAIL == model->inferer->run())
+                    {
+                        model->failed++;
+                        return;
+                    }
+                    model->concurrentHist.record(getMonotonicNs() - start_ns);
+                }
+
+                /* the resized frame is shared, draw on a copy */
+                if (!model->writer.isHeadless())
+                    img = img.clone();
+                if (RETURN_FAIL == processResult(info, s, model->inferer.get(), &img, &model->writer, path))
+                {
+                    model->failed++;
+                    return;
+                }
+                if (!model->writer.isHeadless())
+                {
+                    sink.pushFrame(img, getFramePath(model->outputPath, path, inputs.size() == 1), s->image_format);
+                }
+            };
+
+            /* one thread per model for the whole run, each frame is a new
+            generation that every thread handles once */
+            std::mutex mutex;
+            std::condition_variable start_cv, done_cv;
+            size_t generation = 0, running = 0;
+            bool stop = false;
+            vector<std::thread> threads;
+            for (std::unique_ptr<ModelSlot> &model : models)
+            {
+                ModelSlot *slot = model.get();
+                threads.emplace_back([&, slot] {
+                    size_t seen = 0;
+                    std::unique_lock<std::mutex> lock(mutex);
+                    for (;;)
+                    {
+                        start_cv.wait(lock, [&] { return stop || generation != seen; });
+                        if (stop)
+                            return;
+                        seen = generation;
+                        lock.unlock();
+                        work(slot);
+                        lock.lock();
+                        if (--running == 0)
+                            done_cv.notify_one();
+                    }
+                });
+            }
+
+            LatencyHistogram decodeHist, resizeHist;
+            size_t resizes = 0, frames = 0;
+            uint64_t total_start_ns = getMonotonicNs();
+            for (const string &path : inputs)
+            {
+                /* decode once, then resize once per distinct model input
+                size */
+                uint64_t start_ns = getMonotonicNs();
+                frame = decodeImage(path);
+                decodeHist.record(getMonotonicNs() - start_ns);
+                if (frame.empty())
+                {
+                    for (std::unique_ptr<ModelSlot> &model : models)
+                        model->failed++;
+                    continue;
+                }
+                frames++;
+
+                start_ns = getMonotonicNs();
+                resized.clear();
+                for (std::unique_ptr<ModelSlot> &model : models)
+                {
+                    const PreprocessImageConfig &cfg = model->modelInfo->m_preProcCfg;
+                    std::pair<int, int> size(cfg.outDataWidth, cfg.outDataHeight);
+                    if (resized.count(size) != 0)
+                        continue;
+                    cv::resize(frame, resized[size], cv::Size(size.first, size.second), 0, 0, cv::INTER_AREA);
+                    resizes++;
+                }
+                resizeHist.record(getMonotonicNs() - start_ns);
+
+                current = &path;
+                std::unique_lock<std::mutex> lock(mutex);
+                running = models.size();
+                generation++;
+                start_cv.notify_all();
+                done_cv.wait(lock, [&] { return running == 0; });
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            start_cv.notify_all();
+            for (std::thread &thread : threads)
+                thread.join();
+            double total_s = (getMonotonicNs() - total_start_ns) / 1e9;
+
+            printf("\n%zu models on %zu frames, decode %.3f ms/frame, resize %.3f ms/frame (%zu resizes for %zu model inputs)\n",
+                   models.size(), frames, decodeHist.summarize().meanMs, resizeHist.summarize().meanMs,
+                   resizes, frames * models.size());
+            printf("%-40s %10s %14s %9s\n", "model", "alone ms", "concurrent ms", "slowdown");
+            size_t failed = 0;
+            for (std::unique_ptr<ModelSlot> &model : models)
+            {
+                double solo_ms = model->soloHist.summarize().meanMs;
+                double mean_ms = model->concurrentHist.summarize().meanMs;
+                printf("%-40s %10.3f %14.3f %8.2fx\n", model->modelInfo->m_preProcCfg.modelName.c_str(),
+                       solo_ms, mean_ms, solo_ms > 0 ? mean_ms / solo_ms : 0.0);
+                failed += model->failed;
+            }
+            printf("%.2f frames/s through all the models\n", total_s > 0 ? frames / total_s : 0.0);
+
+            printf("\n");
+            LatencyHistogram::printHeader("run (ms)", 40);
+            for (std::unique_ptr<ModelSlot> &model : models)
+            {
+                const string &name = model->modelInfo->m_preProcCfg.modelName;
+                model->soloHist.print((name + " alone").c_str(), 40);
+                model->concurrentHist.print((name + " concurrent").c_str(), 40);
+            }
+            decodeHist.print("decode", 40);
+            resizeHist.print("resize", 40);
+            return failed == 0 ? RETURN_SUCCESS : RETURN_FAIL;
+        }
+
+        /**
+         *  \brief  current time in microseconds, on the clock of the
+         *          RequestBatcher arrival times
+         */
+        static double nowUs()
+        {
+            return getMonotonicNs() / 1000.0;
+        }
+
+        int runBatching(ModelInfo *modelInfo, Settings *s, const vector<string> &inputs)
+        {
+            std::unique_ptr<Inferer> inferer;
+            PooledBuffer inputBuffer;
+            TensorView input;
+            if (RETURN_FAIL == loadInferer(modelInfo, s, getInfererOptions(modelInfo, s), &inferer, &inputBuffer, &input))
+                return RETURN_FAIL;
+            /* a dynamic batch is bound with the number of pending requests,
+            a fixed one is padded */
+            const bool dynamic = inferer->describeIO().inputs[0].shape[0] < 0;
+            const bool shared = s->accel || s->device_mem;
+
+            /* every input is preprocessed once, requests point at the
+            samples */
+            TensorView sample = input;
+            sample.shape[0] = 1;
+            const size_t sampleBytes = sample.getSizeBytes();
+            vector<PooledBuffer> samples(inputs.size());
+            vector<cv::Mat> imgs(inputs.size());
+            for (size_t i = 0; i < inputs.size(); i++)
+            {
+                samples[i] = SharedTensorPool::get().acquire(sampleBytes, SharedTensorPool::MIN_ALIGNMENT, false);
+                TensorView view = sample;
+                view.data = samples[i].data();
+                if (view.data == nullptr || RETURN_FAIL == preprocInput(modelInfo, inputs[i], view, &imgs[i]))
+                    return RETURN_FAIL;
+            }
+
+            vector<int32_t> batches;
+            for (int32_t b = 1; b < s->max_batch; b *= 2)
+                batches.push_back(b);
+            batches.push_back(s->max_batch);
+
+            /* the results of the first pass of the largest batch are
+            written, the other runs are post-processed and dropped */
+            const string &model_name = modelInfo->m_preProcCfg.modelName;
+            const string output_path = ResultWriter::getDefaultPath(s->output_mode, s->image_format, model_name);
+            OutputSink sink(s->output_queue_depth);
+            ResultWriter writer;
+            ResultWriter dropWriter;
+            if (RETURN_FAIL == writer.open(s->output_mode, model_name, output_path, &sink) ||
+                RETURN_FAIL == dropWriter.open(OUTPUT_MODE_NONE, model_name, "", nullptr))
+                return RETURN_FAIL;
+
+            const int num_passes = s->loop_count > 0 ? s->loop_count : 1;
+            const size_t num_requests = inputs.size() * num_passes;
+            const double maxWaitUs = s->max_wait_ms * 1000;
+            printf("\n%s, %zu requests at %s, max wait %.2f ms%s\n", inferer->getName(), num_requests,
+                   s->request_rate > 0 ? (std::to_string(s->request_rate) + " req/s").c_str() : "once",
+                   s->max_wait_ms, dynamic ? ", dynamic batch" : "");
+            printf("%6s %10s %9s %10s\n", "batch", "req/s", "avg fill", "mean ms");
+            vector<std::pair<string, LatencyHistogram>> hists;
+            size_t post_failed = 0;
+            for (int32_t batch : batches)
+            {
+                const bool last = batch == batches.back();
+                RequestBatcher batcher(inferer.get(), num_requests);
+                if (RETURN_FAIL == inferer->setBatchSize(batch) ||
+                    RETURN_FAIL == batcher.init(sample, batch, maxWaitUs, shared))
+                {
+                    printf("%6d %10s\n", batch, "failed");
+                    continue;
+                }
+                if (RETURN_FAIL == batcher.warmup(samples[0].data(), s->number_of_warmup_runs))
+                    return RETURN_FAIL;
+
+                /* requests arrive at the given rate, or all at once */
+                const double startUs = nowUs();
+                std::thread producer([&] {
+                    for (size_t n = 0; n < num_requests; n++)
+                    {
+                        if (s->request_rate > 0)
+                        {
+                            double due = startUs + n * 1000000 / s->request_rate;
+                            double wait = due - nowUs();
+                            if (wait > 0)
+                                usleep((useconds_t)wait);
+                        }
+                        batcher.submit({n, samples[n % inputs.size()].data(), nowUs()});
+                    }
+                    batcher.close();
+                });
+
+                vector<BatchResult> results;
+                LatencyHistogram hist;
+                size_t runs = 0;
+                bool failed = false;
+                while (!failed)
+                {
+                    failed = RETURN_FAIL == batcher.runBatch(&results);
+                    if (failed || results.empty())
+                        break;
+                    double doneUs = nowUs();
+                    runs++;
+                    for (const BatchResult &result : results)
+                    {
+                        hist.record((uint64_t)((doneUs - result.request.arrivalUs) * 1000));
+
+                        const size_t n = result.request.id;
+                        const string &path = inputs[n % inputs.size()];
+                        const bool write = last && n < inputs.size();
+                        cv::Mat img = write && !writer.isHeadless() ? imgs[n % inputs.size()].clone()
+                                                                    : imgs[n % inputs.size()];
+                        if (RETURN_FAIL == processResult(modelInfo, s, result.outputs, &img,
+                                                         write ? &writer : &dropWriter, path))
+                        {
+                            post_failed++;
+                        }
+                        else if (write && !writer.isHeadless())
+                        {
+                            sink.pushFrame(img, getFramePath(output_path, path, inputs.size() == 1), s->image_format);
+                        }
+                    }
+                }
+                producer.join();
+                double wall_s = (nowUs() - startUs) / 1000000;
+                if (failed || hist.count() == 0)
+                {
+                    printf("%6d %10s\n", batch, "failed");
+                    continue;
+                }
+
+                printf("%6d %10.2f %9.2f %10.3f\n", batch, wall_s > 0 ? num_requests / wall_s : 0.0,
+                       runs > 0 ? (double)num_requests / runs : 0.0, hist.summarize().meanMs);
+                hists.emplace_back("batch " + std::to_string(batch), hist);
+            }
+
+            /* latency of a request, from its arrival to the end of the run
+            that served it */
+            printf("\n");
+            LatencyHistogram::printHeader("request (ms)");
+            for (const std::pair<string, LatencyHistogram> &entry : hists)
+                entry.second.print(entry.first.c_str());
+            return post_failed == 0 ? RETURN_SUCCESS : RETURN_FAIL;
+        }
+
+        int runFrameRing(ModelInfo *modelInfo, Settings *s)
+        {
+            FrameRing ring;
+            if (RETURN_FAIL == ring.attach(s->frame_ring, 10000))
+                return RETURN_FAIL;
+
+            std::unique_ptr<Inferer> inferer;
+            PooledBuffer inputBuffer;
+            TensorView input;
+            if (RETURN_FAIL == loadInferer(modelInfo, s, getInfererOptions(modelInfo, s), &inferer, &inputBuffer, &input))
+                return RETURN_FAIL;
+            const string &model_name = modelInfo->m_preProcCfg.modelName;
+            const string output_path = ResultWriter::getDefaultPath(s->output_mode, s->image_format, model_name);
+            OutputSink sink(s->output_queue_depth);
+            ResultWriter writer;
+            if (RETURN_FAIL == writer.open(s->output_mode, model_name, output_path, &sink))
+                return RETURN_FAIL;
+            memset(input.data, 0, input.getSizeBytes());
+            if (RETURN_FAIL == inferer->bindInput(0, input))
+                return RETURN_FAIL;
+            for (int i = 0; i < s->number_of_warmup_runs; i++)
+            {
+                if (RETURN_FAIL == inferer->run())
+                    return RETURN_FAIL;
+            }
+            LOG_INFO("%s waiting for frames on %s\n", inferer->getName(), s->frame_ring.c_str());
+
+            LatencyHistogram preprocHist, inferHist, postprocHist, endToEndHist;
+            size_t failed = 0;
+            bool warned = false;
+            uint64_t first_us = 0;
+            while (true)
+            {
+                FrameInfo info;
+                const uint8_t *data = ring.acquireFrame(&info, 1000);
+                if (data == nullptr)
+                {
+                    if (ring.isDrained())
+                        break;
+                    continue;
+                }
+                if (first_us == 0)
+                    first_us = FrameRing::nowUs();
+                const string name = "frame_" + std::to_string(info.frameId);
+
+                /* the frame is read in place in the slot, which goes back to
+                the producer once the outputs are post-processed */
+                uint64_t start_ns = getMonotonicNs();
+                cv::Mat img;
+                int status = RETURN_SUCCESS;
+                if (info.length > ring.slotSize())
+                {
+                    /* never read past the slot, whatever the producer wrote */
+                    LOG_ERROR("%s: %u bytes do not fit the %zu bytes of a slot\n", name.c_str(), info.length,
+                              ring.slotSize());
+                    status = RETURN_FAIL;
+                }
+                else if (info.format == FRAME_FORMAT_TENSOR)
+                {
+                    TensorView view = input;
+                    view.data = const_cast<uint8_t *>(data);
+                    if (info.length != input.getSizeBytes())
+                    {
+                        LOG_ERROR("%s: %u bytes, the input tensor takes %zu\n", name.c_str(), info.length,
+                                  input.getSizeBytes());
+                        status = RETURN_FAIL;
+                    }
+                    else
+                    {
+                        status = inferer->bindInput(0, view);
+                    }
+                }
+                else
+                {
+                    const uint64_t frameBytes = (uint64_t)info.width * info.height * 3;
+                    if (info.width == 0 || info.height == 0 || frameBytes > ring.slotSize())
+                    {
+                        LOG_ERROR("%s: a %ux%u frame does not fit a slot\n", name.c_str(), info.width, info.height);
+                        status = RETURN_FAIL;
+                    }
+                    else if (frameBytes != info.length)
+                    {
+                        LOG_ERROR("%s: %ux%u does not match %u bytes\n", name.c_str(), info.width, info.height,
+                                  info.length);
+                        status = RETURN_FAIL;
+                    }
+                    else
+                    {
+                        cv::Mat frame(info.height, info.width, CV_8UC3, const_cast<uint8_t *>(data));
+                        status = preprocFrame(modelInfo, frame, input, &img);
+                        /* a frame of the model size is not resized, draw on a
+                        copy rather than in the slot */
+                        if (!writer.isHeadless() && img.data == frame.data)
+                            img = img.clone();
+                        if (status == RETURN_SUCCESS)
+                            status = inferer->bindInput(0, input);
+                    }
+                }
+                uint64_t bound_ns = getMonotonicNs();
+                if (status == RETURN_SUCCESS)
+                    status = inferer->run();
+                uint64_t run_ns = getMonotonicNs();
+
+                if (status == RETURN_SUCCESS)
+                {
+                    if (img.empty() && !writer.isHeadless())
+                    {
+                        if (!warned)
+                            LOG_WARN("tensor frames are not drawn, use -o json, binary or none for their results\n");
+                        warned = true;
+                    }
+                    else
+                    {
+                        status = processResult(modelInfo, s, inferer.get(), &img, &writer, name);
+                    }
+                }
+                ring.release();
+                if (status == RETURN_FAIL)
+                {
+                    failed++;
+                    continue;
+                }
+                if (!writer.isHeadless() && !img.empty())
+                    sink.pushFrame(img, getFramePath(output_path, name, false), s->image_format);
+                preprocHist.record(bound_ns - start_ns);
+                inferHist.record(run_ns - bound_ns);
+                postprocHist.record(getMonotonicNs() - run_ns);
+                endToEndHist.record((FrameRing::nowUs() - info.timestampUs) * 1000);
+            }
+
+            if (endToEndHist.count() == 0)
+            {
+                LOG_ERROR("no frame could be processed\n");
+                return RETURN_FAIL;
+            }
+            uint64_t n = endToEndHist.count();
+            double total_s = (FrameRing::nowUs() - first_us) / 1000000.0;
+            LOG_INFO("%s: %llu frames, %zu failed, %f frames/s, %llu waits on the ring\n", inferer->getName(),
+                     (unsigned long long)n, failed, total_s > 0 ? n / total_s : 0.0,
+                     (unsigned long long)ring.getWaits());
+            printf("\n");
+            LatencyHistogram::printHeader();
+            preprocHist.print("preprocess");
+            inferHist.print("inference");
+            postprocHist.print("postprocess");
+            endToEndHist.print("end to end");
+            printf("\n");
+            return failed == 0 ? RETURN_SUCCESS : RETURN_FAIL;
+        }
+
+        /**
+         *  \brief  fills the model and options of a report record
+         */
+        static void fillRecord(ModelInfo *modelInfo, Settings *s, BenchRecord *record)
+        {
+            record->model = modelInfo->m_preProcCfg.modelName;
+            record->modelPath = s->model_zoo_path;
+            record->taskType = modelInfo->m_preProcCfg.taskType;
+            record->runtime = modelInfo->m_infConfig.rtType;
+            record->accel = s->accel;
+            record->deviceMem = s->device_mem;
+            record->threads = s->number_of_threads;
+            record->intraOpThreads = s->intra_op_threads;
+            record->interOpThreads = s->inter_op_threads;
+            record->executionMode = s->execution_mode;
+            record->cpuAffinity.clear();
+            for (size_t i = 0; i < s->cpu_affinity.size(); i++)
+                record->cpuAffinity += (i ? "," : "") + std::to_string(s->cpu_affinity[i]);
+            record->warmupRuns = s->number_of_warmup_runs;
+            record->loopCount = s->loop_count;
+        }
+
+        int runBenchmark(ModelInfo *modelInfo, Settings *s, const vector<string> &inputs, BenchRecord *record)
+        {
+            fillRecord(modelInfo, s, record);
+
+            /* VmHWM is the peak of the whole process, reset it so that the
+            peak is the one of this model. Where the kernel does not allow
+            it the resident size is sampled along the run instead */
+            const bool peak_reset = RETURN_SUCCESS == resetPeakResidentBytes();
+            size_t peak_rss = getResidentBytes();
+
+            std::unique_ptr<Inferer> inferer;
+            PooledBuffer inputBuffer;
+            TensorView input;
+            uint64_t load_start_ns = getMonotonicNs();
+            if (RETURN_FAIL == loadInferer(modelInfo, s, getInfererOptions(modelInfo, s), &inferer, &inputBuffer, &input))
+                return RETURN_FAIL;
+            record->loadMs = (getMonotonicNs() - load_start_ns) / 1e6;
+            peak_rss = std::max(peak_rss, getResidentBytes());
+            record->backend = inferer->getName();
+
+            const string &model_name = modelInfo->m_preProcCfg.modelName;
+            const string output_path = ResultWriter::getDefaultPath(s->output_mode, s->image_format, model_name);
+            OutputSink sink(s->output_queue_depth);
+            ResultWriter writer;
+            if (RETURN_FAIL == writer.open(s->output_mode, model_name, output_path, &sink))
+                return RETURN_FAIL;
+
+            int num_iter = s->loop_count > 0 ? s->loop_count : 1;
+            vector<double> latencies;
+            size_t failed = 0;
+            /* every stage of every iteration is timed on the monotonic
+            clock, the tail shows in the percentiles */
+            LatencyHistogram decodeHist, preprocHist, inferHist, postprocHist;
+            uint64_t total_start_ns = getMonotonicNs();
+            for (size_t n = 0; n < inputs.size(); n++)
+            {
+                const string &path = inputs[n];
+                cv::Mat img;
+                uint64_t start_ns = getMonotonicNs();
+                cv::Mat frame = decodeImage(path);
+                uint64_t decoded_ns = getMonotonicNs();
+                if (frame.empty() ||
+                    RETURN_FAIL == preprocFrame(modelInfo, frame, input, &img) ||
+                    RETURN_FAIL == inferer->bindInput(0, input))
+                {
+                    LOG_ERROR("skipping %s\n", path.c_str());
+                    failed++;
+                    continue;
+                }
+                decodeHist.record(decoded_ns - start_ns);
+                preprocHist.record(getMonotonicNs() - decoded_ns);
+
+                if (latencies.empty())
+                {
+                    LOG_INFO("%s run - Started for warmup runs\n", inferer->getName());
+                    uint64_t warmup_start_ns = getMonotonicNs();
+                    for (int i = 0; i < s->number_of_warmup_runs; i++)
+                    {
+                        if (RETURN_FAIL == inferer->run())
+                            return RETURN_FAIL;
+                    }
+                    record->warmupMs = (getMonotonicNs() - warmup_start_ns) / 1e6;
+                    peak_rss = std::max(peak_rss, getResidentBytes());
+                }
+
+                uint64_t infer_ns = 0;
+                for (int i = 0; i < num_iter; i++)
+                {
+                    uint64_t run_start_ns = getMonotonicNs();
+                    if (RETURN_FAIL == inferer->run())
+                        return RETURN_FAIL;
+                    uint64_t run_ns = getMonotonicNs() - run_start_ns;
+                    inferHist.record(run_ns);
+                    infer_ns += run_ns;
+                }
+
+                double avg_ms = infer_ns / (num_iter * 1e6);
+                latencies.push_back(avg_ms);
+                LOG_INFO("[%zu/%zu] %s average time:%f ms\n", n + 1, inputs.size(), path.c_str(), avg_ms);
+
+                uint64_t post_start_ns = getMonotonicNs();
+                if (RETURN_FAIL == processResult(modelInfo, s, inferer.get(), &img, &writer, path))
+                {
+                    failed++;
+                    continue;
+                }
+
+                /* the frame is converted, encoded and written by the sink
+                thread, only when the results were rendered on it */
+                if (!writer.isHeadless())
+                {
+                    sink.pushFrame(img, getFramePath(output_path, path, inputs.size() == 1), s->image_format);
+                }
+                postprocHist.record(getMonotonicNs() - post_start_ns);
+            }
+            double total_s = (getMonotonicNs() - total_start_ns) / 1e9;
+            record->inputs = latencies.size();
+            record->failed = failed;
+            peak_rss = std::max(peak_rss, getResidentBytes());
+            record->peakRssBytes = peak_reset ? std::max(peak_rss, getPeakResidentBytes()) : peak_rss;
+
+            if (latencies.empty())
+            {
+                LOG_ERROR("no input could be processed\n");
+                return RETURN_FAIL;
+            }
+            double sum_ms = 0;
+            double min_ms = latencies[0];
+            double max_ms = latencies[0];
+            for (double ms : latencies)
+            {
+                sum_ms += ms;
+                min_ms = std::min(min_ms, ms);
+                max_ms = std::max(max_ms, ms);
+            }
+            double mean_ms = sum_ms / latencies.size();
+            record->inferences = inferHist.count();
+            record->wallS = total_s;
+            record->inputsPerS = total_s > 0 ? latencies.size() / total_s : 0.0;
+            record->inferencesPerS = total_s > 0 ? inferHist.count() / total_s : 0.0;
+            record->stages.push_back(std::make_pair(string("decode"), decodeHist.summarize()));
+            record->stages.push_back(std::make_pair(string("preprocess"), preprocHist.summarize()));
+            record->stages.push_back(std::make_pair(string("inference"), inferHist.summarize()));
+            record->stages.push_back(std::make_pair(string("postprocess"), postprocHist.summarize()));
+            record->status = "ok";
+            LOG_INFO("%s: %zu images, %zu failed, average time:%f ms (min %f, max %f), wall time %f s, %f images/s\n",
+                     inferer->getName(), latencies.size(), failed, mean_ms, min_ms, max_ms, total_s,
+                     total_s > 0 ? latencies.size() / total_s : 0.0);
+            printf("\n");
+            LatencyHistogram::printHeader();
+            decodeHist.print("decode");
+            preprocHist.print("preprocess");
+            inferHist.print("inference");
+            postprocHist.print("postprocess");
+            printf("\n");
+            SharedTensorPool::Stats pool = SharedTensorPool::get().getStats();
+            LOG_INFO("tensor pool: %llu buffers taken, %llu reused, %zu bytes allocated\n",
+                     (unsigned long long)pool.acquired, (unsigned long long)pool.reused, pool.bytes);
+            return failed == 0 ? RETURN_SUCCESS : RETURN_FAIL;
+        }
+
+        int createSyntheticInput(int width, int height, string *path)
+        {
+            char name[] = "/tmp/tidl_synthetic_XXXXXX.ppm";
+            int fd = mkstemps(name, 4);
+            if (fd < 0)
+            {
+                LOG_ERROR("Could not create a synthetic input: %s\n", strerror(errno));
+                return RETURN_FAIL;
+            }
+            /* noise, so that no stage is faster than on a real frame */
+            string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+            vector<uint8_t> pixels(header.begin(), header.end());
+            unsigned int seed = 1;
+            for (int i = 0; i < width * height * 3; i++)
+                pixels.push_back(rand_r(&seed) & 0xff);
+            bool written = write(fd, pixels.data(), pixels.size()) == (ssize_t)pixels.size();
+            close(fd);
+            if (!written)
+            {
+                LOG_ERROR("Could not write the synthetic input %s\n", name);
+                unlink(name);
+                return RETURN_FAIL;
+            }
+            *path = name;
+            return RETURN_SUCCESS;
+        }
+
+        /**
+         *  \brief  runs the inputs in the mode selected by the options
+         *  \param  modelInfo YAML parsed model info
+         *  \param  s user input options
+         *  \param  inputs input images
+         * @returns int status
+         */
+        static int runInputs(ModelInfo *modelInfo, Settings *s, const vector<string> &inputs)
+        {
+            /* the session is created once and stays warm for all the inputs */
+            if (s->thread_sweep)
+                return runThreadSweep(modelInfo, s, inputs[0]);
+            if (s->num_workers > 1)
+                return runWorkers(modelInfo, s, inputs);
+            if (s->tensor_sets > 1)
+                return runPipelined(modelInfo, s, inputs);
+            if (s->pipeline_depth > 0)
+                return runStagePipeline(modelInfo, s, inputs);
+            if (!s->model_dirs.empty())
+                return runMultiModel(modelInfo, s, inputs);
+            if (s->max_batch > 0)
+                return runBatching(modelInfo, s, inputs);
+
+            BenchRecord record;
+            int status = runBenchmark(modelInfo, s, inputs, &record);
+            if (!s->report_path.empty())
+            {
+                BenchReport report;
+                report.add(record);
+                if (RETURN_FAIL == report.write(s->report_path))
+                    return RETURN_FAIL;
+            }
+            return status;
+        }
+
+        /**
+         *  \brief  option selecting a mode other than the default loop
+         *  \param  s user input options
+         * @returns the option, nullptr for the default loop
+         */
+        static const char *getModeOption(const Settings *s)
+        {
+            if (!s->serve_socket.empty())
+                return "--serve";
+            if (!s->frame_ring.empty())
+                return "--frame_ring";
+            if (s->thread_sweep)
+                return "--thread_sweep";
+            if (s->num_workers > 1)
+                return "--workers";
+            if (s->tensor_sets > 1)
+                return "--tensor_sets";
+            if (s->pipeline_depth > 0)
+                return "--pipeline_depth";
+            if (!s->model_dirs.empty())
+                return "--models";
+            if (s->max_batch > 0)
+                return "--max_batch";
+            return nullptr;
+        }
+
+        int runInference(ModelInfo *modelInfo, Settings *s)
+        {
+            /* checking model path present or not*/
+            if (modelInfo->m_infConfig.modelFile.empty() && modelInfo->m_infConfig.rtType != "tidlrt")
+            {
+                LOG_ERROR("no model file name\n");
+                return RETURN_FAIL;
+            }
+
+            /* only the default loop fills a report, fail before loading
+            anything rather than leave the file unwritten */
+            const char *mode = getModeOption(s);
+            if (!s->report_path.empty() && mode != nullptr)
+            {
+                LOG_ERROR("--report is only supported by the default loop, not with %s\n", mode);
+                return RETURN_FAIL;
+            }
+
+            /* the server and the frame ring take their inputs from another
+            process */
+            if (!s->serve_socket.empty())
+                return runServer(modelInfo, s);
+            if (!s->frame_ring.empty())
+                return runFrameRing(modelInfo, s);
+
+            if (!s->synthetic_input)
+            {
+                vector<string> inputs;
+                if (RETURN_FAIL == getInputList(s, &inputs))
+                    return RETURN_FAIL;
+                return runInputs(modelInfo, s, inputs);
+            }
+            string synthetic;
+            if (RETURN_FAIL == createSyntheticInput(SYNTHETIC_WIDTH, SYNTHETIC_HEIGHT, &synthetic))
+                return RETURN_FAIL;
+            int status = runInputs(modelInfo, s, vector<string>(1, synthetic));
+            unlink(synthetic.c_str());
+            return status;
+        }
+
+    } // namespace tidl::runner
+}
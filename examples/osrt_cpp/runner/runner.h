@@ -0,0 +1,337 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _TI_EDGEAI_RUNNER_H_
+#define _TI_EDGEAI_RUNNER_H_
+
+/* Standard headers. */
+#include <string>
+#include <vector>
+
+/* Third-party headers. */
+#include <opencv2/core/core.hpp>
+
+/* Module headers. */
+#include "../utils/include/arg_parsing.h"
+#include "../utils/include/model_info.h"
+#include "../utils/include/bench_report.h"
+#include "../utils/include/inferer.h"
+#include "../utils/include/shared_tensor_pool.h"
+#include "../post_process/result_writer.h"
+
+namespace tidl
+{
+    namespace runner
+    {
+        /**
+         *  \brief Builds the runtime options of a model from the command line
+         *         settings.
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  s user input options
+         *  \return inferer options
+         */
+        tidl::inferer::InfererOptions getInfererOptions(const tidl::modelInfo::ModelInfo *modelInfo,
+                                                         const tidl::arg_parsing::Settings *s);
+
+        /**
+         *  \brief Reads and preprocesses an image into an input tensor,
+         *         following the type of the tensor.
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  path image path
+         *  \param  input input tensor to fill
+         *  \param  img resized RGB image the results are drawn on
+         *  \return int status
+         */
+        int preprocInput(tidl::modelInfo::ModelInfo *modelInfo, const std::string &path,
+                         const tidl::inferer::TensorView &input, cv::Mat *img);
+
+        /**
+         *  \brief Preprocesses a frame decoded by
+         *         tidl::preprocess::decodeImage() into an input tensor,
+         *         following the type of the tensor. A frame that already
+         *         has the model input size is not resized.
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  frame RGB frame
+         *  \param  input input tensor to fill
+         *  \param  img resized RGB image the results are drawn on
+         *  \return int status
+         */
+        int preprocFrame(tidl::modelInfo::ModelInfo *modelInfo, const cv::Mat &frame,
+                         const tidl::inferer::TensorView &input, cv::Mat *img);
+
+        /**
+         *  \brief Post-processes the outputs of one inference according to
+         *         the task type of the model. The results are drawn on img,
+         *         or handed to writer when it is headless.
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  s user input options
+         *  \param  inferer backend that produced the outputs
+         *  \param  img resized RGB image returned by preprocInput()
+         *  \param  writer result writer
+         *  \param  input path of the input image
+         *  \return int status
+         */
+        int processResult(tidl::modelInfo::ModelInfo *modelInfo, tidl::arg_parsing::Settings *s,
+                          const tidl::inferer::Inferer *inferer, cv::Mat *img,
+                          tidl::postprocess::ResultWriter *writer, const std::string &input);
+
+        /**
+         *  \brief Post-processes outputs, like the overload above, for
+         *         outputs taken from a given tensor set.
+         */
+        int processResult(tidl::modelInfo::ModelInfo *modelInfo, tidl::arg_parsing::Settings *s,
+                          const std::vector<tidl::inferer::TensorView> &outputs, cv::Mat *img,
+                          tidl::postprocess::ResultWriter *writer, const std::string &input);
+
+        /**
+         *  \brief Creates and loads the backend of a model and sets up its
+         *         input, the backend owned buffer when it has one, memory
+         *         owned by inputBuffer otherwise.
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  s user input options
+         *  \param  options runtime options
+         *  \param  inferer filled with the loaded backend
+         *  \param  inputBuffer owns the input memory when the backend does
+         *          not
+         *  \param  input filled with the input to preprocess into and bind
+         *  \return int status
+         */
+        int loadInferer(tidl::modelInfo::ModelInfo *modelInfo, tidl::arg_parsing::Settings *s,
+                        const tidl::inferer::InfererOptions &options,
+                        std::unique_ptr<tidl::inferer::Inferer> *inferer,
+                        tidl::utils::PooledBuffer *inputBuffer, tidl::inferer::TensorView *input);
+
+        /**
+         *  \brief Runs one input over a range of thread configurations,
+         *         reloading the model for each, and prints the latency and
+         *         throughput of every configuration. The intra-op thread
+         *         count, execution mode and spinning are swept for onnxrt,
+         *         the thread count for the other runtimes. Each
+         *         configuration runs on a new thread, so that a runtime
+         *         pool started by the first run is not reused.
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  s user input options
+         *  \param  path input image
+         *  \return int status
+         */
+        int runThreadSweep(tidl::modelInfo::ModelInfo *modelInfo, tidl::arg_parsing::Settings *s,
+                           const std::string &path);
+
+        /**
+         *  \brief Runs the inputs on s->num_workers instances of the model,
+         *         each on its own thread pulling inputs from a shared
+         *         index. The threads are started and warmed up once and
+         *         serve every pass. The inputs are run with 1 up to num_workers
+         *         workers and the throughput of each pass is printed, with
+         *         the resident memory of the instances and the latency of
+         *         each worker in the last pass. Only the last pass
+         *         post-processes the results. With a cpu list, each worker
+         *         thread is pinned to its own share of it.
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  s user input options
+         *  \param  inputs input images
+         *  \return int status
+         */
+        int runWorkers(tidl::modelInfo::ModelInfo *modelInfo, tidl::arg_parsing::Settings *s,
+                       const std::vector<std::string> &inputs);
+
+        /**
+         *  \brief Runs the inputs with s->tensor_sets input and output
+         *         tensor sets: a thread preprocesses the next frame into a
+         *         free set and another post-processes the previous one while
+         *         the current set runs. The inputs are run loop_count times
+         *         single buffered, then pipelined, and the frame rate of
+         *         both is printed. Needs a backend with tensor sets, see
+         *         tidl::inferer::Inferer::setTensorSets().
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  s user input options
+         *  \param  inputs input images
+         *  \return int status
+         */
+        int runPipelined(tidl::modelInfo::ModelInfo *modelInfo, tidl::arg_parsing::Settings *s,
+                         const std::vector<std::string> &inputs);
+
+        /**
+         *  \brief Runs the inputs through three stages, preprocessing,
+         *         inference and post-processing, each on its own thread
+         *         and linked by lock-free single producer single consumer
+         *         queues. s->pipeline_depth frames are in flight, each in a
+         *         slot whose input and output buffers are taken once. The
+         *         inputs are run loop_count times, then the time, occupancy
+         *         and stalls of every stage are printed.
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  s user input options
+         *  \param  inputs input images
+         *  \return int status
+         */
+        int runStagePipeline(tidl::modelInfo::ModelInfo *modelInfo, tidl::arg_parsing::Settings *s,
+                             const std::vector<std::string> &inputs);
+
+        /**
+         *  \brief Runs the model of modelInfo and the models of
+         *         s->model_dirs on the same frames. Every frame is decoded
+         *         once and resized once per distinct input size, then the
+         *         models preprocess, run and post-process it concurrently,
+         *         each on its own thread and backend. The latency of every
+         *         model alone and next to the others is printed.
+         *
+         *  \param  modelInfo YAML parsed model info of the first model
+         *  \param  s user input options
+         *  \param  inputs input images
+         *  \return int status
+         */
+        int runMultiModel(tidl::modelInfo::ModelInfo *modelInfo, tidl::arg_parsing::Settings *s,
+                          const std::vector<std::string> &inputs);
+
+        /**
+         *  \brief Serves the inputs as a stream of single requests arriving
+         *         at s->request_rate, grouped into batches by a scheduler
+         *         that flushes when the batch is full or when the oldest
+         *         request has waited s->max_wait_ms. Batches of 1, 2, 4 ...
+         *         up to s->max_batch are run in turn and the throughput and
+         *         request latency of each are printed. Every request is
+         *         post-processed, the results of the first pass at
+         *         s->max_batch are written.
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  s user input options
+         *  \param  inputs input images
+         *  \return int status
+         */
+        int runBatching(tidl::modelInfo::ModelInfo *modelInfo, tidl::arg_parsing::Settings *s,
+                        const std::vector<std::string> &inputs);
+
+        /**
+         *  \brief Runs the frames published by another process in the
+         *         shared memory frame ring s->frame_ring until the producer
+         *         closes it. RGB frames are preprocessed and tensor frames
+         *         bound straight from their slot, without a copy between
+         *         the processes. The inference time and the latency from
+         *         publish to post-processed result are printed at the end.
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  s user input options
+         *  \return int status
+         */
+        int runFrameRing(tidl::modelInfo::ModelInfo *modelInfo, tidl::arg_parsing::Settings *s);
+
+        /**
+         *  \brief Loads the model once, runs it -c times on every input
+         *         and post-processes the results, timing decode,
+         *         preprocess, inference and post-process. This is the
+         *         default loop of runInference().
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  s user input options
+         *  \param  inputs input images
+         *  \param  record filled with the options, startup time,
+         *          throughput, stage latencies and peak memory of the run
+         *  \return int status
+         */
+        int runBenchmark(tidl::modelInfo::ModelInfo *modelInfo, tidl::arg_parsing::Settings *s,
+                         const std::vector<std::string> &inputs, tidl::utils::BenchRecord *record);
+
+        /** Size of the synthetic input of --synthetic, a camera frame. */
+        const int SYNTHETIC_WIDTH = 1280;
+        const int SYNTHETIC_HEIGHT = 720;
+
+        /**
+         *  \brief Writes an image of noise to a temporary file, used as
+         *         input when no real image is at hand. The caller removes
+         *         the file.
+         *
+         *  \param  width image width
+         *  \param  height image height
+         *  \param  path filled with the file path
+         *  \return int status
+         */
+        int createSyntheticInput(int width, int height, std::string *path);
+
+        /**
+         *  \brief Loads the model with the backend selected by
+         *         InfererConfig::rtType once, then runs it on every input
+         *         given by tidl::arg_parsing::getInputList() and
+         *         post-processes the results. Latency is reported per image
+         *         and aggregated over the run, and written to s->report_path
+         *         when set; only the default loop fills a report, the other
+         *         modes reject it. With s->synthetic_input the model runs on
+         *         a noise image instead of the given inputs.
+         *
+         *  \param  modelInfo YAML parsed model info
+         *  \param  s user input options and default values of setting if any
+         *  \return int status
+         */
+        int runInference(tidl::modelInfo::ModelInfo *modelInfo, tidl::arg_parsing::Settings *s);
+
+    } // namespace tidl::runner
+}
+
+#endif // _TI_EDGEAI_RUNNER_H_
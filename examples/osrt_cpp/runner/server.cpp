@@ -0,0 +1,452 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/* Module headers. */
+#include "runner.h"
+#include "server.h"
+#include "../pre_process/pre_process.h"
+#include "../utils/include/latency_histogram.h"
+#include "../utils/include/ti_logger.h"
+#include "../utils/include/utility_functs.h"
+
+namespace tidl
+{
+    namespace runner
+    {
+        using namespace tidl::arg_parsing;
+        using namespace tidl::modelInfo;
+        using namespace tidl::inferer;
+        using namespace tidl::postprocess;
+        using namespace tidl::preprocess;
+        using namespace tidl::utility_functs;
+        using namespace tidl::utils;
+        using std::string;
+        using std::vector;
+
+        /**
+         *  \brief  one model kept loaded by the server
+         */
+        struct ServedModel
+        {
+            ModelInfo *modelInfo{nullptr};
+            std::unique_ptr<Inferer> inferer;
+            PooledBuffer inputBuffer;
+            TensorView input;
+            ResultWriter writer;
+            /* serializes the requests to this model, and guards the
+            counters and histograms below */
+            std::mutex lock;
+            uint64_t served{0};
+            uint64_t failed{0};
+            LatencyHistogram preprocHist;
+            LatencyHistogram inferHist;
+            LatencyHistogram postprocHist;
+            /* from the start of the decode to the reply, waits for the
+            model included */
+            LatencyHistogram requestHist;
+        };
+
+        /**
+         *  \brief  one client connection and the thread serving it
+         */
+        struct Connection
+        {
+            int fd{-1};
+            std::thread thread;
+            std::atomic<bool> done{false};
+        };
+
+        static volatile sig_atomic_t s_stopServer = 0;
+
+        static void onStopSignal(int)
+        {
+            s_stopServer = 1;
+        }
+
+        /**
+         *  \brief  runs one request on a model, a failed request only fails
+         *          its own reply
+         *  \param  model model the request is for
+         *  \param  s user input options
+         *  \param  request request header, already validated
+         *  \param  payload image path or RGB frame
+         *  \param  records filled with the result record
+         *  \param  inferMs filled with the time spent in the runtime
+         * @returns int status
+         */
+        static int serveRequest(ServedModel *model, Settings *s, const ServerRequestHeader &request,
+                                vector<char> &payload, string *records, float *inferMs)
+        {
+            uint64_t request_start_ns = getMonotonicNs();
+            cv::Mat frame;
+            string input;
+            if (request.kind == SERVER_REQUEST_IMAGE_PATH)
+            {
+                input.assign(payload.data(), payload.size());
+                frame = decodeImage(input);
+                if (frame.empty())
+                    return RETURN_FAIL;
+            }
+            else
+            {
+                frame = cv::Mat(request.height, request.width, CV_8UC3, payload.data());
+                input = "frame";
+            }
+
+            std::lock_guard<std::mutex> guard(model->lock);
+
+            /* decoded images and RGB frames have 3 channels, the
+            preprocessing gives up on anything else */
+            const int32_t numChans = model->modelInfo->m_preProcCfg.numChans;
+            if (frame.channels() != numChans)
+            {
+                LOG_ERROR("%s has %d channels, the model takes %d\n", input.c_str(), frame.channels(), numChans);
+                model->failed++;
+                return RETURN_FAIL;
+            }
+
+            cv::Mat img;
+            uint64_t start_ns = getMonotonicNs();
+            if (RETURN_FAIL == preprocFrame(model->modelInfo, frame, model->input, &img) ||
+                RETURN_FAIL == model->inferer->bindInput(0, model->input))
+            {
+                model->failed++;
+                return RETURN_FAIL;
+            }
+            uint64_t infer_start_ns = getMonotonicNs();
+            if (RETURN_FAIL == model->inferer->run())
+            {
+                model->failed++;
+                return RETURN_FAIL;
+            }
+            uint64_t post_start_ns = getMonotonicNs();
+            if (RETURN_FAIL == processResult(model->modelInfo, s, model->inferer.get(), &img, &model->writer, input))
+            {
+                model->failed++;
+                return RETURN_FAIL;
+            }
+            model->writer.takeRecords(records);
+            uint64_t stop_ns = getMonotonicNs();
+            model->preprocHist.record(infer_start_ns - start_ns);
+            model->inferHist.record(post_start_ns - infer_start_ns);
+            model->postprocHist.record(stop_ns - post_start_ns);
+            model->requestHist.record(stop_ns - request_start_ns);
+            *inferMs = (post_start_ns - infer_start_ns) / 1e6;
+            model->served++;
+            return RETURN_SUCCESS;
+        }
+
+        /**
+         *  \brief  serves the requests of a connection until the client
+         *          closes it or sends a malformed request
+         *  \param  fd connected socket
+         *  \param  models models served
+         *  \param  s user input options
+         */
+        static void serveConnection(int fd, vector<std::unique_ptr<ServedModel>> *models, Settings *s)
+        {
+            vector<char> payload;
+            string records;
+            ServerRequestHeader request;
+            while (recvAll(fd, &request, sizeof(request)))
+            {
+                if (request.magic != TI_SERVER_REQUEST_MAGIC || request.version != TI_SERVER_PROTOCOL_VERSION ||
+                    request.length > TI_SERVER_MAX_PAYLOAD)
+                {
+                    LOG_ERROR("malformed request, closing the connection\n");
+                    break;
+                }
+                payload.resize(request.length);
+                if (!recvAll(fd, payload.data(), payload.size()))
+                    break;
+
+                ServerReplyHeader reply;
+                reply.magic = TI_SERVER_REPLY_MAGIC;
+                reply.status = RETURN_FAIL;
+                reply.inferMs = 0;
+                records.clear();
+                if (request.modelId >= models->size())
+                {
+                    LOG_ERROR("no model %u\n", request.modelId);
+                }
+                else if (request.kind == SERVER_REQUEST_RGB_FRAME &&
+                         (request.width == 0 || request.height == 0 || request.width > TI_SERVER_MAX_FRAME_DIM ||
+                          request.height > TI_SERVER_MAX_FRAME_DIM))
+                {
+                    LOG_ERROR("frame of %ux%u is not supported\n", request.width, request.height);
+                }
+                else if (request.kind == SERVER_REQUEST_RGB_FRAME &&
+                         (uint64_t)request.width * request.height * 3 != request.length)
+                {
+                    LOG_ERROR("frame of %ux%u does not match %u bytes\n", request.width, request.height,
+                              request.length);
+                }
+                else if (request.kind != SERVER_REQUEST_IMAGE_PATH && request.kind != SERVER_REQUEST_RGB_FRAME)
+                {
+                    LOG_ERROR("unknown request kind %u\n", request.kind);
+                }
+                else
+                {
+                    /* OpenCV throws on frames it can not handle */
+                    try
+                    {
+                        reply.status = serveRequest((*models)[request.modelId].get(), s, request, payload, &records,
+                                                    &reply.inferMs);
+                    }
+                    catch (const cv::Exception &e)
+                    {
+                        LOG_ERROR("request failed: %s\n", e.what());
+                        reply.status = RETURN_FAIL;
+                    }
+                    catch (const std::exception &e)
+                    {
+                        LOG_ERROR("request failed: %s\n", e.what());
+                        reply.status = RETURN_FAIL;
+                    }
+                }
+                if (reply.status == RETURN_FAIL)
+                    records.clear();
+                reply.length = records.size();
+                if (!sendAll(fd, &reply, sizeof(reply)) || !sendAll(fd, records.data(), records.size()))
+                    break;
+            }
+        }
+
+        int runServer(ModelInfo *modelInfo, Settings *s)
+        {
+            struct sockaddr_un addr;
+            memset(&addr, 0, sizeof(addr));
+            if (s->serve_socket.size() >= sizeof(addr.sun_path))
+            {
+                LOG_ERROR("socket path %s is too long\n", s->serve_socket.c_str());
+                return RETURN_FAIL;
+            }
+            addr.sun_family = AF_UNIX;
+            strncpy(addr.sun_path, s->serve_socket.c_str(), sizeof(addr.sun_path) - 1);
+
+            /* the records go back in the reply, binary unless JSON is asked */
+            OutputMode mode = s->output_mode == OUTPUT_MODE_JSON ? OUTPUT_MODE_JSON : OUTPUT_MODE_BINARY;
+            vector<std::unique_ptr<ModelInfo>> extraInfos;
+            vector<std::unique_ptr<ServedModel>> models;
+            models.emplace_back(new ServedModel);
+            models[0]->modelInfo = modelInfo;
+            for (const string &dir : s->model_dirs)
+            {
+                std::unique_ptr<ModelInfo> info(new ModelInfo(dir));
+                info->m_labelsPath = s->labels_file_path;
+                if (info->initialize() == RETURN_FAIL)
+                {
+                    LOG_ERROR("Failed to initialize model %s\n", dir.c_str());
+                    return RETURN_FAIL;
+                }
+                models.emplace_back(new ServedModel);
+                models.back()->modelInfo = info.get();
+                extraInfos.push_back(std::move(info));
+            }
+
+            /* the sessions are created and warmed up once, before the first
+            request */
+            for (size_t id = 0; id < models.size(); id++)
+            {
+                ServedModel *model = models[id].get();
+                ModelInfo *info = model->modelInfo;
+                if (RETURN_FAIL == loadInferer(info, s, getInfererOptions(info, s), &model->inferer,
+                                               &model->inputBuffer, &model->input) ||
+                    RETURN_FAIL == model->writer.openBuffer(mode, info->m_preProcCfg.modelName))
+                    return RETURN_FAIL;
+                memset(model->input.data, 0, model->input.getSizeBytes());
+                if (RETURN_FAIL == model->inferer->bindInput(0, model->input))
+                    return RETURN_FAIL;
+                for (int i = 0; i < s->number_of_warmup_runs; i++)
+                {
+                    if (RETURN_FAIL == model->inferer->run())
+                        return RETURN_FAIL;
+                }
+                LOG_INFO("model %zu: %s on %s\n", id, info->m_preProcCfg.modelName.c_str(), model->inferer->getName());
+            }
+
+            int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (listenFd < 0)
+            {
+                LOG_ERROR("Could not create socket: %s\n", strerror(errno));
+                return RETURN_FAIL;
+            }
+            /* a socket left behind by a server that did not stop cleanly */
+            struct stat st;
+            if (lstat(addr.sun_path, &st) == 0 && S_ISSOCK(st.st_mode))
+                unlink(addr.sun_path);
+            if (bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listenFd, SOMAXCONN) < 0)
+            {
+                LOG_ERROR("Could not listen on %s: %s\n", addr.sun_path, strerror(errno));
+                close(listenFd);
+                return RETURN_FAIL;
+            }
+
+            struct sigaction stop, oldInt, oldTerm;
+            memset(&stop, 0, sizeof(stop));
+            stop.sa_handler = onStopSignal;
+            sigemptyset(&stop.sa_mask);
+            sigaction(SIGINT, &stop, &oldInt);
+            sigaction(SIGTERM, &stop, &oldTerm);
+            s_stopServer = 0;
+            LOG_INFO("serving %zu models on %s\n", models.size(), addr.sun_path);
+
+            vector<std::unique_ptr<Connection>> connections;
+            while (!s_stopServer)
+            {
+                struct pollfd pfd;
+                pfd.fd = listenFd;
+                pfd.events = POLLIN;
+                pfd.revents = 0;
+                int ready = poll(&pfd, 1, 200);
+
+                /* reap the connections the clients closed */
+                for (size_t i = 0; i < connections.size();)
+                {
+                    if (connections[i]->done)
+                    {
+                        connections[i]->thread.join();
+                        close(connections[i]->fd);
+                        connections.erase(connections.begin() + i);
+                    }
+                    else
+                    {
+                        i++;
+                    }
+                }
+                if (ready <= 0)
+                    continue;
+
+                int fd = accept(listenFd, nullptr, nullptr);
+                if (fd < 0)
+                    continue;
+                std::unique_ptr<Connection> connection(new Connection);
+                Connection *c = connection.get();
+                c->fd = fd;
+                c->thread = std::thread([c, &models, s] {
+                    /* an exception escaping the thread would terminate the
+                    server, drop the connection instead */
+                    try
+                    {
+                        serveConnection(c->fd, &models, s);
+                    }
+                    catch (const std::exception &e)
+                    {
+                        LOG_ERROR("closing the connection: %s\n", e.what());
+                    }
+                    c->done = true;
+                });
+                connections.push_back(std::move(connection));
+            }
+
+            LOG_INFO("stopping, %zu connections open\n", connections.size());
+            for (std::unique_ptr<Connection> &c : connections)
+            {
+                shutdown(c->fd, SHUT_RDWR);
+                c->thread.join();
+                close(c->fd);
+            }
+            close(listenFd);
+            unlink(addr.sun_path);
+            sigaction(SIGINT, &oldInt, nullptr);
+            sigaction(SIGTERM, &oldTerm, nullptr);
+
+            for (size_t id = 0; id < models.size(); id++)
+            {
+                const ServedModel *model = models[id].get();
+                LOG_INFO("model %zu %s: %llu requests, %llu failed, average inference %f ms\n", id,
+                         model->modelInfo->m_preProcCfg.modelName.c_str(), (unsigned long long)model->served,
+                         (unsigned long long)model->failed, model->inferHist.summarize().meanMs);
+            }
+
+            /* the connections are closed, nothing records any more */
+            printf("\n");
+            LatencyHistogram::printHeader("model stage (ms)", 24);
+            for (size_t id = 0; id < models.size(); id++)
+            {
+                const ServedModel *model = models[id].get();
+                const string prefix = "model " + std::to_string(id) + " ";
+                model->preprocHist.print((prefix + "preprocess").c_str(), 24);
+                model->inferHist.print((prefix + "inference").c_str(), 24);
+                model->postprocHist.print((prefix + "postprocess").c_str(), 24);
+                model->requestHist.print((prefix + "request").c_str(), 24);
+            }
+            return RETURN_SUCCESS;
+        }
+
+    } // namespace tidl::runner
+}
@@ -0,0 +1,184 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _TI_EDGEAI_SERVER_PROTOCOL_H_
+#define _TI_EDGEAI_SERVER_PROTOCOL_H_
+
+/* Standard headers. */
+#include <errno.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+/** Magic at the start of every request, "TIRQ". */
+#define TI_SERVER_REQUEST_MAGIC     (0x51524954)
+/** Magic at the start of every reply, "TIRP". */
+#define TI_SERVER_REPLY_MAGIC       (0x50524954)
+#define TI_SERVER_PROTOCOL_VERSION  (1)
+/** Largest request payload accepted, a 4K RGB frame fits. */
+#define TI_SERVER_MAX_PAYLOAD       (64 * 1024 * 1024)
+/** Largest width or height of a SERVER_REQUEST_RGB_FRAME. */
+#define TI_SERVER_MAX_FRAME_DIM     (8192)
+/** Socket used by the client when none is given. */
+#define TI_SERVER_DEFAULT_SOCKET    "/tmp/edgeai_tidl_infer.sock"
+
+namespace tidl
+{
+    namespace runner
+    {
+        /** Kind of input carried by a request. */
+        enum ServerRequestKind
+        {
+            /** Path of an image on the server file system, decoded there. */
+            SERVER_REQUEST_IMAGE_PATH = 0,
+            /** Decoded frame, width * height * 3 bytes of packed RGB. */
+            SERVER_REQUEST_RGB_FRAME
+        };
+
+        /**
+         * \brief Header of a request sent to the inference server. It is
+         *        followed by length bytes of payload, the image path (not
+         *        NUL terminated) or the RGB frame. Requests on a connection
+         *        are served in order, one reply each.
+         *
+         *        All fields are little endian, client and server run on the
+         *        same host.
+         */
+        struct ServerRequestHeader
+        {
+            uint32_t magic;
+            uint16_t version;
+            uint16_t kind;
+            /** Index of the model, 0 for -z then the --models in order. */
+            uint32_t modelId;
+            /** Frame size, 0 for SERVER_REQUEST_IMAGE_PATH, 1 to
+             * TI_SERVER_MAX_FRAME_DIM for SERVER_REQUEST_RGB_FRAME. */
+            uint32_t width;
+            uint32_t height;
+            uint32_t length;
+        };
+
+        /**
+         * \brief Header of a reply. It is followed by length bytes holding
+         *        one result record as written by
+         *        tidl::postprocess::ResultWriter, binary or JSON depending
+         *        on the -o option of the server, nothing when status is
+         *        RETURN_FAIL.
+         */
+        struct ServerReplyHeader
+        {
+            uint32_t magic;
+            int32_t status;
+            /** Time spent in the runtime for this request, the run
+             * alone without preprocessing nor post-processing. */
+            float inferMs;
+            uint32_t length;
+        };
+
+        /**
+         * \brief Sends size bytes on a connected socket.
+         *
+         * @returns true when everything was sent
+         */
+        inline bool sendAll(int fd, const void *data, size_t size)
+        {
+            const char *ptr = static_cast<const char *>(data);
+            while (size > 0)
+            {
+                ssize_t sent = send(fd, ptr, size, MSG_NOSIGNAL);
+                if (sent < 0 && errno == EINTR)
+                    continue;
+                if (sent <= 0)
+                    return false;
+                ptr += sent;
+                size -= sent;
+            }
+            return true;
+        }
+
+        /**
+         * \brief Receives exactly size bytes from a connected socket.
+         *
+         * @returns true when everything was received, false on error or
+         *          when the peer closed the connection
+         */
+        inline bool recvAll(int fd, void *data, size_t size)
+        {
+            char *ptr = static_cast<char *>(data);
+            while (size > 0)
+            {
+                ssize_t received = recv(fd, ptr, size, 0);
+                if (received < 0 && errno == EINTR)
+                    continue;
+                if (received <= 0)
+                    return false;
+                ptr += received;
+                size -= received;
+            }
+            return true;
+        }
+
+    } // namespace tidl::runner
+}
+
+#endif // _TI_EDGEAI_SERVER_PROTOCOL_H_
@@ -0,0 +1,281 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _TI_EDGEAI_SPSC_QUEUE_H_
+#define _TI_EDGEAI_SPSC_QUEUE_H_
+
+/* Standard headers. */
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace tidl
+{
+    namespace runner
+    {
+        /**
+         * \brief Bounded lock-free queue between one producer thread and one
+         *        consumer thread. push() and pop() never block, they return
+         *        false when the queue is full or empty. pushWait() and
+         *        popWait() spin briefly and then sleep on a condition
+         *        variable until the other side makes progress, the lock is
+         *        only taken when a side is asleep.
+         */
+        template <class T>
+        class SpscQueue
+        {
+        public:
+            /**
+             * Constructor.
+             *
+             * @param capacity maximum number of queued items, rounded up to
+             *        a power of two
+             */
+            explicit SpscQueue(size_t capacity) : m_head(0), m_tail(0),
+                                                  m_closed(false),
+                                                  m_producerWaiting(false),
+                                                  m_consumerWaiting(false)
+            {
+                size_t size = 1;
+                while (size < capacity)
+                    size *= 2;
+                m_items.resize(size);
+                m_mask = size - 1;
+            }
+
+            SpscQueue(const SpscQueue &) = delete;
+            SpscQueue &operator=(const SpscQueue &) = delete;
+
+            /** Producer side, returns false when the queue is full. */
+            bool push(const T &item)
+            {
+                if (!tryPush(item))
+                    return false;
+                wake(m_consumerWaiting);
+                return true;
+            }
+
+            /** Consumer side, returns false when the queue is empty. */
+            bool pop(T *item)
+            {
+                if (!tryPop(item))
+                    return false;
+                wake(m_producerWaiting);
+                return true;
+            }
+
+            /** Producer side, blocks while the queue is full. */
+            void pushWait(const T &item)
+            {
+                for (int32_t i = 0; i < SPIN_COUNT; i++)
+                {
+                    if (push(item))
+                        return;
+                }
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    sleepUntil(lock, m_producerWaiting, [&] { return tryPush(item); },
+                               std::chrono::steady_clock::time_point::max());
+                }
+                wake(m_consumerWaiting);
+            }
+
+            /**
+             * Consumer side, blocks while the queue is empty.
+             *
+             * @param item filled with the popped item
+             * @param timeoutUs longest wait in microseconds, negative to
+             *        wait until an item comes or the queue is closed
+             * @returns false on timeout or when the queue is closed and
+             *          empty
+             */
+            bool popWait(T *item, int64_t timeoutUs = -1)
+            {
+                for (int32_t i = 0; i < SPIN_COUNT; i++)
+                {
+                    if (pop(item))
+                        return true;
+                }
+                std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+                if (timeoutUs >= 0)
+                    deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutUs);
+                bool popped = false;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    sleepUntil(lock, m_consumerWaiting, [&] {
+                        popped = tryPop(item);
+                        return popped || m_closed.load(std::memory_order_acquire);
+                    }, deadline);
+                }
+                if (popped)
+                    wake(m_producerWaiting);
+                return popped;
+            }
+
+            /** Producer side, no more items will be pushed. Wakes the
+             * consumer, whose popWait() returns false once the queue is
+             * empty. */
+            void close()
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                /* release: a consumer that sees closed without the lock
+                also sees every item pushed before */
+                m_closed.store(true, std::memory_order_release);
+                m_cond.notify_all();
+            }
+
+            /** Returns true once close() was called. */
+            bool isClosed() const { return m_closed.load(std::memory_order_acquire); }
+
+            /** Number of queued items, approximate while both sides run. */
+            size_t size() const
+            {
+                return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+            }
+
+            /** Maximum number of queued items. */
+            size_t capacity() const { return m_mask + 1; }
+
+        private:
+            /* attempts before a waiting side goes to sleep, the other side
+            usually makes progress within a few microseconds */
+            static const int32_t SPIN_COUNT = 128;
+
+            bool tryPush(const T &item)
+            {
+                size_t tail = m_tail.load(std::memory_order_relaxed);
+                if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+                    return false;
+                m_items[tail & m_mask] = item;
+                m_tail.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            bool tryPop(T *item)
+            {
+                size_t head = m_head.load(std::memory_order_relaxed);
+                if (head == m_tail.load(std::memory_order_acquire))
+                    return false;
+                *item = m_items[head & m_mask];
+                m_head.store(head + 1, std::memory_order_release);
+                return true;
+            }
+
+            /* Called after moving head or tail. The fence pairs with the one
+            in sleepUntil(): either the sleeper sees the move or this side
+            sees its flag, so no wakeup is lost. */
+            void wake(std::atomic<bool> &waiting)
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (waiting.load(std::memory_order_relaxed))
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_cond.notify_all();
+                }
+            }
+
+            /* Sleeps with m_mutex held by lock until done() or the
+            deadline, returns done(). */
+            template <class Done>
+            bool sleepUntil(std::unique_lock<std::mutex> &lock, std::atomic<bool> &waiting, Done done,
+                            std::chrono::steady_clock::time_point deadline)
+            {
+                waiting.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                bool result;
+                while (!(result = done()))
+                {
+                    if (deadline == std::chrono::steady_clock::time_point::max())
+                        m_cond.wait(lock);
+                    else if (m_cond.wait_until(lock, deadline) == std::cv_status::timeout)
+                    {
+                        result = done();
+                        break;
+                    }
+                }
+                waiting.store(false, std::memory_order_relaxed);
+                return result;
+            }
+
+            std::vector<T> m_items;
+            size_t m_mask;
+
+            /* on separate cache lines so that both sides do not share one */
+            alignas(64) std::atomic<size_t> m_head;
+            alignas(64) std::atomic<size_t> m_tail;
+
+            /* only used once a side sleeps */
+            alignas(64) std::mutex m_mutex;
+            std::condition_variable m_cond;
+            std::atomic<bool> m_closed;
+            std::atomic<bool> m_producerWaiting;
+            std::atomic<bool> m_consumerWaiting;
+        };
+
+    } // namespace tidl::runner
+}
+
+#endif // _TI_EDGEAI_SPSC_QUEUE_H_
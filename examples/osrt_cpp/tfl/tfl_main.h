@@ -63,48 +63,13 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TENSORFLOW_LITE_EXAMPLES_MAIN_H_
 #define TENSORFLOW_LITE_EXAMPLES_MAIN_H_
 
-#include <fcntl.h>
-#include <sys/time.h>
-#include <sys/types.h>
-#include <cstdarg>
-#include <cstdio>
-#include <cstdlib>
-#include <fstream>
-#include <iomanip>
-#include <iostream>
-#include <map>
-#include <memory>
-#include <sstream>
-#include <string>
-#include <unordered_set>
-#include <vector>
-#include <yaml-cpp/yaml.h>
-
-#include <tensorflow/lite/kernels/register.h>
-#include <tensorflow/lite/optional_debug_tools.h>
-#include <tensorflow/lite/profiling/profiler.h>
-#include <tensorflow/lite/string_util.h>
-#include <dlfcn.h>
-#include <opencv2/core/core.hpp>
-#include <opencv2/highgui/highgui.hpp>
-#include <opencv2/imgproc/imgproc.hpp>
-#include <opencv2/imgcodecs.hpp>
-#include <opencv2/imgproc/imgproc_c.h>
-#include <tensorflow/lite/tools/evaluation/utils.h>
-
-#include "itidl_rt.h"
-#include "post_process/post_process.h"
-#include "pre_process/pre_process.h"
+#include "runner/runner.h"
 #include "utils/include/arg_parsing.h"
-#include "utils/include/utility_functs.h"
 #include "utils/include/ti_logger.h"
 #include "utils/include/model_info.h"
 
 using namespace tidl::arg_parsing;
 using namespace tidl::modelInfo;
-using namespace tidl::utility_functs;
 using namespace tidl::utils;
-using namespace tidl::postprocess;
-using namespace tidl::preprocess;
 
 #endif // TENSORFLOW_LITE_EXAMPLES_MAIN_H_
\ No newline at end of file
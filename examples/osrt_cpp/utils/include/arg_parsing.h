@@ -65,6 +65,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <iostream>
 #include <vector>
+#include <cstring>
 #include <getopt.h>
 
 #include "ti_logger.h"
@@ -74,6 +75,36 @@ namespace tidl
     namespace arg_parsing
     {
         /**
+         * \brief What the runners produce once inference is done. Only
+         *        OUTPUT_MODE_IMAGE renders overlays and encodes a JPEG, the
+         *        other modes skip colour conversion and encoding entirely.
+         */
+        enum OutputMode
+        {
+            /** Overlay the results on the input and save it as JPEG. */
+            OUTPUT_MODE_IMAGE = 0,
+            /** Discard the results, useful for benchmarking. */
+            OUTPUT_MODE_NONE,
+            /** One JSON object per line for each processed input. */
+            OUTPUT_MODE_JSON,
+            /** Packed binary records, see result_writer.h. */
+            OUTPUT_MODE_BINARY
+        };
+
+        /**
+         * \brief Encoding of the image saved in OUTPUT_MODE_IMAGE.
+         */
+        enum ImageFormat
+        {
+            /** JPEG through OpenCV, the default. */
+            IMAGE_FORMAT_JPEG = 0,
+            /** PNG with the lowest compression level. */
+            IMAGE_FORMAT_PNG,
+            /** Raw binary PPM, written without any encoding. */
+            IMAGE_FORMAT_PPM
+        };
+
+        /**
  @struct  Settings
  @brief   This structure define the parameters of tfl cpp infernce params
 */
@@ -95,6 +126,32 @@ namespace tidl
             int number_of_results = 5;
             int number_of_warmup_runs = 2;
             std::string task_type = "";
+            OutputMode output_mode = OUTPUT_MODE_IMAGE;
+            ImageFormat image_format = IMAGE_FORMAT_JPEG;
+            int output_queue_depth = 4;
+            std::string input_list_path = "";
+            std::string input_dir_path = "";
+            bool io_binding = false;
+            std::string ort_cache_dir = "";
+            int intra_op_threads = -1;
+            int inter_op_threads = -1;
+            std::string execution_mode = "";
+            int allow_spinning = -1;
+            std::vector<int32_t> cpu_affinity;
+            bool thread_sweep = false;
+            bool xnnpack = false;
+            int num_workers = 1;
+            int tensor_sets = 1;
+            int pipeline_depth = 0;
+            std::vector<std::string> model_dirs;
+            int max_batch = 0;
+            double max_wait_ms = 5;
+            double request_rate = 0;
+            std::string serve_socket = "";
+            std::string frame_ring = "";
+            std::string report_path = "";
+            int parallel_models = 1;
+            bool synthetic_input = false;
         };
         /**
          * Use getopts lib to do options parsing and fill the contents to Setting struct.
@@ -119,6 +176,60 @@ namespace tidl
          */
         void dumpArgs(Settings *s);
 
+        /**
+         * Converts an output mode name as given on the command line to the
+         * corresponding OutputMode.
+         *
+         * @param name one of none, json, binary or image
+         * @param mode pointer to the mode to be filled
+         *
+         * @returns RETURN_SUCCESS, RETURN_FAIL for an unknown name
+         */
+        int parseOutputMode(const char *name, OutputMode *mode);
+
+        /**
+         * Returns the command line name of an output mode.
+         *
+         * @param mode output mode
+         *
+         * @returns name of the mode
+         */
+        const char *getOutputModeName(OutputMode mode);
+
+        /**
+         * Converts an image format name as given on the command line to the
+         * corresponding ImageFormat.
+         *
+         * @param name one of jpg, png or ppm
+         * @param format pointer to the format to be filled
+         *
+         * @returns RETURN_SUCCESS, RETURN_FAIL for an unknown name
+         */
+        int parseImageFormat(const char *name, ImageFormat *format);
+
+        /**
+         * Returns the command line name of an image format, which is also
+         * the file extension used for it.
+         *
+         * @param format image format
+         *
+         * @returns name of the format
+         */
+        const char *getImageFormatName(ImageFormat format);
+
+        /**
+         * Collects the images to run on, in this order: the --image path,
+         * expanded when it is a glob pattern, the lines of --input_list and
+         * the images found in --input_dir, sorted by name.
+         *
+         * @param s parsed settings
+         * @param inputs pointer to the list to be filled
+         *
+         * @returns RETURN_SUCCESS, RETURN_FAIL if a list or directory can not
+         * be read or no input is found
+         */
+        int getInputList(const Settings *s, std::vector<std::string> *inputs);
+
     } // arg_parsing
 } // tidl
 
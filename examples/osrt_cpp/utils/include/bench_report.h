@@ -0,0 +1,176 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _TI_EDGEAI_BENCH_REPORT_H_
+#define _TI_EDGEAI_BENCH_REPORT_H_
+
+/* Standard headers. */
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* Module headers. */
+#include "latency_histogram.h"
+
+/** Version of the report schema, bumped when a field changes meaning or
+ * is removed. New fields may be added without a bump. */
+#define TI_BENCH_REPORT_VERSION     (1)
+
+namespace tidl
+{
+    namespace utils
+    {
+        /**
+         * \brief Result of benchmarking one model.
+         */
+        struct BenchRecord
+        {
+            /** Model name from param.yaml. */
+            std::string model;
+            /** Model directory given with -z. */
+            std::string modelPath;
+            std::string taskType;
+            /** session_name from param.yaml. */
+            std::string runtime;
+            /** Backend that ran the model, Inferer::getName(). */
+            std::string backend;
+            /** ok, or failed when the model could not be loaded or no
+             * input could be run. */
+            std::string status{"failed"};
+
+            /* options */
+            bool accel{false};
+            bool deviceMem{false};
+            int32_t threads{-1};
+            int32_t intraOpThreads{-1};
+            int32_t interOpThreads{-1};
+            std::string executionMode;
+            std::string cpuAffinity;
+            int32_t warmupRuns{0};
+            int32_t loopCount{0};
+
+            /* startup phases */
+            double loadMs{0};
+            double warmupMs{0};
+
+            /* throughput */
+            uint64_t inputs{0};
+            uint64_t failed{0};
+            uint64_t inferences{0};
+            double wallS{0};
+            double inputsPerS{0};
+            double inferencesPerS{0};
+
+            /** Peak resident memory of the process while the model was
+             * loaded and run, the peak is reset when the model starts. */
+            uint64_t peakRssBytes{0};
+
+            /** Latency of the stages, by stage name. */
+            std::vector<std::pair<std::string, LatencySummary>> stages;
+        };
+
+        /**
+         * \brief Collects BenchRecords and writes them as a JSON document or
+         *        as CSV, for dashboards and scripts to ingest without
+         *        parsing the console output.
+         *
+         * JSON: {"schema": "tidl_bench_report", "version": 1,
+         * "results": [...]}, one object per record with its fields in
+         * snake_case, the options, startup and throughput grouped, and
+         * "stages" mapping each stage to its count, min_ms, p50_ms, p90_ms,
+         * p99_ms, p999_ms, max_ms, mean_ms and stddev_ms.
+         *
+         * CSV: a header row then one row per record. The columns are fixed,
+         * the stage columns cover decode, preprocess, inference and
+         * postprocess and are left empty for stages a record does not
+         * have.
+         */
+        class BenchReport
+        {
+        public:
+            /** Adds the record of a model. */
+            void add(const BenchRecord &record) { m_records.push_back(record); }
+
+            /** Returns the records added so far. */
+            const std::vector<BenchRecord> &records() const { return m_records; }
+
+            /**
+             * Writes all the records, as CSV when path ends with .csv, as
+             * JSON otherwise.
+             *
+             * @param path report file, replaced if it exists
+             * @returns RETURN_SUCCESS or RETURN_FAIL
+             */
+            int32_t write(const std::string &path) const;
+
+        private:
+            std::string toJson() const;
+            std::string toCsv() const;
+
+            std::vector<BenchRecord> m_records;
+        };
+
+    } // namespace utils
+} // namespace tidl
+
+#endif // _TI_EDGEAI_BENCH_REPORT_H_
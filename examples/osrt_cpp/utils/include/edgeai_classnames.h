@@ -64,14 +64,61 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define _TI_EDGEAI_CLASSNAMES_H_
 
 /* Standard headers. */
-#include <string>
-#include <map>
+#include <stdint.h>
 
 namespace ti
 {
     namespace common
     {
-        extern std::map<std::string, std::string *> gClassNameMap;
+        /**
+         * \brief Datasets with a built-in class name table.
+         */
+        enum ClassNameSet
+        {
+            /** ImageNet 1000 classes. */
+            CLASSNAMES_IMAGENET = 0,
+
+            /** Pascal VOC 20 classes plus background. */
+            CLASSNAMES_PASCAL_VOC,
+
+            /** COCO 91 category ids plus background. */
+            CLASSNAMES_COCO,
+
+            /** Number of tables, also returned for unknown datasets. */
+            CLASSNAMES_MAX
+        };
+
+        /**
+         * \brief Read only class name table of one dataset.
+         */
+        struct ClassNameTable
+        {
+            /** Dataset name as used in param.yaml. */
+            const char *dataset;
+
+            /** Class names indexed by class id. */
+            const char *const *names;
+
+            /** Number of entries in names. */
+            int32_t count;
+        };
+
+        /**
+         * Returns the class name table of a dataset. An empty table is
+         * returned for CLASSNAMES_MAX.
+         *
+         * @param set dataset
+         */
+        const ClassNameTable &getClassNames(ClassNameSet set);
+
+        /**
+         * Returns the dataset for a name such as "coco", CLASSNAMES_MAX if
+         * there is no table for it.
+         *
+         * @param name dataset name
+         */
+        ClassNameSet getClassNameSet(const char *name);
+
     } // common
 } // ti
 
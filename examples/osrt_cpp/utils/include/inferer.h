@@ -0,0 +1,334 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _TI_EDGEAI_INFERER_H_
+#define _TI_EDGEAI_INFERER_H_
+
+/* Standard headers. */
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+/* Module headers. */
+#include "model_info.h"
+#include "utility_functs.h"
+
+namespace tidl
+{
+    namespace inferer
+    {
+        using tidl::modelInfo::DlInferType;
+        using tidl::modelInfo::InfererConfig;
+
+        /**
+         * \brief Returns the size in bytes of one element of the given type,
+         *        0 for DlInferType_Invalid.
+         */
+        size_t getTypeSize(DlInferType type);
+
+        /**
+         * \brief Returns a printable name for the given type.
+         */
+        const char *getTypeName(DlInferType type);
+
+        /**
+         * \brief Name, type and shape of a model input or output as reported
+         *        by the runtime. Dimensions the runtime does not know until
+         *        inference, like a dynamic batch, are reported as -1.
+         */
+        struct TensorInfo
+        {
+            std::string name;
+            DlInferType type{tidl::modelInfo::DlInferType_Invalid};
+            std::vector<int64_t> shape;
+
+            /** Number of elements, unknown dimensions are counted as 1. */
+            int64_t getNumElements() const;
+
+            /** Size in bytes, unknown dimensions are counted as 1. */
+            size_t getSizeBytes() const { return getNumElements() * getTypeSize(type); }
+        };
+
+        /**
+         * \brief Non owning view of tensor data. Views returned by an Inferer
+         *        stay valid until the next call to run() on it.
+         */
+        struct TensorView
+        {
+            void *data{nullptr};
+            DlInferType type{tidl::modelInfo::DlInferType_Invalid};
+            std::vector<int64_t> shape;
+
+            /** Number of elements. */
+            int64_t getNumElements() const;
+
+            /** Size in bytes. */
+            size_t getSizeBytes() const { return getNumElements() * getTypeSize(type); }
+
+            /** Returns element i converted to float. */
+            float getFloat(int64_t i) const;
+
+            /** Returns the data as T, no conversion is done. */
+            template <class T>
+            T *as() const { return static_cast<T *>(data); }
+        };
+
+        /**
+         * \brief Runtime options that are not part of param.yaml, typically
+         *        taken from the command line.
+         */
+        struct InfererOptions
+        {
+            /** Offload to C7x/MMA through the TIDL delegate or provider. */
+            bool accel{false};
+
+            /** Place the backend owned tensors in memory shared with the
+             * accelerator. */
+            bool deviceMem{false};
+
+            /** Threads used by the runtime on the ARM, -1 for its default. */
+            int32_t numThreads{-1};
+
+            /** Artifacts directory, overrides InfererConfig::artifactsPath
+             * when not empty. */
+            std::string artifactsPath{};
+
+            /** DLR device type, cpu or gpu. */
+            std::string devType{"cpu"};
+
+            /** ONNX Runtime only, intra-op threads. When -1 the session
+             * intra_op_num_threads of param.yaml is used, then numThreads. */
+            int32_t intraOpThreads{-1};
+
+            /** ONNX Runtime only, inter-op threads, -1 for param.yaml or the
+             * runtime default. */
+            int32_t interOpThreads{-1};
+
+            /** ONNX Runtime only, sequential or parallel, empty for
+             * param.yaml or sequential. */
+            std::string executionMode{};
+
+            /** ONNX Runtime only, 0 or 1 to let idle workers spin, -1 for
+             * param.yaml or the runtime default. */
+            int32_t allowSpinning{-1};
+
+            /** CPUs the loading thread is pinned to before the runtime
+             * creates its workers, which inherit the affinity. Empty to
+             * leave the threads unpinned. */
+            std::vector<int32_t> cpuAffinity;
+
+            /** TFLite only, run the nodes not offloaded to TIDL with the
+             * XNNPACK delegate. */
+            bool xnnpack{false};
+
+            /** ONNX Runtime only, bind inputs and preallocated outputs once
+             * through an IoBinding instead of passing them to every run. */
+            bool ioBinding{false};
+
+            /** ONNX Runtime only, directory caching the optimized models,
+             * empty to optimize the graph on every load. */
+            std::string modelCacheDir{};
+
+            /** Log level, DEBUG dumps the runtime state after load. */
+            int32_t logLevel{tidl::utils::ERROR};
+        };
+
+        /**
+         * \brief Common interface over the inference runtimes.
+         *
+         * A backend is created with createInferer() and used as follows:
+         * - load() the model described by an InfererConfig
+         * - describeIO() to find the inputs and outputs
+         * - getInput() for a backend owned input buffer, or allocate one
+         * - fill the input and bindInput() it
+         * - run() as many times as needed
+         * - read outputs() after every run()
+         */
+        class Inferer
+        {
+        public:
+            /** Input and output description of a loaded model. */
+            struct IODescription
+            {
+                std::vector<TensorInfo> inputs;
+                std::vector<TensorInfo> outputs;
+            };
+
+            /** Destructor. */
+            virtual ~Inferer() = default;
+
+            /**
+             * Loads the model and prepares the runtime for inference.
+             *
+             * @param config inferer configuration parsed from param.yaml
+             * @param options runtime options
+             * @returns RETURN_SUCCESS or RETURN_FAIL
+             */
+            virtual int32_t load(const InfererConfig &config,
+                                 const InfererOptions &options) = 0;
+
+            /** Returns the inputs and outputs of the loaded model. */
+            const IODescription &describeIO() const { return m_io; }
+
+            /**
+             * Returns a view of input index if the backend owns its input
+             * memory, a view with data set to nullptr otherwise. Filling a
+             * backend owned buffer in place and binding it avoids a copy.
+             *
+             * @param index input index
+             */
+            virtual TensorView getInput(int32_t index);
+
+            /**
+             * Binds data as input index for the following runs. Depending on
+             * the runtime the data is used in place or copied, so the memory
+             * must stay valid and unchanged until run() returns.
+             *
+             * @param index input index
+             * @param view input data, type and shape
+             * @returns RETURN_SUCCESS or RETURN_FAIL
+             */
+            virtual int32_t bindInput(int32_t index, const TensorView &view) = 0;
+
+            /**
+             * Runs inference once on the bound inputs.
+             *
+             * @returns RETURN_SUCCESS or RETURN_FAIL
+             */
+            virtual int32_t run() = 0;
+
+            /** Returns views of the outputs of the last run(). */
+            const std::vector<TensorView> &outputs() const { return m_outputs; }
+
+            /**
+             * Sets the batch dimension, the first one, of every input. The
+             * inputs bound afterwards carry batch samples and the outputs
+             * of a run hold the results of all of them. The default accepts
+             * a batch the model already has, or any batch for a dynamic
+             * first dimension, which the runtime takes from the bound
+             * shape.
+             *
+             * @param batch number of samples per run
+             * @returns RETURN_SUCCESS or RETURN_FAIL
+             */
+            virtual int32_t setBatchSize(int32_t batch);
+
+            /**
+             * Keeps count sets of input and output tensors, so that one set
+             * can be filled and another post-processed while a third is
+             * run. getInput(), bindInput(), run() and outputs() work on the
+             * set chosen with selectTensorSet(), the views of a set stay
+             * valid while other sets are used. Backends that only have one
+             * set accept a count of 1.
+             *
+             * @param count number of sets
+             * @returns RETURN_SUCCESS or RETURN_FAIL, set 0 is selected
+             */
+            virtual int32_t setTensorSets(int32_t count);
+
+            /**
+             * Selects the tensor set used by the following calls.
+             *
+             * @param index set index, below the count given to
+             *        setTensorSets()
+             * @returns RETURN_SUCCESS or RETURN_FAIL
+             */
+            virtual int32_t selectTensorSet(int32_t index);
+
+            /**
+             * Creates and loads another instance of the loaded model, to be
+             * run from another thread. Backends that can share the read-only
+             * model data between instances do so, the default loads the
+             * model again.
+             *
+             * @param config inferer configuration given to load()
+             * @param options runtime options of the new instance
+             * @returns loaded instance, nullptr on failure
+             */
+            virtual std::unique_ptr<Inferer> createWorker(const InfererConfig &config,
+                                                          const InfererOptions &options);
+
+            /** Name of the runtime, as the session_name in param.yaml. */
+            virtual const char *getName() const = 0;
+
+            /** Logs the inputs and outputs of the loaded model. */
+            void dumpIO() const;
+
+        protected:
+            IODescription m_io;
+            std::vector<TensorView> m_outputs;
+        };
+
+        /**
+         * \brief Creates the backend for a runtime.
+         *
+         * @param rtType session_name from param.yaml, one of onnxrt,
+         *        tflitert, tvmdlr or tidlrt
+         * @returns backend, nullptr for an unknown runtime
+         */
+        std::unique_ptr<Inferer> createInferer(const std::string &rtType);
+
+    } // namespace tidl::inferer
+}
+
+#endif // _TI_EDGEAI_INFERER_H_
@@ -0,0 +1,151 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _TI_EDGEAI_LABEL_STORE_H_
+#define _TI_EDGEAI_LABEL_STORE_H_
+
+/* Standard headers. */
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace tidl
+{
+    namespace utils
+    {
+        /**
+         * \brief Non owning view of one label in a LabelStore. The data is not
+         *        NUL terminated, use size or str() when printing.
+         */
+        struct LabelView
+        {
+            /** Start of the label text. */
+            const char *data{nullptr};
+
+            /** Length of the label text in bytes. */
+            size_t size{0};
+
+            /** Returns true for an empty or missing label. */
+            bool empty() const { return size == 0; }
+
+            /** Returns a copy of the label. */
+            std::string str() const { return std::string(data, size); }
+        };
+
+        /**
+         * \brief Read only labels file memory mapped once and indexed by line.
+         *
+         * Stores are shared, opening the same path again returns the store that
+         * is already mapped as long as someone still holds a reference to it.
+         */
+        class LabelStore
+        {
+        public:
+            /** Maps the labels file at path, or returns the store already
+             * mapped for it.
+             *
+             * @param path path to the labels file, one label per line
+             * @returns shared store, nullptr if the file could not be mapped
+             */
+            static std::shared_ptr<LabelStore> open(const std::string &path);
+
+            /** Destructor, unmaps the file. */
+            ~LabelStore();
+
+            /** Number of lines in the file. */
+            size_t size() const { return m_lines.size(); }
+
+            /** Returns the label on the given line, an empty view if index is
+             * out of range.
+             *
+             * @param index zero based line number
+             */
+            LabelView line(int32_t index) const;
+
+            /** Path the store was mapped from. */
+            const std::string &path() const { return m_path; }
+
+        private:
+            LabelStore() = default;
+            LabelStore(const LabelStore &) = delete;
+            LabelStore &operator=(const LabelStore &) = delete;
+
+            int32_t map(const std::string &path);
+
+            /* Start and length of each line within the mapping. */
+            struct Line
+            {
+                uint32_t offset;
+                uint32_t length;
+            };
+
+            std::string m_path;
+            void *m_base{nullptr};
+            size_t m_length{0};
+            std::vector<Line> m_lines;
+        };
+
+    } // namespace utils
+} // namespace tidl
+
+#endif // _TI_EDGEAI_LABEL_STORE_H_
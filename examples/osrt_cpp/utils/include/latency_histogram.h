@@ -0,0 +1,173 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _TI_EDGEAI_LATENCY_HISTOGRAM_H_
+#define _TI_EDGEAI_LATENCY_HISTOGRAM_H_
+
+/* Standard headers. */
+#include <stdint.h>
+#include <vector>
+
+namespace tidl
+{
+    namespace utils
+    {
+        /**
+         * \brief Summary of a LatencyHistogram, all times in milliseconds.
+         */
+        struct LatencySummary
+        {
+            uint64_t count{0};
+            double minMs{0};
+            double p50Ms{0};
+            double p90Ms{0};
+            double p99Ms{0};
+            double p999Ms{0};
+            double maxMs{0};
+            double meanMs{0};
+            double stddevMs{0};
+        };
+
+        /**
+         * \brief Histogram of latencies in nanoseconds with log-linear
+         *        buckets: every power of two is split in 64 linear buckets,
+         *        so percentiles are within 1.6% of the recorded values
+         *        whatever their magnitude, in a fixed amount of memory.
+         *        Minimum, maximum, mean and standard deviation are exact.
+         *
+         * A histogram is not thread safe, give each thread its own and
+         * merge() them.
+         */
+        class LatencyHistogram
+        {
+        public:
+            /** Constructor, the histogram starts empty. */
+            LatencyHistogram();
+
+            /**
+             * Records one latency.
+             *
+             * @param ns latency in nanoseconds, as a difference of
+             *        getMonotonicNs()
+             */
+            void record(uint64_t ns);
+
+            /** Adds the latencies recorded by another histogram. */
+            void merge(const LatencyHistogram &other);
+
+            /** Forgets every recorded latency. */
+            void reset();
+
+            /** Number of recorded latencies. */
+            uint64_t count() const { return m_count; }
+
+            /**
+             * Returns the latency below which the given share of the
+             * recorded ones fall, in milliseconds, 0 when empty.
+             *
+             * @param percentile 0 to 100
+             */
+            double getPercentileMs(double percentile) const;
+
+            /** Returns min, p50, p90, p99, p99.9, max, mean and stddev. */
+            LatencySummary summarize() const;
+
+            /**
+             * Prints the column names of print().
+             *
+             * @param label name of the first column
+             * @param width width of the first column
+             */
+            static void printHeader(const char *label = "stage (ms)", int32_t width = 12);
+
+            /**
+             * Prints the summary as one row of a table.
+             *
+             * @param name row name, such as the stage
+             * @param width width of the first column, as given to
+             *        printHeader()
+             */
+            void print(const char *name, int32_t width = 12) const;
+
+        private:
+            static uint32_t getBucket(uint64_t ns);
+            static uint64_t getBucketMid(uint32_t bucket);
+
+            std::vector<uint64_t> m_buckets;
+            uint64_t m_count;
+            uint64_t m_min;
+            uint64_t m_max;
+            /* running mean and sum of squared deviations, in ms */
+            double m_mean;
+            double m_m2;
+        };
+
+        /**
+         * \brief Returns a monotonic time in nanoseconds from
+         *        std::chrono::steady_clock, for measuring latencies.
+         */
+        uint64_t getMonotonicNs();
+
+    } // namespace utils
+} // namespace tidl
+
+#endif // _TI_EDGEAI_LATENCY_HISTOGRAM_H_
@@ -65,6 +65,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /* Standard headers. */
 #include <map>
 #include <set>
+#include <memory>
 #include <fstream>
 #include <experimental/filesystem>
 #include <iostream>
@@ -78,6 +79,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "model_info.h"
 #include "ti_logger.h"
 #include "edgeai_classnames.h"
+#include "label_store.h"
 
 namespace tidl
 {
@@ -135,6 +137,26 @@ namespace tidl
           */
          int32_t devId{DLR_DEVID_INVALID};
 
+         /** ONNX Runtime intra-op thread count, session.intra_op_num_threads.
+          * -1 when not given.
+          */
+         int32_t intraOpThreads{-1};
+
+         /** ONNX Runtime inter-op thread count, session.inter_op_num_threads.
+          * -1 when not given.
+          */
+         int32_t interOpThreads{-1};
+
+         /** ONNX Runtime execution mode, session.execution_mode, sequential
+          * or parallel. Empty when not given.
+          */
+         std::string executionMode{};
+
+         /** ONNX Runtime worker spinning, session.allow_spinning, 0 or 1.
+          * -1 when not given.
+          */
+         int32_t allowSpinning{-1};
+
          /**
           * Helper function to dump the configuration information.
           */
@@ -309,6 +331,16 @@ namespace tidl
           */
          std::map<int32_t, int32_t> labelOffsetMap{{0, 0}};
 
+         /** labelOffsetMap resolved into a table indexed by the class id
+          * predicted by the model. Empty when labelOffsetMap holds a single
+          * scalar offset, which is then kept in labelOffset.
+          */
+         std::vector<int32_t> labelIndexTable;
+
+         /** Scalar offset applied to class ids not covered by
+          * labelIndexTable. */
+         int32_t labelOffset{0};
+
          /** Order of results for detection use case
           * default is assumed to be [0 1 2 3 4 5] which means
           * [x1y1 x2y2 label score]
@@ -358,7 +390,53 @@ namespace tidl
          int32_t outDataHeight{TI_POSTPROC_DEFAULT_HEIGHT};
 
          /** An array of strings for object class names. */
-         const std::string *classnames{nullptr};
+         const char *const *classnames{nullptr};
+
+         /** Number of entries in classnames. */
+         int32_t numClassnames{0};
+
+         /**
+          * Resolves labelOffsetMap into labelIndexTable and labelOffset. Has
+          * to be called again whenever labelOffsetMap is modified.
+          */
+         void resolveLabelOffsets()
+         {
+            labelIndexTable.clear();
+            labelOffset = 0;
+
+            if (labelOffsetMap.empty())
+            {
+               return;
+            }
+            if (labelOffsetMap.size() == 1)
+            {
+               labelOffset = labelOffsetMap.begin()->second;
+               return;
+            }
+
+            int32_t maxClassId = labelOffsetMap.rbegin()->first;
+            for (int32_t i = 0; i <= maxClassId; i++)
+            {
+               auto it = labelOffsetMap.find(i);
+               labelIndexTable.push_back((it != labelOffsetMap.end()) ? it->second : i);
+            }
+         }
+
+         /**
+          * Maps the class id predicted by the model to the index in the class
+          * name table.
+          *
+          * @param classId class id predicted by the model
+          */
+         int32_t getLabelIndex(int32_t classId) const
+         {
+            if ((classId >= 0) && (classId < static_cast<int32_t>(labelIndexTable.size())))
+            {
+               return labelIndexTable[classId];
+            }
+
+            return classId + labelOffset;
+         }
 
          /**
           * Helper function to dump the configuration information.
@@ -462,6 +540,12 @@ namespace tidl
          /** Path to the filename with classnames. */
          std::string m_labelsPath;
 
+         /** Labels read from m_labelsPath, mapped once during initialize()
+          * and shared with other models using the same file. nullptr if
+          * m_labelsPath is empty or could not be read.
+          */
+         std::shared_ptr<tidl::utils::LabelStore> m_labels;
+
          /** Alpha value used for blending the sementic segmentation output. */
          float m_alpha{0.5f};
 
@@ -0,0 +1,216 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _TI_EDGEAI_SHARED_TENSOR_POOL_H_
+#define _TI_EDGEAI_SHARED_TENSOR_POOL_H_
+
+/* Standard headers. */
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace tidl
+{
+    namespace utils
+    {
+        class SharedTensorPool;
+
+        /**
+         * \brief Buffer taken from a SharedTensorPool. It goes back to the
+         *        pool when the handle is destroyed or reset, the memory is
+         *        kept there for the next tensor of the same size class.
+         */
+        class PooledBuffer
+        {
+        public:
+            PooledBuffer() = default;
+            PooledBuffer(const PooledBuffer &) = delete;
+            PooledBuffer &operator=(const PooledBuffer &) = delete;
+            PooledBuffer(PooledBuffer &&other) { *this = std::move(other); }
+            PooledBuffer &operator=(PooledBuffer &&other);
+
+            /** Returns the buffer to its pool. */
+            ~PooledBuffer() { reset(); }
+
+            /** Returns the buffer to its pool, the handle becomes empty. */
+            void reset();
+
+            /** Start of the buffer, nullptr for an empty handle. */
+            void *data() const { return m_data; }
+
+            /** Usable size in bytes, the size class of the request. */
+            size_t size() const { return m_size; }
+
+            /** True when the memory is shared with the accelerator. */
+            bool isShared() const { return m_shared; }
+
+            explicit operator bool() const { return m_data != nullptr; }
+
+        private:
+            friend class SharedTensorPool;
+
+            SharedTensorPool *m_pool{nullptr};
+            void *m_data{nullptr};
+            size_t m_size{0};
+            bool m_shared{false};
+        };
+
+        /**
+         * \brief Process wide pool of aligned tensor buffers.
+         *
+         * Requests are rounded up to a size class, a power of two below
+         * 64 KB and a multiple of 64 KB above, and served from the buffers
+         * released earlier in that class before anything is allocated.
+         * Buffers stay in the pool across inferences and sessions, so a
+         * steady state loop does not allocate.
+         *
+         * Shared buffers come from TIDLRT_allocSharedMem when TIDL-RT is
+         * loaded in the process. Without it, as on PC, and for the private
+         * buffers, the memory comes from posix_memalign, backed by huge
+         * pages when the buffer is large enough.
+         */
+        class SharedTensorPool
+        {
+        public:
+            /** Smallest alignment handed out, also the TIDL-RT one. */
+            static const size_t MIN_ALIGNMENT = 64;
+
+            /** Returns the pool of the process. */
+            static SharedTensorPool &get();
+
+            /** Frees the buffers in the pool. */
+            ~SharedTensorPool();
+
+            /**
+             * Takes a buffer of at least size bytes.
+             *
+             * @param size size in bytes
+             * @param alignment alignment of the buffer, raised to
+             *        MIN_ALIGNMENT, must be a power of two
+             * @param shared take the buffer from the memory shared with the
+             *        accelerator
+             * @returns buffer, an empty handle on failure
+             */
+            PooledBuffer acquire(size_t size, size_t alignment, bool shared);
+
+            /** Frees the buffers that are in the pool and not taken. */
+            void trim();
+
+            /** Usage counters. */
+            struct Stats
+            {
+                /** Requests served. */
+                uint64_t acquired;
+
+                /** Requests served from the pool without allocating. */
+                uint64_t reused;
+
+                /** Bytes allocated, taken or in the pool. */
+                size_t bytes;
+            };
+
+            /** Returns the usage counters. */
+            Stats getStats() const;
+
+            /** True when shared buffers come from TIDL-RT. */
+            bool hasTidlrt() const { return m_tidlAlloc != nullptr; }
+
+        private:
+            SharedTensorPool();
+            SharedTensorPool(const SharedTensorPool &) = delete;
+            SharedTensorPool &operator=(const SharedTensorPool &) = delete;
+
+            friend class PooledBuffer;
+            void release(PooledBuffer *buffer);
+
+            /* one allocation, tidl tells which free function to use */
+            struct Block
+            {
+                void *data;
+                size_t alignment;
+                bool tidl;
+            };
+
+            /* free lists keyed by shared and size class */
+            typedef std::pair<bool, size_t> Key;
+
+            void *allocate(size_t size, size_t alignment, bool shared, bool *tidl);
+            void deallocate(const Block &block);
+
+            /* TIDLRT_allocSharedMem and TIDLRT_freeSharedMem looked up in
+            the process, nullptr without TIDL-RT */
+            void *m_tidlAlloc;
+            void *m_tidlFree;
+
+            mutable std::mutex m_mutex;
+            std::map<Key, std::vector<Block>> m_free;
+            std::map<void *, Block> m_taken;
+            Stats m_stats;
+        };
+
+    } // namespace utils
+} // namespace tidl
+
+#endif // _TI_EDGEAI_SHARED_TENSOR_POOL_H_
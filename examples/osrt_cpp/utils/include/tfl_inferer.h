@@ -0,0 +1,131 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef _TI_EDGEAI_TFL_INFERER_H_
+#define _TI_EDGEAI_TFL_INFERER_H_
+
+/* Third-party headers. */
+#include <tensorflow/lite/kernels/register.h>
+#include <tensorflow/lite/optional_debug_tools.h>
+
+/* Module headers. */
+#include "inferer.h"
+#include "shared_tensor_pool.h"
+
+namespace tidl
+{
+    namespace inferer
+    {
+        /**
+         * \brief TensorFlow Lite backend, offloads to TIDL through the TIDL
+         *        delegate when InfererOptions::accel is set. With
+         *        InfererOptions::xnnpack the XNNPACK delegate is applied
+         *        next, and runs the nodes TIDL did not claim.
+         *
+         * Workers made by createWorker() have their own interpreter on the
+         * same FlatBufferModel, so the weights are mapped once.
+         */
+        class TfliteInferer : public Inferer
+        {
+        public:
+            TfliteInferer();
+            ~TfliteInferer();
+
+            int32_t load(const InfererConfig &config,
+                         const InfererOptions &options) override;
+            std::unique_ptr<Inferer> createWorker(const InfererConfig &config,
+                                                  const InfererOptions &options) override;
+            TensorView getInput(int32_t index) override;
+            int32_t bindInput(int32_t index, const TensorView &view) override;
+            int32_t run() override;
+            int32_t setBatchSize(int32_t batch) override;
+            const char *getName() const override { return "tflitert"; }
+
+        private:
+            int32_t createInterpreter(const InfererConfig &config,
+                                      const InfererOptions &options);
+            TensorInfo getTensorInfo(int32_t tensorIndex);
+            void describeTensors();
+            int32_t createTidlDelegate(const std::string &artifactsPath);
+            int32_t createXnnpackDelegate(int32_t numThreads);
+            void reportDelegation(size_t numNodes);
+
+            /* mmapped model, shared with the workers created from this
+            instance */
+            std::shared_ptr<tflite::FlatBufferModel> m_model;
+            std::unique_ptr<tflite::Interpreter> m_interpreter;
+
+            /* TIDL delegate and the plugin library it came from */
+            void *m_delegateLib;
+            TfLiteDelegate *m_delegate;
+
+            /* XNNPACK delegate, owned */
+            TfLiteDelegate *m_xnnpackDelegate;
+
+            /* shared memory given to the interpreter with device_mem */
+            std::vector<tidl::utils::PooledBuffer> m_sharedMem;
+        };
+
+    } // namespace tidl::inferer
+}
+
+#endif // _TI_EDGEAI_TFL_INFERER_H_
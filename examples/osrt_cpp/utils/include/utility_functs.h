@@ -64,8 +64,10 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define UTILS_UTILITY_FUCTS_H_
 
 #include <iostream>
+#include <string>
 #include <vector>
 #include <getopt.h>
+#include <sched.h>
 
 #define RETURN_SUCCESS          (0)
 #define RETURN_FAIL             (-1)
@@ -86,6 +88,73 @@ namespace tidl
          */
         bool isSameFormat(std::vector<int32_t> format1, std::vector<int32_t> format2);
 
+        /**
+         *  \brief parses a CPU list such as "0,2-3" into cpu ids
+         *  \param  list cpu list
+         *  \param  cpus filled with the cpu ids
+         * @returns RETURN_SUCCESS, RETURN_FAIL for a malformed list
+         */
+        int32_t parseCpuList(const std::string &list, std::vector<int32_t> *cpus);
+
+        /**
+         *  \brief pins the calling thread to a set of cpus. Threads created
+         *         by the calling thread afterwards inherit the affinity.
+         *  \param  cpus cpu ids
+         * @returns RETURN_SUCCESS or RETURN_FAIL
+         */
+        int32_t setThreadAffinity(const std::vector<int32_t> &cpus);
+
+        /**
+         *  \brief pins the calling thread for the lifetime of the object
+         *         and restores its previous affinity on destruction. Used
+         *         around runtime initialization, whose thread pools inherit
+         *         the affinity, so the calling thread is not left pinned.
+         */
+        class ScopedThreadAffinity
+        {
+        public:
+            /** Saves the affinity of the calling thread. */
+            ScopedThreadAffinity();
+
+            /** Restores the saved affinity if set() changed it. */
+            ~ScopedThreadAffinity();
+
+            /**
+             *  \brief pins the calling thread to a set of cpus
+             *  \param  cpus cpu ids
+             * @returns RETURN_SUCCESS or RETURN_FAIL
+             */
+            int32_t set(const std::vector<int32_t> &cpus);
+
+        private:
+            ScopedThreadAffinity(const ScopedThreadAffinity &) = delete;
+            ScopedThreadAffinity &operator=(const ScopedThreadAffinity &) = delete;
+
+            cpu_set_t m_saved;
+            bool m_valid;
+            bool m_changed;
+        };
+
+        /**
+         *  \brief returns the resident set size of the process in bytes,
+         *         0 if it can not be read
+         */
+        size_t getResidentBytes();
+
+        /**
+         *  \brief returns the peak resident set size of the process in
+         *         bytes, 0 if it can not be read
+         */
+        size_t getPeakResidentBytes();
+
+        /**
+         *  \brief resets the peak resident set size of the process to the
+         *         current one, through /proc/self/clear_refs
+         * @returns RETURN_SUCCESS, RETURN_FAIL when the kernel does not
+         *          allow it
+         */
+        int32_t resetPeakResidentBytes();
+
     } // namespace utility_functs
 } // namespace tidl
 
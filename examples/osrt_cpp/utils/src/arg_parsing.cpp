@@ -60,12 +60,49 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+#include <glob.h>
+#include <strings.h>
+
 #include "../include/arg_parsing.h"
 
 namespace tidl
 {
     namespace arg_parsing
     {
+        /* ids of the options that have no short form, kept above the
+        range of characters returned by getopt_long */
+        enum LongOnlyOption
+        {
+            OPT_IMAGE_FORMAT = 256,
+            OPT_OUTPUT_QUEUE_DEPTH,
+            OPT_INPUT_LIST,
+            OPT_INPUT_DIR,
+            OPT_IO_BINDING,
+            OPT_ORT_CACHE_DIR,
+            OPT_INTRA_OP_THREADS,
+            OPT_INTER_OP_THREADS,
+            OPT_EXECUTION_MODE,
+            OPT_ALLOW_SPINNING,
+            OPT_CPU_AFFINITY,
+            OPT_THREAD_SWEEP,
+            OPT_XNNPACK,
+            OPT_WORKERS,
+            OPT_TENSOR_SETS,
+            OPT_PIPELINE_DEPTH,
+            OPT_MODELS,
+            OPT_MAX_BATCH,
+            OPT_MAX_WAIT_MS,
+            OPT_REQUEST_RATE,
+            OPT_SERVE,
+            OPT_FRAME_RING,
+            OPT_REPORT,
+            OPT_PARALLEL_MODELS,
+            OPT_SYNTHETIC
+        };
 
         /**
   *  \brief display usage string for application
@@ -82,13 +119,39 @@ namespace tidl
                 << "--input_std, -s: input standard deviation\n"
                 << "--artifact_path, -f: [0|1], Path for Delegate artifacts folder \n"
                 << "--model, -m: model path\n"
-                << "--image, -i: input_bmp_name with full path\n"
+                << "--image, -i: input_bmp_name with full path, or a quoted glob pattern\n"
+                << "--input_list: file listing one input image per line\n"
+                << "--input_dir: run on every image of a directory\n"
+                << "--io_binding: [0|1], onnxrt only, bind inputs and preallocated outputs once\n"
+                << "--ort_cache_dir: onnxrt only, directory caching the optimized models\n"
+                << "--intra_op_threads: onnxrt only, intra-op threads, defaults to --threads\n"
+                << "--inter_op_threads: onnxrt only, inter-op threads\n"
+                << "--execution_mode: onnxrt only, [sequential|parallel]\n"
+                << "--allow_spinning: onnxrt only, [0|1] let idle worker threads spin\n"
+                << "--cpu_affinity: cpus the runtime threads run on, e.g. 0,2-3\n"
+                << "--thread_sweep: [0|1] report latency and throughput over thread configurations\n"
+                << "--xnnpack: [0|1], tflitert only, run the nodes not offloaded to TIDL with XNNPACK\n"
+                << "--workers: model instances running the inputs in parallel, scaling is reported from 1 up\n"
+                << "--tensor_sets: tidlrt only, tensor sets to overlap pre and post-processing with inference\n"
+                << "--pipeline_depth: frames in flight between the preprocess, inference and post-process threads, 0 to run them in turn\n"
+                << "--models: dir[,dir...], more model directories run with -z concurrently on the same frames\n"
+                << "--max_batch: batch requests, sweeping batches of 1 up to this size\n"
+                << "--max_wait_ms: longest a request waits for its batch to fill, 5 by default\n"
+                << "--request_rate: requests per second when batching, 0 to send them all at once\n"
+                << "--serve: unix socket path, keep the -z and --models models loaded and serve requests on it\n"
+                << "--frame_ring: shared memory name of a frame ring to take the frames from\n"
+                << "--report: file.json or file.csv, write the results of the default loop there\n"
+                << "--parallel_models: benchmark_zoo only, models benchmarked at the same time\n"
+                << "--synthetic: [0|1] run on a generated noise image instead of -i\n"
                 << "--device_type, -y: device_type for dlr models can be cpu,gpu\n"
                 << "--labels, -l: labels for the model\n"
                 << "--zoo, -z: tidl model-zoo path\n"
                 << "--threads, -t: number of threads\n"
                 << "--num_results, -r: number of results to show\n"
                 << "--warmup_runs, -w: number of warmup runs\n"
+                << "--output_mode, -o: [image|json|binary|none] how results are emitted\n"
+                << "--image_format: [jpg|png|ppm] encoding of the saved image\n"
+                << "--output_queue_depth: results queued for the writer thread before frames are dropped\n"
                 << "\n";
         }
 
@@ -122,13 +185,39 @@ namespace tidl
                     {"threads", required_argument, nullptr, 't'},
                     {"num_results", required_argument, nullptr, 'r'},
                     {"warmup_runs", required_argument, nullptr, 'w'},
+                    {"output_mode", required_argument, nullptr, 'o'},
+                    {"image_format", required_argument, nullptr, OPT_IMAGE_FORMAT},
+                    {"output_queue_depth", required_argument, nullptr, OPT_OUTPUT_QUEUE_DEPTH},
+                    {"input_list", required_argument, nullptr, OPT_INPUT_LIST},
+                    {"input_dir", required_argument, nullptr, OPT_INPUT_DIR},
+                    {"io_binding", required_argument, nullptr, OPT_IO_BINDING},
+                    {"ort_cache_dir", required_argument, nullptr, OPT_ORT_CACHE_DIR},
+                    {"intra_op_threads", required_argument, nullptr, OPT_INTRA_OP_THREADS},
+                    {"inter_op_threads", required_argument, nullptr, OPT_INTER_OP_THREADS},
+                    {"execution_mode", required_argument, nullptr, OPT_EXECUTION_MODE},
+                    {"allow_spinning", required_argument, nullptr, OPT_ALLOW_SPINNING},
+                    {"cpu_affinity", required_argument, nullptr, OPT_CPU_AFFINITY},
+                    {"thread_sweep", required_argument, nullptr, OPT_THREAD_SWEEP},
+                    {"xnnpack", required_argument, nullptr, OPT_XNNPACK},
+                    {"workers", required_argument, nullptr, OPT_WORKERS},
+                    {"tensor_sets", required_argument, nullptr, OPT_TENSOR_SETS},
+                    {"pipeline_depth", required_argument, nullptr, OPT_PIPELINE_DEPTH},
+                    {"models", required_argument, nullptr, OPT_MODELS},
+                    {"max_batch", required_argument, nullptr, OPT_MAX_BATCH},
+                    {"max_wait_ms", required_argument, nullptr, OPT_MAX_WAIT_MS},
+                    {"request_rate", required_argument, nullptr, OPT_REQUEST_RATE},
+                    {"serve", required_argument, nullptr, OPT_SERVE},
+                    {"frame_ring", required_argument, nullptr, OPT_FRAME_RING},
+                    {"report", required_argument, nullptr, OPT_REPORT},
+                    {"parallel_models", required_argument, nullptr, OPT_PARALLEL_MODELS},
+                    {"synthetic", required_argument, nullptr, OPT_SYNTHETIC},
                     {nullptr, 0, nullptr, 0}};
 
                 /* getopt_long stores the option index here. */
                 int option_index = 0;
 
                 c = getopt_long(argc, argv,
-                                "v:a:d:c:f:m:i:y:l:t:r:w:z:", long_options,
+                                "v:a:d:c:f:m:i:y:l:t:r:w:z:o:", long_options,
                                 &option_index);
 
                 /* Detect the end of the options. */
@@ -176,6 +265,138 @@ namespace tidl
                 case 'w':
                     s->number_of_warmup_runs = strtol(optarg, nullptr, 10);
                     break;
+                case 'o':
+                    if (parseOutputMode(optarg, &s->output_mode) == RETURN_FAIL)
+                    {
+                        LOG_ERROR("unknown output mode %s\n", optarg);
+                        displayUsage();
+                        return RETURN_FAIL;
+                    }
+                    break;
+                case OPT_IMAGE_FORMAT:
+                    if (parseImageFormat(optarg, &s->image_format) == RETURN_FAIL)
+                    {
+                        LOG_ERROR("unknown image format %s\n", optarg);
+                        displayUsage();
+                        return RETURN_FAIL;
+                    }
+                    break;
+                case OPT_OUTPUT_QUEUE_DEPTH:
+                    s->output_queue_depth = strtol(optarg, nullptr, 10);
+                    break;
+                case OPT_INPUT_LIST:
+                    s->input_list_path = optarg;
+                    break;
+                case OPT_INPUT_DIR:
+                    s->input_dir_path = optarg;
+                    break;
+                case OPT_IO_BINDING:
+                    s->io_binding = strtol(optarg, nullptr, 10);
+                    break;
+                case OPT_ORT_CACHE_DIR:
+                    s->ort_cache_dir = optarg;
+                    break;
+                case OPT_INTRA_OP_THREADS:
+                    s->intra_op_threads = strtol(optarg, nullptr, 10);
+                    break;
+                case OPT_INTER_OP_THREADS:
+                    s->inter_op_threads = strtol(optarg, nullptr, 10);
+                    break;
+                case OPT_EXECUTION_MODE:
+                    if (strcmp(optarg, "sequential") && strcmp(optarg, "parallel"))
+                    {
+                        LOG_ERROR("unknown execution mode %s\n", optarg);
+                        displayUsage();
+                        return RETURN_FAIL;
+                    }
+                    s->execution_mode = optarg;
+                    break;
+                case OPT_ALLOW_SPINNING:
+                    s->allow_spinning = strtol(optarg, nullptr, 10) ? 1 : 0;
+                    break;
+                case OPT_CPU_AFFINITY:
+                    if (tidl::utility_functs::parseCpuList(optarg, &s->cpu_affinity) == RETURN_FAIL)
+                    {
+                        LOG_ERROR("invalid cpu list %s\n", optarg);
+                        displayUsage();
+                        return RETURN_FAIL;
+                    }
+                    break;
+                case OPT_THREAD_SWEEP:
+                    s->thread_sweep = strtol(optarg, nullptr, 10);
+                    break;
+                case OPT_XNNPACK:
+                    s->xnnpack = strtol(optarg, nullptr, 10);
+                    break;
+                case OPT_WORKERS:
+                    s->num_workers = strtol(optarg, nullptr, 10);
+                    if (s->num_workers < 1)
+                    {
+                        LOG_ERROR("invalid number of workers %s\n", optarg);
+                        return RETURN_FAIL;
+                    }
+                    break;
+                case OPT_TENSOR_SETS:
+                    s->tensor_sets = strtol(optarg, nullptr, 10);
+                    if (s->tensor_sets < 1)
+                    {
+                        LOG_ERROR("invalid number of tensor sets %s\n", optarg);
+                        return RETURN_FAIL;
+                    }
+                    break;
+                case OPT_MODELS:
+                {
+                    std::stringstream dirs(optarg);
+                    std::string dir;
+                    while (std::getline(dirs, dir, ','))
+                    {
+                        if (!dir.empty())
+                            s->model_dirs.push_back(dir);
+                    }
+                    break;
+                }
+                case OPT_MAX_BATCH:
+                    s->max_batch = strtol(optarg, nullptr, 10);
+                    if (s->max_batch < 0)
+                    {
+                        LOG_ERROR("invalid batch size %s\n", optarg);
+                        return RETURN_FAIL;
+                    }
+                    break;
+                case OPT_MAX_WAIT_MS:
+                    s->max_wait_ms = strtod(optarg, nullptr);
+                    break;
+                case OPT_REQUEST_RATE:
+                    s->request_rate = strtod(optarg, nullptr);
+                    break;
+                case OPT_SERVE:
+                    s->serve_socket = optarg;
+                    break;
+                case OPT_FRAME_RING:
+                    s->frame_ring = optarg;
+                    break;
+                case OPT_REPORT:
+                    s->report_path = optarg;
+                    break;
+                case OPT_PARALLEL_MODELS:
+                    s->parallel_models = strtol(optarg, nullptr, 10);
+                    if (s->parallel_models < 1)
+                    {
+                        LOG_ERROR("invalid number of parallel models %s\n", optarg);
+                        return RETURN_FAIL;
+                    }
+                    break;
+                case OPT_SYNTHETIC:
+                    s->synthetic_input = strtol(optarg, nullptr, 10);
+                    break;
+                case OPT_PIPELINE_DEPTH:
+                    s->pipeline_depth = strtol(optarg, nullptr, 10);
+                    if (s->pipeline_depth < 0)
+                    {
+                        LOG_ERROR("invalid pipeline depth %s\n", optarg);
+                        return RETURN_FAIL;
+                    }
+                    break;
                 case 'h':
                 case '?':
                     /* getopt_long already printed an error message. */
@@ -218,9 +439,220 @@ namespace tidl
             std::cout << "num of results set to: " << s->number_of_results << "\n";
             std::cout << "num of warmup runs set to: " << s->number_of_warmup_runs << "\n";
             std::cout << "task type set to: " << s->task_type << "\n";
+            std::cout << "output mode set to: " << getOutputModeName(s->output_mode) << "\n";
+            std::cout << "image format set to: " << getImageFormatName(s->image_format) << "\n";
+            std::cout << "output queue depth set to: " << s->output_queue_depth << "\n";
+            std::cout << "input list set to: " << s->input_list_path << "\n";
+            std::cout << "input dir set to: " << s->input_dir_path << "\n";
+            std::cout << "io binding set to: " << s->io_binding << "\n";
+            std::cout << "ort cache dir set to: " << s->ort_cache_dir << "\n";
+            std::cout << "intra op threads set to: " << s->intra_op_threads << "\n";
+            std::cout << "inter op threads set to: " << s->inter_op_threads << "\n";
+            std::cout << "execution mode set to: " << s->execution_mode << "\n";
+            std::cout << "allow spinning set to: " << s->allow_spinning << "\n";
+            std::cout << "cpu affinity set to:";
+            for (int32_t cpu : s->cpu_affinity)
+                std::cout << " " << cpu;
+            std::cout << "\n";
+            std::cout << "thread sweep set to: " << s->thread_sweep << "\n";
+            std::cout << "xnnpack set to: " << s->xnnpack << "\n";
+            std::cout << "num of workers set to: " << s->num_workers << "\n";
+            std::cout << "num of tensor sets set to: " << s->tensor_sets << "\n";
+            std::cout << "pipeline depth set to: " << s->pipeline_depth << "\n";
+            std::cout << "max batch set to: " << s->max_batch << "\n";
+            std::cout << "max wait set to: " << s->max_wait_ms << " ms\n";
+            std::cout << "request rate set to: " << s->request_rate << "\n";
+            std::cout << "serve socket set to: " << s->serve_socket << "\n";
+            std::cout << "frame ring set to: " << s->frame_ring << "\n";
+            std::cout << "report set to: " << s->report_path << "\n";
+            std::cout << "parallel models set to: " << s->parallel_models << "\n";
+            std::cout << "synthetic input set to: " << s->synthetic_input << "\n";
+            for (const std::string &dir : s->model_dirs)
+                std::cout << "additional model set to: " << dir << "\n";
 
             std::cout << "\n***** Display run Config: end *****\n";
         }
 
+        /**
+ * Converts an output mode name as given on the command line to the
+ * corresponding OutputMode.
+ *
+ * @param name one of none, json, binary or image
+ * @param mode pointer to the mode to be filled
+ *
+ * @returns RETURN_SUCCESS, RETURN_FAIL for an unknown name
+ */
+        int parseOutputMode(const char *name, OutputMode *mode)
+        {
+            for (int i = OUTPUT_MODE_IMAGE; i <= OUTPUT_MODE_BINARY; i++)
+            {
+                if (!strcmp(name, getOutputModeName((OutputMode)i)))
+                {
+                    *mode = (OutputMode)i;
+                    return RETURN_SUCCESS;
+                }
+            }
+            return RETURN_FAIL;
+        }
+
+        /**
+ * Returns the command line name of an output mode.
+ *
+ * @param mode output mode
+ *
+ * @returns name of the mode
+ */
+        const char *getOutputModeName(OutputMode mode)
+        {
+            switch (mode)
+            {
+            case OUTPUT_MODE_NONE:
+                return "none";
+            case OUTPUT_MODE_JSON:
+                return "json";
+            case OUTPUT_MODE_BINARY:
+                return "binary";
+            case OUTPUT_MODE_IMAGE:
+            default:
+                return "image";
+            }
+        }
+
+        /**
+ * Converts an image format name as given on the command line to the
+ * corresponding ImageFormat.
+ *
+ * @param name one of jpg, png or ppm
+ * @param format pointer to the format to be filled
+ *
+ * @returns RETURN_SUCCESS, RETURN_FAIL for an unknown name
+ */
+        int parseImageFormat(const char *name, ImageFormat *format)
+        {
+            for (int i = IMAGE_FORMAT_JPEG; i <= IMAGE_FORMAT_PPM; i++)
+            {
+                if (!strcmp(name, getImageFormatName((ImageFormat)i)))
+                {
+                    *format = (ImageFormat)i;
+                    return RETURN_SUCCESS;
+                }
+            }
+            return RETURN_FAIL;
+        }
+
+        /**
+ * Returns the command line name of an image format, which is also the file
+ * extension used for it.
+ *
+ * @param format image format
+ *
+ * @returns name of the format
+ */
+        const char *getImageFormatName(ImageFormat format)
+        {
+            switch (format)
+            {
+            case IMAGE_FORMAT_PNG:
+                return "png";
+            case IMAGE_FORMAT_PPM:
+                return "ppm";
+            case IMAGE_FORMAT_JPEG:
+            default:
+                return "jpg";
+            }
+        }
+
+        /**
+ * Returns true if the file name has the extension of an image format
+ * OpenCV reads.
+ *
+ * @param name file name
+ *
+ * @returns bool
+ */
+        static bool isImageFile(const std::string &name)
+        {
+            static const char *extensions[] = {".jpg", ".jpeg", ".png", ".bmp", ".ppm"};
+            size_t dot = name.rfind('.');
+            if (dot == std::string::npos)
+                return false;
+            for (const char *ext : extensions)
+            {
+                if (!strcasecmp(name.c_str() + dot, ext))
+                    return true;
+            }
+            return false;
+        }
+
+        int getInputList(const Settings *s, std::vector<std::string> *inputs)
+        {
+            inputs->clear();
+            const std::string &image = s->input_bmp_path;
+            if (image.find_first_of("*?[") != std::string::npos)
+            {
+                glob_t matches;
+                if (glob(image.c_str(), 0, nullptr, &matches) == 0)
+                {
+                    for (size_t i = 0; i < matches.gl_pathc; i++)
+                        inputs->push_back(matches.gl_pathv[i]);
+                }
+                globfree(&matches);
+                if (inputs->empty())
+                    LOG_WARN("no input matches %s\n", image.c_str());
+            }
+            else if (image != "")
+            {
+                inputs->push_back(image);
+            }
+
+            if (s->input_list_path != "")
+            {
+                std::ifstream list(s->input_list_path);
+                if (!list)
+                {
+                    LOG_ERROR("failed to open input list %s\n", s->input_list_path.c_str());
+                    return RETURN_FAIL;
+                }
+                std::string line;
+                while (std::getline(list, line))
+                {
+                    /* skip blank lines and comments */
+                    size_t start = line.find_first_not_of(" \t\r");
+                    if (start == std::string::npos || line[start] == '#')
+                        continue;
+                    size_t end = line.find_last_not_of(" \t\r");
+                    inputs->push_back(line.substr(start, end - start + 1));
+                }
+            }
+
+            if (s->input_dir_path != "")
+            {
+                DIR *dir = opendir(s->input_dir_path.c_str());
+                if (dir == nullptr)
+                {
+                    LOG_ERROR("failed to open input dir %s\n", s->input_dir_path.c_str());
+                    return RETURN_FAIL;
+                }
+                std::vector<std::string> names;
+                struct dirent *entry;
+                while ((entry = readdir(dir)) != nullptr)
+                {
+                    if (entry->d_name[0] != '.' && isImageFile(entry->d_name))
+                        names.push_back(entry->d_name);
+                }
+                closedir(dir);
+                std::sort(names.begin(), names.end());
+                for (const std::string &name : names)
+                    inputs->push_back(s->input_dir_path + "/" + name);
+            }
+
+            if (inputs->empty())
+            {
+                LOG_ERROR("no input image given\n");
+                return RETURN_FAIL;
+            }
+            return RETURN_SUCCESS;
+        }
+
     } //arg_parsing
 } //tidl
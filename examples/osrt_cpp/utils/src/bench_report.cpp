@@ -0,0 +1,288 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <stdio.h>
+
+/* Module headers. */
+#include "bench_report.h"
+#include "ti_logger.h"
+#include "utility_functs.h"
+
+namespace tidl
+{
+    namespace utils
+    {
+        /* stages with columns in the CSV report */
+        static const char *CSV_STAGES[] = {"decode", "preprocess", "inference", "postprocess"};
+
+        static void appendJsonString(std::string *out, const std::string &value)
+        {
+            out->push_back('"');
+            for (char c : value)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    out->push_back('\\');
+                    out->push_back(c);
+                }
+                else if ((unsigned char)c < 0x20)
+                {
+                    char esc[8];
+                    snprintf(esc, sizeof(esc), "\\u%04x", (unsigned char)c);
+                    out->append(esc);
+                }
+                else
+                {
+                    out->push_back(c);
+                }
+            }
+            out->push_back('"');
+        }
+
+        static void appendCsvString(std::string *out, const std::string &value)
+        {
+            if (value.find_first_of(",\"\n") == std::string::npos)
+            {
+                out->append(value);
+                return;
+            }
+            out->push_back('"');
+            for (char c : value)
+            {
+                if (c == '"')
+                    out->push_back('"');
+                out->push_back(c);
+            }
+            out->push_back('"');
+        }
+
+        static std::string format(const char *fmt, double value)
+        {
+            char buf[64];
+            snprintf(buf, sizeof(buf), fmt, value);
+            return buf;
+        }
+
+        static std::string number(double value)
+        {
+            return format("%.6g", value);
+        }
+
+        static std::string integer(uint64_t value)
+        {
+            return std::to_string((unsigned long long)value);
+        }
+
+        std::string BenchReport::toJson() const
+        {
+            std::string out;
+            out.append("{\n  \"schema\": \"tidl_bench_report\",\n  \"version\": ");
+            out.append(std::to_string(TI_BENCH_REPORT_VERSION));
+            out.append(",\n  \"results\": [");
+            for (size_t i = 0; i < m_records.size(); i++)
+            {
+                const BenchRecord &r = m_records[i];
+                out.append(i ? ",\n    {" : "\n    {");
+                out.append("\"model\": ");
+                appendJsonString(&out, r.model);
+                out.append(", \"model_path\": ");
+                appendJsonString(&out, r.modelPath);
+                out.append(", \"task_type\": ");
+                appendJsonString(&out, r.taskType);
+                out.append(", \"runtime\": ");
+                appendJsonString(&out, r.runtime);
+                out.append(", \"backend\": ");
+                appendJsonString(&out, r.backend);
+                out.append(", \"status\": ");
+                appendJsonString(&out, r.status);
+
+                out.append(",\n     \"options\": {\"accel\": ");
+                out.append(r.accel ? "true" : "false");
+                out.append(", \"device_mem\": ");
+                out.append(r.deviceMem ? "true" : "false");
+                out.append(", \"threads\": " + std::to_string(r.threads));
+                out.append(", \"intra_op_threads\": " + std::to_string(r.intraOpThreads));
+                out.append(", \"inter_op_threads\": " + std::to_string(r.interOpThreads));
+                out.append(", \"execution_mode\": ");
+                appendJsonString(&out, r.executionMode);
+                out.append(", \"cpu_affinity\": ");
+                appendJsonString(&out, r.cpuAffinity);
+                out.append(", \"warmup_runs\": " + std::to_string(r.warmupRuns));
+                out.append(", \"loop_count\": " + std::to_string(r.loopCount) + "}");
+
+                out.append(",\n     \"startup\": {\"load_ms\": " + number(r.loadMs));
+                out.append(", \"warmup_ms\": " + number(r.warmupMs) + "}");
+
+                out.append(",\n     \"throughput\": {\"inputs\": " + integer(r.inputs));
+                out.append(", \"failed\": " + integer(r.failed));
+                out.append(", \"inferences\": " + integer(r.inferences));
+                out.append(", \"wall_s\": " + number(r.wallS));
+                out.append(", \"inputs_per_s\": " + number(r.inputsPerS));
+                out.append(", \"inferences_per_s\": " + number(r.inferencesPerS) + "}");
+
+                out.append(",\n     \"peak_rss_bytes\": " + integer(r.peakRssBytes));
+                out.append(",\n     \"stages\": {");
+                for (size_t j = 0; j < r.stages.size(); j++)
+                {
+                    const LatencySummary &l = r.stages[j].second;
+                    out.append(j ? ",\n       " : "\n       ");
+                    appendJsonString(&out, r.stages[j].first);
+                    out.append(": {\"count\": " + integer(l.count));
+                    out.append(", \"min_ms\": " + number(l.minMs));
+                    out.append(", \"p50_ms\": " + number(l.p50Ms));
+                    out.append(", \"p90_ms\": " + number(l.p90Ms));
+                    out.append(", \"p99_ms\": " + number(l.p99Ms));
+                    out.append(", \"p999_ms\": " + number(l.p999Ms));
+                    out.append(", \"max_ms\": " + number(l.maxMs));
+                    out.append(", \"mean_ms\": " + number(l.meanMs));
+                    out.append(", \"stddev_ms\": " + number(l.stddevMs) + "}");
+                }
+                out.append("}}");
+            }
+            out.append("\n  ]\n}\n");
+            return out;
+        }
+
+        std::string BenchReport::toCsv() const
+        {
+            std::string out("model,model_path,task_type,runtime,backend,status,accel,device_mem,threads,"
+                            "intra_op_threads,inter_op_threads,execution_mode,cpu_affinity,warmup_runs,loop_count,"
+                            "load_ms,warmup_ms,inputs,failed,inferences,wall_s,inputs_per_s,inferences_per_s,"
+                            "peak_rss_bytes");
+            for (const char *stage : CSV_STAGES)
+            {
+                for (const char *column : {"count", "min_ms", "p50_ms", "p90_ms", "p99_ms", "p999_ms", "max_ms",
+                                           "mean_ms", "stddev_ms"})
+                {
+                    out.append(",");
+                    out.append(stage);
+                    out.append("_");
+                    out.append(column);
+                }
+            }
+            out.append("\n");
+
+            for (const BenchRecord &r : m_records)
+            {
+                for (const std::string *field : {&r.model, &r.modelPath, &r.taskType, &r.runtime, &r.backend,
+                                                 &r.status})
+                {
+                    appendCsvString(&out, *field);
+                    out.append(",");
+                }
+                out.append(std::string(r.accel ? "1" : "0") + "," + (r.deviceMem ? "1" : "0") + ",");
+                out.append(std::to_string(r.threads) + "," + std::to_string(r.intraOpThreads) + "," +
+                           std::to_string(r.interOpThreads) + ",");
+                appendCsvString(&out, r.executionMode);
+                out.append(",");
+                appendCsvString(&out, r.cpuAffinity);
+                out.append("," + std::to_string(r.warmupRuns) + "," + std::to_string(r.loopCount));
+                out.append("," + number(r.loadMs) + "," + number(r.warmupMs));
+                out.append("," + integer(r.inputs) + "," + integer(r.failed) + "," + integer(r.inferences));
+                out.append("," + number(r.wallS) + "," + number(r.inputsPerS) + "," + number(r.inferencesPerS));
+                out.append("," + integer(r.peakRssBytes));
+                for (const char *stage : CSV_STAGES)
+                {
+                    const LatencySummary *l = nullptr;
+                    for (const std::pair<std::string, LatencySummary> &s : r.stages)
+                    {
+                        if (s.first == stage)
+                            l = &s.second;
+                    }
+                    if (l == nullptr)
+                    {
+                        out.append(",,,,,,,,,");
+                        continue;
+                    }
+                    out.append("," + integer(l->count));
+                    for (double value : {l->minMs, l->p50Ms, l->p90Ms, l->p99Ms, l->p999Ms, l->maxMs, l->meanMs,
+                                         l->stddevMs})
+                        out.append("," + number(value));
+                }
+                out.append("\n");
+            }
+            return out;
+        }
+
+        int32_t BenchReport::write(const std::string &path) const
+        {
+            bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+            std::string contents = csv ? toCsv() : toJson();
+            FILE *fp = fopen(path.c_str(), "w");
+            if (fp == nullptr)
+            {
+                LOG_ERROR("Could not create report %s\n", path.c_str());
+                return RETURN_FAIL;
+            }
+            bool written = fwrite(contents.data(), 1, contents.size(), fp) == contents.size();
+            if (fclose(fp) != 0 || !written)
+            {
+                LOG_ERROR("Failed to write report %s\n", path.c_str());
+                return RETURN_FAIL;
+            }
+            LOG_INFO("%s report of %zu models written to %s\n", csv ? "csv" : "json", m_records.size(), path.c_str());
+            return RETURN_SUCCESS;
+        }
+
+    } // namespace utils
+} // namespace tidl
@@ -0,0 +1,318 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <string.h>
+
+/* Module headers. */
+#include "../include/dlr_inferer.h"
+
+namespace tidl
+{
+    namespace inferer
+    {
+        using namespace tidl::modelInfo;
+        using namespace tidl::utility_functs;
+        using tidl::utils::PooledBuffer;
+        using tidl::utils::SharedTensorPool;
+
+        static DlInferType toDlInferType(const char *type)
+        {
+            static const struct
+            {
+                const char *name;
+                DlInferType type;
+            } types[] = {
+                {"int8", DlInferType_Int8},
+                {"uint8", DlInferType_UInt8},
+                {"int16", DlInferType_Int16},
+                {"uint16", DlInferType_UInt16},
+                {"int32", DlInferType_Int32},
+                {"uint32", DlInferType_UInt32},
+                {"int64", DlInferType_Int64},
+                {"float16", DlInferType_Float16},
+                {"float32", DlInferType_Float32},
+            };
+
+            if (type != nullptr)
+            {
+                for (const auto &t : types)
+                {
+                    if (!strcmp(type, t.name))
+                        return t.type;
+                }
+            }
+            return DlInferType_Invalid;
+        }
+
+        DlrInferer::DlrInferer() : m_model(nullptr),
+                                   m_created(false),
+                                   m_zeroCopy(false)
+        {
+        }
+
+        DlrInferer::~DlrInferer()
+        {
+            if (m_created)
+            {
+                DeleteDLRModel(&m_model);
+            }
+            m_outputBuffers.clear();
+        }
+
+        int32_t DlrInferer::load(const InfererConfig &config,
+                                 const InfererOptions &options)
+        {
+            int device_type;
+            if (options.devType == "cpu")
+            {
+                device_type = 1;
+            }
+            else if (options.devType == "gpu")
+            {
+                device_type = 2;
+            }
+            else
+            {
+                LOG_ERROR("device type not supported: %s", options.devType.c_str());
+                return RETURN_FAIL;
+            }
+
+            const std::string &artifactsPath = options.artifactsPath.empty() ? config.artifactsPath : options.artifactsPath;
+            if (CreateDLRModel(&m_model, artifactsPath.c_str(), device_type, 0) != 0)
+            {
+                LOG_ERROR("Could not load DLR Model: %s\n", DLRGetLastError());
+                return RETURN_FAIL;
+            }
+            m_created = true;
+            LOG_INFO("Loaded model %s\n", artifactsPath.c_str());
+
+            /* the TVM thread pool is started by the first run, from the
+            running thread. With a cpu list its threads keep the affinity
+            they inherit instead of being pinned by TVM, see run() */
+            if (options.numThreads > 0 && SetDLRNumThreads(&m_model, options.numThreads) != 0)
+            {
+                LOG_ERROR("Could not set %d threads: %s\n", options.numThreads, DLRGetLastError());
+                return RETURN_FAIL;
+            }
+            m_cpuAffinity = options.cpuAffinity;
+            if (!m_cpuAffinity.empty())
+            {
+                UseDLRCPUAffinity(&m_model, 0);
+            }
+            LOG_INFO("threads: %d\n", options.numThreads);
+
+            int num_inputs = 0;
+            int num_outputs = 0;
+            GetDLRNumInputs(&m_model, &num_inputs);
+            GetDLRNumOutputs(&m_model, &num_outputs);
+
+            m_io.inputs.resize(num_inputs);
+            for (int i = 0; i < num_inputs; i++)
+            {
+                TensorInfo &info = m_io.inputs[i];
+                const char *name = nullptr;
+                const char *type = nullptr;
+                if (GetDLRInputName(&m_model, i, &name) != 0)
+                {
+                    LOG_ERROR("GetDLRInputName(%d) failed. Error [%s].\n", i, DLRGetLastError());
+                    return RETURN_FAIL;
+                }
+                GetDLRInputType(&m_model, i, &type);
+                int64_t size = 0;
+                int dim = 0;
+                GetDLRInputSizeDim(&m_model, i, &size, &dim);
+                info.name = name;
+                info.type = toDlInferType(type);
+                info.shape.resize(dim);
+                GetDLRInputShape(&m_model, i, info.shape.data());
+            }
+
+            m_io.outputs.resize(num_outputs);
+            m_outputBuffers.clear();
+            m_outputs.resize(num_outputs);
+            for (int i = 0; i < num_outputs; i++)
+            {
+                TensorInfo &info = m_io.outputs[i];
+                const char *name = nullptr;
+                const char *type = nullptr;
+                if (GetDLROutputName(&m_model, i, &name) == 0 && name != nullptr)
+                {
+                    info.name = name;
+                }
+                GetDLROutputType(&m_model, i, &type);
+                int64_t size = 0;
+                int dim = 0;
+                GetDLROutputSizeDim(&m_model, i, &size, &dim);
+                info.type = toDlInferType(type);
+                info.shape.resize(dim);
+                GetDLROutputShape(&m_model, i, info.shape.data());
+
+                m_outputs[i].data = nullptr;
+                m_outputs[i].type = info.type;
+                m_outputs[i].shape = info.shape;
+            }
+            m_zeroCopy = true;
+            return RETURN_SUCCESS;
+        }
+
+        /**
+         * Sizes one buffer per output from the model metadata, for the
+         * runtimes that can only copy the outputs out.
+         *
+         * @returns RETURN_SUCCESS or RETURN_FAIL
+         */
+        int32_t DlrInferer::allocOutputBuffers()
+        {
+            m_outputBuffers.clear();
+            for (size_t i = 0; i < m_io.outputs.size(); i++)
+            {
+                const TensorInfo &info = m_io.outputs[i];
+                PooledBuffer buffer = SharedTensorPool::get().acquire(info.getSizeBytes(),
+                                                                      SharedTensorPool::MIN_ALIGNMENT, false);
+                if (!buffer)
+                {
+                    LOG_ERROR("Could not allocate memory for output %d\n", (int32_t)i);
+                    return RETURN_FAIL;
+                }
+                m_outputs[i].data = buffer.data();
+                m_outputBuffers.push_back(std::move(buffer));
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int32_t DlrInferer::bindInput(int32_t index, const TensorView &view)
+        {
+            if (index < 0 || index >= static_cast<int32_t>(m_io.inputs.size()))
+            {
+                LOG_ERROR("invalid input index %d\n", index);
+                return RETURN_FAIL;
+            }
+            /* DLR copies the data into its own input tensor */
+            if (SetDLRInput(&m_model, m_io.inputs[index].name.c_str(), view.shape.data(),
+                            view.data, view.shape.size()) != 0)
+            {
+                LOG_ERROR("Could not set input:%s\n", m_io.inputs[index].name.c_str());
+                return RETURN_FAIL;
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int32_t DlrInferer::run()
+        {
+            /* TVM keeps one thread pool per calling thread, started by its
+            first run. Only that run is pinned, so the pool inherits the cpu
+            list and the calling thread gets its own affinity back */
+            static thread_local bool poolStarted = false;
+            int status;
+            if (!poolStarted && !m_cpuAffinity.empty())
+            {
+                ScopedThreadAffinity affinity;
+                if (RETURN_FAIL == affinity.set(m_cpuAffinity))
+                {
+                    LOG_ERROR("Could not set the cpu affinity\n");
+                    return RETURN_FAIL;
+                }
+                status = RunDLRModel(&m_model);
+            }
+            else
+            {
+                status = RunDLRModel(&m_model);
+            }
+            poolStarted = true;
+            if (status != 0)
+            {
+                LOG_ERROR("Could not run: %s\n", DLRGetLastError());
+                return RETURN_FAIL;
+            }
+
+            /* point the views at the output tensors of the runtime, they
+            stay valid until the next run */
+            for (size_t i = 0; i < m_outputs.size() && m_zeroCopy; i++)
+            {
+                const void *data = nullptr;
+                if (GetDLROutputPtr(&m_model, i, &data) != 0 || data == nullptr)
+                {
+                    LOG_INFO("output %d can not be read in place, copying the outputs\n", (int32_t)i);
+                    m_zeroCopy = false;
+                    if (RETURN_FAIL == allocOutputBuffers())
+                        return RETURN_FAIL;
+                    break;
+                }
+                m_outputs[i].data = const_cast<void *>(data);
+            }
+            if (m_zeroCopy)
+                return RETURN_SUCCESS;
+
+            for (size_t i = 0; i < m_outputBuffers.size(); i++)
+            {
+                if (GetDLROutput(&m_model, i, m_outputBuffers[i].data()) != 0)
+                {
+                    LOG_ERROR("Could not get output:%d", (int32_t)i);
+                    return RETURN_FAIL;
+                }
+            }
+            return RETURN_SUCCESS;
+        }
+
+    } // namespace tidl::inferer
+}
@@ -60,6 +60,9 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 
+/* Standard headers. */
+#include <cstring>
+
 /* Module headers. */
 #include "../include/edgeai_classnames.h"
 
@@ -68,7 +71,7 @@ namespace ti
     namespace common
     {
 
-        std::string classnames_imagenet[] = {
+        constexpr const char *classnames_imagenet[] = {
             [0] = "tench, Tinca tinca",
             [1] = "goldfish, Carassius auratus",
             [2] = "great white shark, white shark, man-eater, man-eating shark, Carcharodon carcharias",
@@ -1071,7 +1074,7 @@ namespace ti
             [999] = "toilet tissue, toilet paper, bathroom tissue",
         };
 
-        std::string classnames_pascal_voc[] = {
+        constexpr const char *classnames_pascal_voc[] = {
             [0] = "none",
             [1] = "aeroplane",
             [2] = "bicycle",
@@ -1094,7 +1097,7 @@ namespace ti
             [19] = "train",
             [20] = "tvmonitor"};
 
-        std::string classnames_coco[] = {
+        constexpr const char *classnames_coco[] = {
             [0] = "None",
             [1] = "person/person",
             [2] = "vehicle/bicycle",
@@ -1188,12 +1191,63 @@ namespace ti
             [90] = "indoor/toothbrush",
             [91] = "indoor/hair brush"};
 
-        std::map<std::string, std::string *> gClassNameMap =
+#define TI_NUM_CLASSNAMES(X) (int32_t)(sizeof(X) / sizeof(X[0]))
+
+        /* True when none of names[begin, end) is null. Designated
+        initializers leave unlisted ids null, so a gap in a table fails
+        the build instead of reaching strlen() in the post processing.
+        Halves the range to keep the constexpr recursion shallow. */
+        constexpr bool hasNoNullEntry(const char *const *names, int32_t begin, int32_t end)
+        {
+            return (end - begin == 1) ? (names[begin] != nullptr)
+                   : (end - begin < 1) ? true
+                   : (hasNoNullEntry(names, begin, begin + (end - begin) / 2) &&
+                      hasNoNullEntry(names, begin + (end - begin) / 2, end));
+        }
+
+        static_assert(TI_NUM_CLASSNAMES(classnames_imagenet) == 1000, "imagenet class names incomplete");
+        static_assert(TI_NUM_CLASSNAMES(classnames_pascal_voc) == 21, "pascal_voc class names incomplete");
+        static_assert(TI_NUM_CLASSNAMES(classnames_coco) == 92, "coco class names incomplete");
+        static_assert(hasNoNullEntry(classnames_imagenet, 0, TI_NUM_CLASSNAMES(classnames_imagenet)),
+                      "imagenet class names have a gap");
+        static_assert(hasNoNullEntry(classnames_pascal_voc, 0, TI_NUM_CLASSNAMES(classnames_pascal_voc)),
+                      "pascal_voc class names have a gap");
+        static_assert(hasNoNullEntry(classnames_coco, 0, TI_NUM_CLASSNAMES(classnames_coco)),
+                      "coco class names have a gap");
+
+        /* Indexed by ClassNameSet. Constant initialized, no static
+        constructors run for any of the tables. */
+        constexpr ClassNameTable gClassNameTables[CLASSNAMES_MAX] =
             {
-                {"imagenet", classnames_imagenet},
-                {"pascal_voc", classnames_pascal_voc},
-                {"coco", classnames_coco},
+                {"imagenet", classnames_imagenet, TI_NUM_CLASSNAMES(classnames_imagenet)},
+                {"pascal_voc", classnames_pascal_voc, TI_NUM_CLASSNAMES(classnames_pascal_voc)},
+                {"coco", classnames_coco, TI_NUM_CLASSNAMES(classnames_coco)},
         };
 
+        const ClassNameTable &getClassNames(ClassNameSet set)
+        {
+            static const ClassNameTable empty = {"", nullptr, 0};
+
+            if ((set < 0) || (set >= CLASSNAMES_MAX))
+            {
+                return empty;
+            }
+
+            return gClassNameTables[set];
+        }
+
+        ClassNameSet getClassNameSet(const char *name)
+        {
+            for (int32_t i = 0; i < CLASSNAMES_MAX; i++)
+            {
+                if (strcmp(gClassNameTables[i].dataset, name) == 0)
+                {
+                    return static_cast<ClassNameSet>(i);
+                }
+            }
+
+            return CLASSNAMES_MAX;
+        }
+
     } //common
 } //ti
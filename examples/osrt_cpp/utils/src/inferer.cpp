@@ -0,0 +1,270 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Module headers. */
+#include "../include/inferer.h"
+#include "../include/onnx_inferer.h"
+#include "../include/tfl_inferer.h"
+#include "../include/dlr_inferer.h"
+#include "../include/tidlrt_inferer.h"
+
+namespace tidl
+{
+    namespace inferer
+    {
+        using namespace tidl::modelInfo;
+
+        size_t getTypeSize(DlInferType type)
+        {
+            switch (type)
+            {
+            case DlInferType_Int8:
+            case DlInferType_UInt8:
+                return 1;
+            case DlInferType_Int16:
+            case DlInferType_UInt16:
+            case DlInferType_Float16:
+                return 2;
+            case DlInferType_Int32:
+            case DlInferType_UInt32:
+            case DlInferType_Float32:
+                return 4;
+            case DlInferType_Int64:
+                return 8;
+            default:
+                return 0;
+            }
+        }
+
+        const char *getTypeName(DlInferType type)
+        {
+            switch (type)
+            {
+            case DlInferType_Int8:
+                return "int8";
+            case DlInferType_UInt8:
+                return "uint8";
+            case DlInferType_Int16:
+                return "int16";
+            case DlInferType_UInt16:
+                return "uint16";
+            case DlInferType_Int32:
+                return "int32";
+            case DlInferType_UInt32:
+                return "uint32";
+            case DlInferType_Int64:
+                return "int64";
+            case DlInferType_Float16:
+                return "float16";
+            case DlInferType_Float32:
+                return "float32";
+            default:
+                return "invalid";
+            }
+        }
+
+        static int64_t countElements(const std::vector<int64_t> &shape)
+        {
+            int64_t count = 1;
+            for (int64_t dim : shape)
+            {
+                count *= dim > 0 ? dim : 1;
+            }
+            return count;
+        }
+
+        int64_t TensorInfo::getNumElements() const
+        {
+            return countElements(shape);
+        }
+
+        int64_t TensorView::getNumElements() const
+        {
+            return countElements(shape);
+        }
+
+        float TensorView::getFloat(int64_t i) const
+        {
+            switch (type)
+            {
+            case DlInferType_Int8:
+                return static_cast<const int8_t *>(data)[i];
+            case DlInferType_UInt8:
+                return static_cast<const uint8_t *>(data)[i];
+            case DlInferType_Int16:
+                return static_cast<const int16_t *>(data)[i];
+            case DlInferType_UInt16:
+                return static_cast<const uint16_t *>(data)[i];
+            case DlInferType_Int32:
+                return static_cast<const int32_t *>(data)[i];
+            case DlInferType_UInt32:
+                return static_cast<const uint32_t *>(data)[i];
+            case DlInferType_Int64:
+                return static_cast<const int64_t *>(data)[i];
+            case DlInferType_Float32:
+                return static_cast<const float *>(data)[i];
+            default:
+                /* float16 outputs are not produced by any supported model */
+                return 0.0f;
+            }
+        }
+
+        TensorView Inferer::getInput(int32_t index)
+        {
+            TensorView view;
+            if (index >= 0 && index < static_cast<int32_t>(m_io.inputs.size()))
+            {
+                view.type = m_io.inputs[index].type;
+                view.shape = m_io.inputs[index].shape;
+            }
+            return view;
+        }
+
+        int32_t Inferer::setBatchSize(int32_t batch)
+        {
+            for (const TensorInfo &info : m_io.inputs)
+            {
+                if (info.shape.empty() || (info.shape[0] >= 0 && info.shape[0] != batch))
+                {
+                    LOG_ERROR("%s: input %s has a fixed batch, %d can not be run\n", getName(),
+                              info.name.c_str(), batch);
+                    return RETURN_FAIL;
+                }
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int32_t Inferer::setTensorSets(int32_t count)
+        {
+            if (count != 1)
+            {
+                LOG_ERROR("%s supports a single tensor set\n", getName());
+                return RETURN_FAIL;
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int32_t Inferer::selectTensorSet(int32_t index)
+        {
+            return index == 0 ? RETURN_SUCCESS : RETURN_FAIL;
+        }
+
+        std::unique_ptr<Inferer> Inferer::createWorker(const InfererConfig &config,
+                                                       const InfererOptions &options)
+        {
+            std::unique_ptr<Inferer> worker = createInferer(getName());
+            if (worker && worker->load(config, options) == RETURN_FAIL)
+            {
+                worker.reset();
+            }
+            return worker;
+        }
+
+        static void dumpTensorInfo(const char *kind, int32_t index, const TensorInfo &info)
+        {
+            std::string shape;
+            for (size_t i = 0; i < info.shape.size(); i++)
+            {
+                shape += (i ? "," : "") + std::to_string(info.shape[i]);
+            }
+            LOG_INFO("%s %d : name=%s type=%s shape=[%s]\n", kind, index,
+                     info.name.c_str(), getTypeName(info.type), shape.c_str());
+        }
+
+        void Inferer::dumpIO() const
+        {
+            LOG_INFO("%s: number of inputs:%d outputs:%d\n", getName(),
+                     (int32_t)m_io.inputs.size(), (int32_t)m_io.outputs.size());
+            for (size_t i = 0; i < m_io.inputs.size(); i++)
+            {
+                dumpTensorInfo("Input", i, m_io.inputs[i]);
+            }
+            for (size_t i = 0; i < m_io.outputs.size(); i++)
+            {
+                dumpTensorInfo("Output", i, m_io.outputs[i]);
+            }
+        }
+
+        std::unique_ptr<Inferer> createInferer(const std::string &rtType)
+        {
+            if (rtType == "onnxrt")
+            {
+                return std::unique_ptr<Inferer>(new OnnxInferer());
+            }
+            else if (rtType == "tflitert")
+            {
+                return std::unique_ptr<Inferer>(new TfliteInferer());
+            }
+            else if (rtType == "tvmdlr")
+            {
+                return std::unique_ptr<Inferer>(new DlrInferer());
+            }
+            else if (rtType == "tidlrt")
+            {
+                return std::unique_ptr<Inferer>(new TidlrtInferer());
+            }
+            LOG_ERROR("runtime %s not supported\n", rtType.c_str());
+            return nullptr;
+        }
+
+    } // namespace tidl::inferer
+}
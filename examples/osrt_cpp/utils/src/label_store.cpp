@@ -0,0 +1,196 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <map>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Module headers. */
+#include "../include/label_store.h"
+#include "../include/ti_logger.h"
+
+namespace tidl
+{
+    namespace utils
+    {
+        static std::mutex gLabelStoreMutex;
+        static std::map<std::string, std::weak_ptr<LabelStore>> gLabelStores;
+
+        std::shared_ptr<LabelStore> LabelStore::open(const std::string &path)
+        {
+            std::lock_guard<std::mutex> lock(gLabelStoreMutex);
+            std::shared_ptr<LabelStore> store = gLabelStores[path].lock();
+
+            if (store)
+            {
+                return store;
+            }
+
+            store.reset(new LabelStore());
+            if (store->map(path) != 0)
+            {
+                gLabelStores.erase(path);
+                return nullptr;
+            }
+
+            gLabelStores[path] = store;
+            return store;
+        }
+
+        /**
+         *  \brief Maps the file and records the offset and length of each line,
+         *  trailing '\r' of DOS line endings is not part of the label.
+         *
+         *  \param  path : labels file path
+         *  \return int :0?Success:Failure
+         */
+        int32_t LabelStore::map(const std::string &path)
+        {
+            struct stat st;
+            int fd = ::open(path.c_str(), O_RDONLY);
+
+            if (fd < 0)
+            {
+                LOG_ERROR("Labels file  %s not found\n", path.c_str());
+                return -1;
+            }
+
+            if (fstat(fd, &st) < 0)
+            {
+                LOG_ERROR("Could not stat labels file  %s\n", path.c_str());
+                close(fd);
+                return -1;
+            }
+
+            m_path = path;
+            m_length = st.st_size;
+
+            if (m_length > 0)
+            {
+                m_base = mmap(nullptr, m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            close(fd);
+
+            if (m_base == MAP_FAILED)
+            {
+                LOG_ERROR("Could not map labels file  %s\n", path.c_str());
+                m_base = nullptr;
+                return -1;
+            }
+
+            const char *data = static_cast<const char *>(m_base);
+            size_t start = 0;
+
+            for (size_t i = 0; i <= m_length; i++)
+            {
+                if ((i == m_length) || (data[i] == '\n'))
+                {
+                    /* No empty entry after the final newline, same as
+                    std::getline */
+                    if ((i == m_length) && (start == m_length))
+                    {
+                        break;
+                    }
+
+                    size_t end = i;
+                    if ((end > start) && (data[end - 1] == '\r'))
+                    {
+                        end--;
+                    }
+
+                    Line line = {static_cast<uint32_t>(start), static_cast<uint32_t>(end - start)};
+                    m_lines.push_back(line);
+                    start = i + 1;
+                }
+            }
+
+            LOG_DEBUG("Mapped %zu labels from %s\n", m_lines.size(), path.c_str());
+            return 0;
+        }
+
+        LabelView LabelStore::line(int32_t index) const
+        {
+            LabelView view;
+
+            if ((index >= 0) && (index < static_cast<int32_t>(m_lines.size())))
+            {
+                view.data = static_cast<const char *>(m_base) + m_lines[index].offset;
+                view.size = m_lines[index].length;
+            }
+
+            return view;
+        }
+
+        LabelStore::~LabelStore()
+        {
+            if (m_base != nullptr)
+            {
+                munmap(m_base, m_length);
+            }
+        }
+
+    } // namespace utils
+} // namespace tidl
@@ -0,0 +1,209 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdio.h>
+
+/* Module headers. */
+#include "latency_histogram.h"
+
+namespace tidl
+{
+    namespace utils
+    {
+        /* 2^SUB_BITS linear buckets per power of two */
+        static const uint32_t SUB_BITS = 6;
+        static const uint64_t SUB_COUNT = 1ULL << SUB_BITS;
+        /* latencies up to 2^40 ns, about 18 minutes, larger ones are
+        clamped */
+        static const uint32_t MAX_BITS = 40;
+        static const uint32_t NUM_BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+        uint64_t getMonotonicNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        LatencyHistogram::LatencyHistogram() : m_buckets(NUM_BUCKETS, 0)
+        {
+            reset();
+        }
+
+        void LatencyHistogram::reset()
+        {
+            std::fill(m_buckets.begin(), m_buckets.end(), 0);
+            m_count = 0;
+            m_min = 0;
+            m_max = 0;
+            m_mean = 0;
+            m_m2 = 0;
+        }
+
+        uint32_t LatencyHistogram::getBucket(uint64_t ns)
+        {
+            /* values below SUB_COUNT have a bucket each, then each power of
+            two 2^m gets SUB_COUNT buckets of width 2^(m - SUB_BITS) */
+            if (ns < SUB_COUNT)
+                return ns;
+            uint32_t magnitude = 63 - __builtin_clzll(ns);
+            if (magnitude >= MAX_BITS)
+                return NUM_BUCKETS - 1;
+            uint32_t shift = magnitude - SUB_BITS;
+            return (shift + 1) * SUB_COUNT + ((ns >> shift) - SUB_COUNT);
+        }
+
+        uint64_t LatencyHistogram::getBucketMid(uint32_t bucket)
+        {
+            if (bucket < SUB_COUNT)
+                return bucket;
+            uint32_t shift = bucket / SUB_COUNT - 1;
+            uint64_t low = (bucket % SUB_COUNT + SUB_COUNT) << shift;
+            return low + ((1ULL << shift) >> 1);
+        }
+
+        void LatencyHistogram::record(uint64_t ns)
+        {
+            m_buckets[getBucket(ns)]++;
+            if (m_count == 0 || ns < m_min)
+                m_min = ns;
+            if (ns > m_max)
+                m_max = ns;
+            m_count++;
+            double ms = ns / 1e6;
+            double delta = ms - m_mean;
+            m_mean += delta / m_count;
+            m_m2 += delta * (ms - m_mean);
+        }
+
+        void LatencyHistogram::merge(const LatencyHistogram &other)
+        {
+            if (other.m_count == 0)
+                return;
+            for (uint32_t i = 0; i < NUM_BUCKETS; i++)
+                m_buckets[i] += other.m_buckets[i];
+            if (m_count == 0 || other.m_min < m_min)
+                m_min = other.m_min;
+            m_max = std::max(m_max, other.m_max);
+            uint64_t count = m_count + other.m_count;
+            double delta = other.m_mean - m_mean;
+            m_m2 += other.m_m2 + delta * delta * m_count * other.m_count / count;
+            m_mean += delta * other.m_count / count;
+            m_count = count;
+        }
+
+        double LatencyHistogram::getPercentileMs(double percentile) const
+        {
+            if (m_count == 0)
+                return 0;
+            uint64_t rank = (uint64_t)std::ceil(percentile / 100 * m_count);
+            rank = std::min(std::max(rank, (uint64_t)1), m_count);
+            uint64_t seen = 0;
+            for (uint32_t i = 0; i < NUM_BUCKETS; i++)
+            {
+                seen += m_buckets[i];
+                if (seen >= rank)
+                {
+                    uint64_t ns = std::min(std::max(getBucketMid(i), m_min), m_max);
+                    return ns / 1e6;
+                }
+            }
+            return m_max / 1e6;
+        }
+
+        LatencySummary LatencyHistogram::summarize() const
+        {
+            LatencySummary summary;
+            summary.count = m_count;
+            if (m_count == 0)
+                return summary;
+            summary.minMs = m_min / 1e6;
+            summary.p50Ms = getPercentileMs(50);
+            summary.p90Ms = getPercentileMs(90);
+            summary.p99Ms = getPercentileMs(99);
+            summary.p999Ms = getPercentileMs(99.9);
+            summary.maxMs = m_max / 1e6;
+            summary.meanMs = m_mean;
+            summary.stddevMs = m_count > 1 ? std::sqrt(m_m2 / (m_count - 1)) : 0;
+            return summary;
+        }
+
+        void LatencyHistogram::printHeader(const char *label, int32_t width)
+        {
+            printf("%-*s %8s %10s %10s %10s %10s %10s %10s %10s %10s\n", width, label, "count", "min", "p50", "p90",
+                   "p99", "p99.9", "max", "mean", "stddev");
+        }
+
+        void LatencyHistogram::print(const char *name, int32_t width) const
+        {
+            LatencySummary s = summarize();
+            printf("%-*s %8llu %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", width, name,
+                   (unsigned long long)s.count, s.minMs, s.p50Ms, s.p90Ms, s.p99Ms, s.p999Ms, s.maxMs, s.meanMs,
+                   s.stddevMs);
+        }
+
+    } // namespace utils
+} // namespace tidl
@@ -73,6 +73,10 @@ namespace tidl
             LOG_INFO("InfererConfig::Artifacts Path    = %s\n", artifactsPath.c_str());
             LOG_INFO("InfererConfig::Runtime API       = %s\n", rtType.c_str());
             LOG_INFO("InfererConfig::Device Type       = %s\n", devType.c_str());
+            LOG_INFO("InfererConfig::Intra-op Threads  = %d\n", intraOpThreads);
+            LOG_INFO("InfererConfig::Inter-op Threads  = %d\n", interOpThreads);
+            LOG_INFO("InfererConfig::Execution Mode    = %s\n", executionMode.c_str());
+            LOG_INFO("InfererConfig::Allow Spinning    = %d\n", allowSpinning);
             LOG_INFO_RAW("\n");
         }
 
@@ -141,6 +145,24 @@ namespace tidl
                 {
                     infConfig.devId = 0;
                 }
+
+                /* optional runtime threading, only looked at by onnxrt */
+                if (n["intra_op_num_threads"])
+                {
+                    infConfig.intraOpThreads = n["intra_op_num_threads"].as<int32_t>();
+                }
+                if (n["inter_op_num_threads"])
+                {
+                    infConfig.interOpThreads = n["inter_op_num_threads"].as<int32_t>();
+                }
+                if (n["execution_mode"])
+                {
+                    infConfig.executionMode = n["execution_mode"].as<std::string>();
+                }
+                if (n["allow_spinning"])
+                {
+                    infConfig.allowSpinning = n["allow_spinning"].as<int32_t>();
+                }
             }
 
             return status;
@@ -377,6 +399,8 @@ namespace tidl
                         status = -1;
                     }
                 }
+
+                config.resolveLabelOffsets();
             }
 
             return status;
@@ -482,12 +506,18 @@ namespace tidl
 
                     if (m_postProcCfg.taskType == "classification")
                     {
-                        m_postProcCfg.classnames = ti::common::gClassNameMap["imagenet"];
+                        const ti::common::ClassNameTable &table =
+                            ti::common::getClassNames(ti::common::CLASSNAMES_IMAGENET);
+                        m_postProcCfg.classnames = table.names;
+                        m_postProcCfg.numClassnames = table.count;
                         m_postProcCfg.topN = m_topN;
                     }
                     else
                     {
-                        m_postProcCfg.classnames = ti::common::gClassNameMap["coco"];
+                        const ti::common::ClassNameTable &table =
+                            ti::common::getClassNames(ti::common::CLASSNAMES_COCO);
+                        m_postProcCfg.classnames = table.names;
+                        m_postProcCfg.numClassnames = table.count;
                         m_postProcCfg.vizThreshold = m_vizThreshold;
                     }
                 }
@@ -506,6 +536,17 @@ namespace tidl
 
                 m_preProcCfg.modelName = modelName;
                 m_postProcCfg.modelName = modelName;
+
+                /* Map the labels once, the post-processing of every frame
+                only hands out views into the mapping. */
+                if (!m_labelsPath.empty())
+                {
+                    m_labels = tidl::utils::LabelStore::open(m_labelsPath);
+                    if (!m_labels)
+                    {
+                        LOG_WARN("Could not load labels from %s\n", m_labelsPath.c_str());
+                    }
+                }
             }
             m_infConfig.dumpInfo();
             m_preProcCfg.dumpInfo();
@@ -0,0 +1,619 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+/* Third-party headers. */
+#include "itidl_rt.h"
+
+/* Module headers. */
+#include "../include/onnx_inferer.h"
+
+namespace tidl
+{
+    namespace inferer
+    {
+        using namespace tidl::modelInfo;
+        using namespace tidl::utility_functs;
+        using tidl::utils::PooledBuffer;
+        using tidl::utils::SharedTensorPool;
+
+        static DlInferType toDlInferType(ONNXTensorElementDataType type)
+        {
+            switch (type)
+            {
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
+                return DlInferType_Int8;
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+                return DlInferType_UInt8;
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16:
+                return DlInferType_Int16;
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16:
+                return DlInferType_UInt16;
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+                return DlInferType_Int32;
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT32:
+                return DlInferType_UInt32;
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+                return DlInferType_Int64;
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+                return DlInferType_Float16;
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+                return DlInferType_Float32;
+            default:
+                return DlInferType_Invalid;
+            }
+        }
+
+        static ONNXTensorElementDataType toOnnxType(DlInferType type)
+        {
+            switch (type)
+            {
+            case DlInferType_Int8:
+                return ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8;
+            case DlInferType_UInt8:
+                return ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8;
+            case DlInferType_Int16:
+                return ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16;
+            case DlInferType_UInt16:
+                return ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16;
+            case DlInferType_Int32:
+                return ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32;
+            case DlInferType_UInt32:
+                return ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT32;
+            case DlInferType_Int64:
+                return ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64;
+            case DlInferType_Float16:
+                return ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+            case DlInferType_Float32:
+                return ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+            default:
+                return ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
+            }
+        }
+
+        static TensorInfo getTensorInfo(const std::string &name, const Ort::TypeInfo &typeInfo)
+        {
+            auto tensorInfo = typeInfo.GetTensorTypeAndShapeInfo();
+            TensorInfo info;
+            info.name = name;
+            info.type = toDlInferType(tensorInfo.GetElementType());
+            info.shape = tensorInfo.GetShape();
+            return info;
+        }
+
+        /* alignment of the preallocated output buffers */
+        static const size_t OUTPUT_ALIGNMENT = 64;
+
+        /**
+         * FNV-1a hash of a string of bytes, chained through hash.
+         */
+        static uint64_t hashBytes(const void *data, size_t size, uint64_t hash)
+        {
+            const uint8_t *bytes = static_cast<const uint8_t *>(data);
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        /**
+         * Builds the path of the optimized model cached for a model file and
+         * the options its session is created with. The key covers the model
+         * path, size and modification time, the ONNX Runtime version and
+         * everything that changes the optimized graph: execution provider,
+         * artifacts and optimization level. The model contents are not read,
+         * so computing the key costs one stat() whatever the model size.
+         *
+         * @param cacheDir cache directory
+         * @param modelFile source ONNX model
+         * @param key execution provider and options
+         * @param path filled with the cache file path
+         * @returns RETURN_SUCCESS or RETURN_FAIL if the model can not be read
+         */
+        static int32_t getCachePath(const std::string &cacheDir, const std::string &modelFile,
+                                    const std::string &key, std::string *path)
+        {
+            struct stat st;
+            if (stat(modelFile.c_str(), &st) != 0)
+            {
+                LOG_ERROR("Could not open %s\n", modelFile.c_str());
+                return RETURN_FAIL;
+            }
+
+            char fileKey[64];
+            snprintf(fileKey, sizeof(fileKey), "|%lld|%lld.%09ld", (long long)st.st_size,
+                     (long long)st.st_mtim.tv_sec, (long)st.st_mtim.tv_nsec);
+            std::string options = modelFile + fileKey + "|" + key + "|" + OrtGetApiBase()->GetVersionString();
+            uint64_t hash = hashBytes(options.data(), options.size(), 14695981039346656037ULL);
+
+            size_t slash = modelFile.rfind('/');
+            std::string name = modelFile.substr(slash == std::string::npos ? 0 : slash + 1);
+            size_t dot = name.rfind('.');
+            if (dot != std::string::npos)
+                name.erase(dot);
+
+            char suffix[32];
+            snprintf(suffix, sizeof(suffix), "_%016llx.onnx", (unsigned long long)hash);
+            *path = cacheDir + "/" + name + suffix;
+            return RETURN_SUCCESS;
+        }
+
+        /**
+         * Reads the cold session creation time stored next to a cached
+         * model, -1 when there is none.
+         */
+        static double readColdStartMs(const std::string &cachePath)
+        {
+            double ms = -1;
+            FILE *fp = fopen((cachePath + ".ms").c_str(), "r");
+            if (fp != nullptr)
+            {
+                if (fscanf(fp, "%lf", &ms) != 1)
+                    ms = -1;
+                fclose(fp);
+            }
+            return ms;
+        }
+
+        /**
+         * Stores the cold session creation time next to a cached model.
+         */
+        static void writeColdStartMs(const std::string &cachePath, double ms)
+        {
+            FILE *fp = fopen((cachePath + ".ms").c_str(), "w");
+            if (fp != nullptr)
+            {
+                fprintf(fp, "%f\n", ms);
+                fclose(fp);
+            }
+        }
+
+        OnnxInferer::OnnxInferer() : m_env(ORT_LOGGING_LEVEL_WARNING, "test"),
+                                     m_memoryInfo(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)),
+                                     m_dynamicOutputs(false)
+        {
+            memset(&m_tidlOptions, 0, sizeof(m_tidlOptions));
+        }
+
+        OnnxInferer::~OnnxInferer()
+        {
+            /* values reference the session, release them first */
+            m_inputValues.clear();
+            m_outputValues.clear();
+            m_binding.reset();
+            m_session.reset();
+            m_outputBuffers.clear();
+        }
+
+        /**
+         * Binds every output of the session. Outputs with a static shape get
+         * a buffer sized from the session metadata, the others are left to
+         * ONNX Runtime to allocate on the CPU.
+         *
+         * @param sharedMem allocate the buffers in memory shared with the
+         *        accelerator
+         * @returns RETURN_SUCCESS or RETURN_FAIL
+         */
+        int32_t OnnxInferer::bindOutputs(bool sharedMem)
+        {
+            m_dynamicOutputs = false;
+            m_outputValues.clear();
+            m_outputBuffers.clear();
+            m_outputs.clear();
+            for (size_t i = 0; i < m_io.outputs.size(); i++)
+            {
+                const TensorInfo &info = m_io.outputs[i];
+                bool dynamic = false;
+                for (int64_t dim : info.shape)
+                {
+                    if (dim < 0)
+                        dynamic = true;
+                }
+                ONNXTensorElementDataType type = toOnnxType(info.type);
+                if (dynamic || type == ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED)
+                {
+                    LOG_INFO("output %s is allocated by the runtime\n", info.name.c_str());
+                    m_binding->BindOutput(m_outputNamePtrs[i], m_memoryInfo);
+                    m_dynamicOutputs = true;
+                    continue;
+                }
+
+                size_t size = info.getSizeBytes();
+                PooledBuffer pooled = SharedTensorPool::get().acquire(size, OUTPUT_ALIGNMENT, sharedMem);
+                if (!pooled)
+                {
+                    LOG_ERROR("Could not allocate memory for output %s\n", info.name.c_str());
+                    return RETURN_FAIL;
+                }
+                void *buffer = pooled.data();
+                m_outputBuffers.push_back(std::move(pooled));
+                m_outputValues.push_back(Ort::Value::CreateTensor(m_memoryInfo, buffer, size,
+                                                                  info.shape.data(), info.shape.size(), type));
+                m_binding->BindOutput(m_outputNamePtrs[i], m_outputValues.back());
+
+                TensorView view;
+                view.data = buffer;
+                view.type = info.type;
+                view.shape = info.shape;
+                m_outputs.push_back(view);
+            }
+            if (m_dynamicOutputs)
+            {
+                /* views are taken from the bound values after every run */
+                m_outputValues.clear();
+                m_outputs.clear();
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int32_t OnnxInferer::load(const InfererConfig &config,
+                                  const InfererOptions &options)
+        {
+            const std::string &artifactsPath = options.artifactsPath.empty() ? config.artifactsPath : options.artifactsPath;
+
+            /* Initialize session options, the command line overrides
+            param.yaml */
+            Ort::SessionOptions sessionOptions;
+            int32_t intraOpThreads = options.intraOpThreads != -1 ? options.intraOpThreads
+                                   : config.intraOpThreads != -1  ? config.intraOpThreads
+                                   : options.numThreads != -1     ? options.numThreads
+                                                                  : 1;
+            int32_t interOpThreads = options.interOpThreads != -1 ? options.interOpThreads : config.interOpThreads;
+            const std::string &executionMode = !options.executionMode.empty() ? options.executionMode : config.executionMode;
+            int32_t allowSpinning = options.allowSpinning != -1 ? options.allowSpinning : config.allowSpinning;
+
+            sessionOptions.SetIntraOpNumThreads(intraOpThreads);
+            if (interOpThreads != -1)
+            {
+                sessionOptions.SetInterOpNumThreads(interOpThreads);
+            }
+            if (executionMode == "parallel")
+            {
+                sessionOptions.SetExecutionMode(ExecutionMode::ORT_PARALLEL);
+            }
+            else if (executionMode.empty() || executionMode == "sequential")
+            {
+                sessionOptions.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+            }
+            else
+            {
+                LOG_ERROR("unknown execution mode %s\n", executionMode.c_str());
+                return RETURN_FAIL;
+            }
+            if (allowSpinning != -1)
+            {
+                const char *spin = allowSpinning ? "1" : "0";
+                sessionOptions.AddConfigEntry("session.intra_op.allow_spinning", spin);
+                sessionOptions.AddConfigEntry("session.inter_op.allow_spinning", spin);
+            }
+            LOG_INFO("threads: intra-op %d, inter-op %d, %s, spinning %d\n", intraOpThreads, interOpThreads,
+                     executionMode.empty() ? "sequential" : executionMode.c_str(), allowSpinning);
+
+            /* the session thread pools are created with the session and
+            inherit the affinity of this thread, which gets its own
+            affinity back once the session is created */
+            ScopedThreadAffinity affinity;
+            if (!options.cpuAffinity.empty() && RETURN_FAIL == affinity.set(options.cpuAffinity))
+            {
+                LOG_ERROR("Could not set the cpu affinity\n");
+                return RETURN_FAIL;
+            }
+            if (options.accel)
+            {
+                LOG_INFO("accelerated mode\n");
+                LOG_INFO("artifacts: %s\n", artifactsPath.c_str());
+                if (artifactsPath.size() >= sizeof(m_tidlOptions.artifacts_folder))
+                {
+                    LOG_ERROR("artifacts path too long: %s\n", artifactsPath.c_str());
+                    return RETURN_FAIL;
+                }
+                strcpy(m_tidlOptions.artifacts_folder, artifactsPath.c_str());
+                m_tidlOptions.debug_level = 0;
+                OrtSessionOptionsAppendExecutionProvider_Tidl(sessionOptions, &m_tidlOptions);
+            }
+            else
+            {
+                OrtSessionOptionsAppendExecutionProvider_CPU(sessionOptions, false);
+            }
+            const GraphOptimizationLevel optLevel = GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+
+            /* the cache lookup is timed with the session creation so that
+            the time saved by the cache accounts for it */
+            struct timeval startTime, stopTime;
+            gettimeofday(&startTime, nullptr);
+
+            /* a cached model was optimized already, it is loaded as is */
+            std::string cachePath;
+            std::string cacheTmpPath;
+            bool cacheHit = false;
+            if (!options.modelCacheDir.empty())
+            {
+                char key[64];
+                snprintf(key, sizeof(key), "|%d|%d", optLevel, m_tidlOptions.debug_level);
+                std::string ep = options.accel ? "tidl|" + artifactsPath : "cpu";
+                if (RETURN_FAIL == getCachePath(options.modelCacheDir, config.modelFile, ep + key, &cachePath))
+                    return RETURN_FAIL;
+                cacheHit = access(cachePath.c_str(), R_OK) == 0;
+            }
+            std::string modelPath = config.modelFile;
+            if (cacheHit)
+            {
+                LOG_INFO("loading optimized model %s\n", cachePath.c_str());
+                modelPath = cachePath;
+                sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+            }
+            else
+            {
+                sessionOptions.SetGraphOptimizationLevel(optLevel);
+                if (!cachePath.empty())
+                {
+                    /* written aside and renamed once complete, so that a
+                    concurrent or interrupted run never loads half a model */
+                    cacheTmpPath = cachePath + "." + std::to_string(getpid());
+                    sessionOptions.SetOptimizedModelFilePath(cacheTmpPath.c_str());
+                }
+            }
+
+            try
+            {
+                m_session.reset(new Ort::Session(m_env, modelPath.c_str(), sessionOptions));
+            }
+            catch (const Ort::Exception &e)
+            {
+                if (cacheTmpPath.empty())
+                {
+                    LOG_ERROR("Failed to load %s: %s\n", modelPath.c_str(), e.what());
+                    return RETURN_FAIL;
+                }
+                /* graphs with nodes compiled by an execution provider can
+                not be serialized, build the session without the cache */
+                LOG_WARN("Could not cache the optimized model: %s\n", e.what());
+                unlink(cacheTmpPath.c_str());
+                cacheTmpPath.clear();
+                sessionOptions.SetOptimizedModelFilePath("");
+                try
+                {
+                    m_session.reset(new Ort::Session(m_env, modelPath.c_str(), sessionOptions));
+                }
+                catch (const Ort::Exception &e)
+                {
+                    LOG_ERROR("Failed to load %s: %s\n", modelPath.c_str(), e.what());
+                    return RETURN_FAIL;
+                }
+            }
+            gettimeofday(&stopTime, nullptr);
+            double startMs = (getUs(stopTime) - getUs(startTime)) / 1000;
+
+            if (cacheHit)
+            {
+                double coldMs = readColdStartMs(cachePath);
+                if (coldMs >= 0)
+                    LOG_INFO("session created in %f ms from the cache, %f ms saved\n", startMs, coldMs - startMs);
+                else
+                    LOG_INFO("session created in %f ms from the cache\n", startMs);
+            }
+            else
+            {
+                LOG_INFO("session created in %f ms\n", startMs);
+                if (!cacheTmpPath.empty())
+                {
+                    if (rename(cacheTmpPath.c_str(), cachePath.c_str()) == 0)
+                    {
+                        writeColdStartMs(cachePath, startMs);
+                        LOG_INFO("optimized model cached as %s\n", cachePath.c_str());
+                    }
+                    else
+                    {
+                        LOG_WARN("Could not write %s\n", cachePath.c_str());
+                        unlink(cacheTmpPath.c_str());
+                    }
+                }
+            }
+            LOG_INFO("Loaded model %s\n", config.modelFile.c_str());
+
+            size_t numInputs = m_session->GetInputCount();
+            size_t numOutputs = m_session->GetOutputCount();
+            m_io.inputs.clear();
+            m_io.outputs.clear();
+            m_inputNames.clear();
+            m_outputNames.clear();
+            for (size_t i = 0; i < numInputs; i++)
+            {
+                char *name = m_session->GetInputName(i, m_allocator);
+                m_inputNames.push_back(name);
+                m_allocator.Free(name);
+                m_io.inputs.push_back(getTensorInfo(m_inputNames.back(), m_session->GetInputTypeInfo(i)));
+            }
+            for (size_t i = 0; i < numOutputs; i++)
+            {
+                char *name = m_session->GetOutputName(i, m_allocator);
+                m_outputNames.push_back(name);
+                m_allocator.Free(name);
+                m_io.outputs.push_back(getTensorInfo(m_outputNames.back(), m_session->GetOutputTypeInfo(i)));
+            }
+
+            /* the name pointers are handed to every Run() */
+            m_inputNamePtrs.clear();
+            m_outputNamePtrs.clear();
+            for (const std::string &name : m_inputNames)
+            {
+                m_inputNamePtrs.push_back(name.c_str());
+            }
+            for (const std::string &name : m_outputNames)
+            {
+                m_outputNamePtrs.push_back(name.c_str());
+            }
+
+            m_inputValues.clear();
+            for (size_t i = 0; i < numInputs; i++)
+            {
+                m_inputValues.emplace_back(nullptr);
+            }
+            m_runOptions.SetRunLogVerbosityLevel(2);
+
+            if (options.ioBinding)
+            {
+                LOG_INFO("binding inputs and outputs\n");
+                m_binding.reset(new Ort::IoBinding(*m_session));
+                m_boundInputs.assign(numInputs, TensorView());
+                try
+                {
+                    if (RETURN_FAIL == bindOutputs(options.deviceMem || options.accel))
+                        return RETURN_FAIL;
+                }
+                catch (const Ort::Exception &e)
+                {
+                    LOG_ERROR("Failed to bind outputs: %s\n", e.what());
+                    return RETURN_FAIL;
+                }
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int32_t OnnxInferer::bindInput(int32_t index, const TensorView &view)
+        {
+            if (index < 0 || index >= static_cast<int32_t>(m_inputValues.size()))
+            {
+                LOG_ERROR("invalid input index %d\n", index);
+                return RETURN_FAIL;
+            }
+            ONNXTensorElementDataType type = toOnnxType(view.type);
+            if (type == ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED)
+            {
+                LOG_ERROR("in data type not supported\n");
+                return RETURN_FAIL;
+            }
+            if (m_binding)
+            {
+                /* the same buffer is usually bound for every input, it only
+                needs binding once */
+                const TensorView &bound = m_boundInputs[index];
+                if (bound.data == view.data && bound.type == view.type && bound.shape == view.shape)
+                    return RETURN_SUCCESS;
+            }
+
+            /* the tensor wraps the caller's memory, nothing is copied */
+            m_inputValues[index] = Ort::Value::CreateTensor(m_memoryInfo, view.data, view.getSizeBytes(),
+                                                            view.shape.data(), view.shape.size(), type);
+            if (m_binding)
+            {
+                try
+                {
+                    m_binding->BindInput(m_inputNamePtrs[index], m_inputValues[index]);
+                }
+                catch (const Ort::Exception &e)
+                {
+                    LOG_ERROR("Failed to bind input %d: %s\n", index, e.what());
+                    return RETURN_FAIL;
+                }
+                m_boundInputs[index] = view;
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int32_t OnnxInferer::run()
+        {
+            try
+            {
+                if (m_binding)
+                {
+                    m_session->Run(m_runOptions, *m_binding);
+                    /* preallocated outputs keep the views set at load time */
+                    if (!m_dynamicOutputs)
+                        return RETURN_SUCCESS;
+                    m_outputValues = m_binding->GetOutputValues();
+                }
+                else
+                {
+                    m_outputValues = m_session->Run(m_runOptions,
+                                                    m_inputNamePtrs.data(), m_inputValues.data(), m_inputValues.size(),
+                                                    m_outputNamePtrs.data(), m_outputNamePtrs.size());
+                }
+            }
+            catch (const Ort::Exception &e)
+            {
+                LOG_ERROR("Session.Run() failed: %s\n", e.what());
+                return RETURN_FAIL;
+            }
+
+            m_outputs.resize(m_outputValues.size());
+            for (size_t i = 0; i < m_outputValues.size(); i++)
+            {
+                auto tensorInfo = m_outputValues[i].GetTensorTypeAndShapeInfo();
+                m_outputs[i].data = m_outputValues[i].GetTensorMutableData<void>();
+                m_outputs[i].type = toDlInferType(tensorInfo.GetElementType());
+                m_outputs[i].shape = tensorInfo.GetShape();
+            }
+            return RETURN_SUCCESS;
+        }
+
+    } // namespace tidl::inferer
+}
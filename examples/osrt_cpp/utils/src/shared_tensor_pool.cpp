@@ -0,0 +1,262 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+/* Third-party headers. */
+#include "itidl_rt.h"
+
+/* Module headers. */
+#include "../include/shared_tensor_pool.h"
+#include "../include/ti_logger.h"
+
+namespace tidl
+{
+    namespace utils
+    {
+        typedef decltype(&TIDLRT_allocSharedMem) TidlAllocFn;
+        typedef decltype(&TIDLRT_freeSharedMem) TidlFreeFn;
+
+        /* sizes are rounded to a power of two up to this one, to a multiple
+        of it above */
+        static const size_t LARGE_CLASS = 64 * 1024;
+
+        /* buffers from this size on are aligned for and advised to use
+        transparent huge pages */
+        static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+        /**
+         * Rounds a request up to its size class.
+         *
+         * @param size requested size in bytes
+         * @returns size class in bytes
+         */
+        static size_t getSizeClass(size_t size)
+        {
+            if (size > LARGE_CLASS)
+                return (size + LARGE_CLASS - 1) / LARGE_CLASS * LARGE_CLASS;
+            size_t sizeClass = SharedTensorPool::MIN_ALIGNMENT;
+            while (sizeClass < size)
+                sizeClass *= 2;
+            return sizeClass;
+        }
+
+        const size_t SharedTensorPool::MIN_ALIGNMENT;
+
+        PooledBuffer &PooledBuffer::operator=(PooledBuffer &&other)
+        {
+            if (this != &other)
+            {
+                reset();
+                m_pool = other.m_pool;
+                m_data = other.m_data;
+                m_size = other.m_size;
+                m_shared = other.m_shared;
+                other.m_pool = nullptr;
+                other.m_data = nullptr;
+                other.m_size = 0;
+            }
+            return *this;
+        }
+
+        void PooledBuffer::reset()
+        {
+            if (m_pool != nullptr && m_data != nullptr)
+                m_pool->release(this);
+            m_pool = nullptr;
+            m_data = nullptr;
+            m_size = 0;
+            m_shared = false;
+        }
+
+        SharedTensorPool &SharedTensorPool::get()
+        {
+            static SharedTensorPool pool;
+            return pool;
+        }
+
+        SharedTensorPool::SharedTensorPool() : m_stats{0, 0, 0}
+        {
+            /* weak lookup, so that the pool also works in a process that
+            does not load TIDL-RT */
+            m_tidlAlloc = dlsym(RTLD_DEFAULT, "TIDLRT_allocSharedMem");
+            m_tidlFree = dlsym(RTLD_DEFAULT, "TIDLRT_freeSharedMem");
+            if (m_tidlAlloc == nullptr || m_tidlFree == nullptr)
+            {
+                LOG_INFO("TIDL-RT not found, shared tensors use host memory\n");
+                m_tidlAlloc = nullptr;
+                m_tidlFree = nullptr;
+            }
+        }
+
+        SharedTensorPool::~SharedTensorPool()
+        {
+            /* buffers still taken belong to their handles */
+            trim();
+        }
+
+        void *SharedTensorPool::allocate(size_t size, size_t alignment, bool shared, bool *tidl)
+        {
+            *tidl = shared && m_tidlAlloc != nullptr;
+            if (*tidl)
+                return reinterpret_cast<TidlAllocFn>(m_tidlAlloc)(alignment, size);
+
+            void *data = nullptr;
+            bool huge = size >= HUGE_PAGE_SIZE;
+            if (posix_memalign(&data, huge ? HUGE_PAGE_SIZE : alignment, size) != 0)
+                return nullptr;
+#ifdef MADV_HUGEPAGE
+            if (huge)
+                madvise(data, size, MADV_HUGEPAGE);
+#endif
+            return data;
+        }
+
+        void SharedTensorPool::deallocate(const Block &block)
+        {
+            if (block.tidl)
+                reinterpret_cast<TidlFreeFn>(m_tidlFree)(block.data);
+            else
+                free(block.data);
+        }
+
+        PooledBuffer SharedTensorPool::acquire(size_t size, size_t alignment, bool shared)
+        {
+            PooledBuffer buffer;
+            if (alignment < MIN_ALIGNMENT)
+                alignment = MIN_ALIGNMENT;
+            if ((alignment & (alignment - 1)) != 0)
+            {
+                LOG_ERROR("alignment %zu is not a power of two\n", alignment);
+                return buffer;
+            }
+            size_t sizeClass = getSizeClass(size);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.acquired++;
+            Block block{nullptr, alignment, false};
+            std::vector<Block> &freeList = m_free[Key(shared, sizeClass)];
+            for (size_t i = 0; i < freeList.size(); i++)
+            {
+                if (freeList[i].alignment >= alignment)
+                {
+                    block = freeList[i];
+                    freeList[i] = freeList.back();
+                    freeList.pop_back();
+                    m_stats.reused++;
+                    break;
+                }
+            }
+            if (block.data == nullptr)
+            {
+                block.data = allocate(sizeClass, alignment, shared, &block.tidl);
+                if (block.data == nullptr)
+                {
+                    LOG_ERROR("Could not allocate %zu bytes\n", sizeClass);
+                    return buffer;
+                }
+                m_stats.bytes += sizeClass;
+            }
+            m_taken[block.data] = block;
+
+            buffer.m_pool = this;
+            buffer.m_data = block.data;
+            buffer.m_size = sizeClass;
+            buffer.m_shared = shared;
+            return buffer;
+        }
+
+        void SharedTensorPool::release(PooledBuffer *buffer)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto taken = m_taken.find(buffer->m_data);
+            if (taken == m_taken.end())
+                return;
+            m_free[Key(buffer->m_shared, buffer->m_size)].push_back(taken->second);
+            m_taken.erase(taken);
+        }
+
+        void SharedTensorPool::trim()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto &freeList : m_free)
+            {
+                for (const Block &block : freeList.second)
+                {
+                    deallocate(block);
+                    m_stats.bytes -= freeList.first.second;
+                }
+            }
+            m_free.clear();
+        }
+
+        SharedTensorPool::Stats SharedTensorPool::getStats() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_stats;
+        }
+
+    } // namespace utils
+} // namespace tidl
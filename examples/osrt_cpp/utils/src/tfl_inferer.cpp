@@ -0,0 +1,506 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <dlfcn.h>
+#include <string.h>
+#include <map>
+
+/* Third-party headers. */
+#include <tensorflow/lite/builtin_ops.h>
+#include <tensorflow/lite/schema/schema_generated.h>
+#ifdef TFL_ENABLE_XNNPACK
+#include <tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h>
+#endif
+#include "itidl_rt.h"
+
+/* Module headers. */
+#include "../include/tfl_inferer.h"
+
+namespace tidl
+{
+    namespace inferer
+    {
+        using namespace tidl::modelInfo;
+        using tidl::utils::PooledBuffer;
+        using tidl::utils::SharedTensorPool;
+
+        typedef TfLiteDelegate *(*tflite_plugin_create_delegate)(char **, char **, size_t, void (*report_error)(const char *));
+        typedef void (*tflite_plugin_destroy_delegate)(TfLiteDelegate *);
+
+        static DlInferType toDlInferType(TfLiteType type)
+        {
+            switch (type)
+            {
+            case kTfLiteInt8:
+                return DlInferType_Int8;
+            case kTfLiteUInt8:
+                return DlInferType_UInt8;
+            case kTfLiteInt16:
+                return DlInferType_Int16;
+            case kTfLiteInt32:
+                return DlInferType_Int32;
+            case kTfLiteInt64:
+                return DlInferType_Int64;
+            case kTfLiteFloat16:
+                return DlInferType_Float16;
+            case kTfLiteFloat32:
+                return DlInferType_Float32;
+            default:
+                return DlInferType_Invalid;
+            }
+        }
+
+        static std::vector<int64_t> getShape(const TfLiteIntArray *dims)
+        {
+            return std::vector<int64_t>(dims->data, dims->data + dims->size);
+        }
+
+        TfliteInferer::TfliteInferer() : m_delegateLib(nullptr),
+                                         m_delegate(nullptr),
+                                         m_xnnpackDelegate(nullptr)
+        {
+        }
+
+        TfliteInferer::~TfliteInferer()
+        {
+            /* the interpreter uses the delegate and the shared memory */
+            m_interpreter.reset();
+            if (m_delegate != nullptr)
+            {
+                tflite_plugin_destroy_delegate destroy =
+                    (tflite_plugin_destroy_delegate)dlsym(m_delegateLib, "tflite_plugin_destroy_delegate");
+                if (destroy != nullptr)
+                {
+                    destroy(m_delegate);
+                }
+            }
+#ifdef TFL_ENABLE_XNNPACK
+            if (m_xnnpackDelegate != nullptr)
+            {
+                TfLiteXNNPackDelegateDelete(m_xnnpackDelegate);
+            }
+#endif
+            m_sharedMem.clear();
+        }
+
+        TensorInfo TfliteInferer::getTensorInfo(int32_t tensorIndex)
+        {
+            const TfLiteTensor *tensor = m_interpreter->tensor(tensorIndex);
+            TensorInfo info;
+            info.name = tensor->name ? tensor->name : "";
+            info.type = toDlInferType(tensor->type);
+            info.shape = getShape(tensor->dims);
+            return info;
+        }
+
+        int32_t TfliteInferer::createTidlDelegate(const std::string &artifactsPath)
+        {
+            /* This part creates the dlg_ptr */
+            LOG_INFO("accelerated mode\n");
+            char *keys[] = {(char *)"artifacts_folder", (char *)"num_tidl_subgraphs", (char *)"debug_level"};
+            char *values[] = {(char *)artifactsPath.c_str(), (char *)"16", (char *)"0"};
+            m_delegateLib = dlopen("libtidl_tfl_delegate.so", RTLD_NOW);
+            if (m_delegateLib == nullptr)
+            {
+                LOG_ERROR("Failed to open libtidl_tfl_delegate.so: %s\n", dlerror());
+                return RETURN_FAIL;
+            }
+            tflite_plugin_create_delegate create =
+                (tflite_plugin_create_delegate)dlsym(m_delegateLib, "tflite_plugin_create_delegate");
+            if (create == nullptr)
+            {
+                LOG_ERROR("tflite_plugin_create_delegate not found\n");
+                return RETURN_FAIL;
+            }
+            m_delegate = create(keys, values, 3, NULL);
+            if (m_interpreter->ModifyGraphWithDelegate(m_delegate) != kTfLiteOk)
+            {
+                LOG_ERROR("ModifyGraphWithDelegate failed\n");
+                return RETURN_FAIL;
+            }
+            LOG_INFO("ModifyGraphWithDelegate - Done \n");
+            return RETURN_SUCCESS;
+        }
+
+        int32_t TfliteInferer::createXnnpackDelegate(int32_t numThreads)
+        {
+#ifdef TFL_ENABLE_XNNPACK
+            LOG_INFO("XNNPACK delegate\n");
+            TfLiteXNNPackDelegateOptions xnnpackOptions = TfLiteXNNPackDelegateOptionsDefault();
+            if (numThreads > 0)
+            {
+                xnnpackOptions.num_threads = numThreads;
+            }
+            m_xnnpackDelegate = TfLiteXNNPackDelegateCreate(&xnnpackOptions);
+            if (m_xnnpackDelegate == nullptr)
+            {
+                LOG_ERROR("Failed to create the XNNPACK delegate\n");
+                return RETURN_FAIL;
+            }
+            if (m_interpreter->ModifyGraphWithDelegate(m_xnnpackDelegate) != kTfLiteOk)
+            {
+                LOG_ERROR("ModifyGraphWithDelegate failed for XNNPACK\n");
+                return RETURN_FAIL;
+            }
+            return RETURN_SUCCESS;
+#else
+            LOG_ERROR("built without XNNPACK, configure with -DTFL_ENABLE_XNNPACK=ON\n");
+            return RETURN_FAIL;
+#endif
+        }
+
+        /**
+         * Logs how many of the model nodes each delegate claimed and which
+         * operators are left to the TFLite reference kernels.
+         *
+         * @param numNodes number of nodes before delegation
+         */
+        void TfliteInferer::reportDelegation(size_t numNodes)
+        {
+            struct Claim
+            {
+                const char *name;
+                const TfLiteDelegate *delegate;
+                int32_t partitions;
+                int32_t nodes;
+            };
+            Claim claims[] = {{"TIDL", m_delegate, 0, 0}, {"XNNPACK", m_xnnpackDelegate, 0, 0}};
+            std::map<std::string, int32_t> cpuOps;
+            int32_t cpuNodes = 0;
+
+            for (int nodeIndex : m_interpreter->execution_plan())
+            {
+                const std::pair<TfLiteNode, TfLiteRegistration> *nodeAndReg =
+                    m_interpreter->node_and_registration(nodeIndex);
+                const TfLiteNode &node = nodeAndReg->first;
+                const TfLiteRegistration &reg = nodeAndReg->second;
+                if (node.delegate != nullptr && reg.builtin_code == kTfLiteBuiltinDelegate)
+                {
+                    /* a delegate kernel stands for the nodes listed in its
+                    parameters */
+                    const TfLiteDelegateParams *params = static_cast<const TfLiteDelegateParams *>(node.builtin_data);
+                    for (Claim &claim : claims)
+                    {
+                        if (claim.delegate == node.delegate)
+                        {
+                            claim.partitions++;
+                            claim.nodes += params ? params->nodes_to_replace->size : 0;
+                        }
+                    }
+                    continue;
+                }
+                cpuNodes++;
+                if (reg.builtin_code == kTfLiteBuiltinCustom && reg.custom_name != nullptr)
+                    cpuOps[reg.custom_name]++;
+                else
+                    cpuOps[tflite::EnumNameBuiltinOperator((tflite::BuiltinOperator)reg.builtin_code)]++;
+            }
+
+            for (const Claim &claim : claims)
+            {
+                if (claim.delegate != nullptr)
+                {
+                    LOG_INFO("%s delegate: %d of %d nodes in %d partitions\n", claim.name,
+                             claim.nodes, (int32_t)numNodes, claim.partitions);
+                }
+            }
+            LOG_INFO("reference kernels: %d of %d nodes\n", cpuNodes, (int32_t)numNodes);
+            for (const auto &op : cpuOps)
+            {
+                LOG_INFO("    %s x%d\n", op.first.c_str(), op.second);
+            }
+        }
+
+        int32_t TfliteInferer::load(const InfererConfig &config,
+                                    const InfererOptions &options)
+        {
+            /* preparing tflite model  from file*/
+            m_model = tflite::FlatBufferModel::BuildFromFile(config.modelFile.c_str());
+            if (!m_model)
+            {
+                LOG_ERROR("\nFailed to mmap model %s\n", config.modelFile.c_str());
+                return RETURN_FAIL;
+            }
+            LOG_INFO("Loaded model %s \n", config.modelFile.c_str());
+            return createInterpreter(config, options);
+        }
+
+        std::unique_ptr<Inferer> TfliteInferer::createWorker(const InfererConfig &config,
+                                                             const InfererOptions &options)
+        {
+            std::unique_ptr<TfliteInferer> worker(new TfliteInferer());
+            worker->m_model = m_model;
+            if (worker->createInterpreter(config, options) == RETURN_FAIL)
+            {
+                return nullptr;
+            }
+            return std::unique_ptr<Inferer>(worker.release());
+        }
+
+        /**
+         * Builds the interpreter on m_model, applies the delegates and
+         * allocates the tensors.
+         *
+         * @param config inferer configuration
+         * @param options runtime options
+         * @returns RETURN_SUCCESS or RETURN_FAIL
+         */
+        int32_t TfliteInferer::createInterpreter(const InfererConfig &config,
+                                                 const InfererOptions &options)
+        {
+            tflite::ops::builtin::BuiltinOpResolver resolver;
+            tflite::InterpreterBuilder(*m_model, resolver)(&m_interpreter);
+            if (!m_interpreter)
+            {
+                LOG_ERROR("Failed to construct interpreter\n");
+                return RETURN_FAIL;
+            }
+            LOG_INFO("tensors size: %d \n", (int32_t)m_interpreter->tensors_size());
+            LOG_INFO("nodes size: %d\n", (int32_t)m_interpreter->nodes_size());
+
+            if (options.logLevel <= tidl::utils::DEBUG)
+            {
+                int t_size = m_interpreter->tensors_size();
+                for (int i = 0; i < t_size; i++)
+                {
+                    if (m_interpreter->tensor(i)->name)
+                        LOG_INFO("%d: %s,%d,%d,%f,%d\n", i, m_interpreter->tensor(i)->name,
+                                 (int32_t)m_interpreter->tensor(i)->bytes,
+                                 m_interpreter->tensor(i)->type,
+                                 m_interpreter->tensor(i)->params.scale,
+                                 m_interpreter->tensor(i)->params.zero_point);
+                }
+            }
+
+            if (options.numThreads != -1)
+            {
+                m_interpreter->SetNumThreads(options.numThreads);
+            }
+
+            /* TIDL claims the nodes it supports first, XNNPACK then takes
+            what it can of the remainder */
+            size_t numNodes = m_interpreter->execution_plan().size();
+            if (options.accel)
+            {
+                const std::string &artifactsPath = options.artifactsPath.empty() ? config.artifactsPath : options.artifactsPath;
+                if (createTidlDelegate(artifactsPath) == RETURN_FAIL)
+                {
+                    return RETURN_FAIL;
+                }
+            }
+            if (options.xnnpack && createXnnpackDelegate(options.numThreads) == RETURN_FAIL)
+            {
+                return RETURN_FAIL;
+            }
+            reportDelegation(numNodes);
+
+            if (m_interpreter->AllocateTensors() != kTfLiteOk)
+            {
+                LOG_ERROR("Failed to allocate tensors!");
+                return RETURN_FAIL;
+            }
+
+            const std::vector<int> &inputs = m_interpreter->inputs();
+            const std::vector<int> &outputs = m_interpreter->outputs();
+            if (options.deviceMem)
+            {
+                LOG_INFO("device mem enabled\n");
+                std::vector<int> tensors(inputs);
+                tensors.insert(tensors.end(), outputs.begin(), outputs.end());
+                for (int tensorIndex : tensors)
+                {
+                    const TfLiteTensor *tensor = m_interpreter->tensor(tensorIndex);
+                    PooledBuffer buffer = SharedTensorPool::get().acquire(tensor->bytes, tflite::kDefaultTensorAlignment, true);
+                    if (!buffer)
+                    {
+                        LOG_INFO("Could not allocate Memory for tensor: %s\n", tensor->name);
+                        continue;
+                    }
+                    m_interpreter->SetCustomAllocationForTensor(tensorIndex, {buffer.data(), tensor->bytes});
+                    m_sharedMem.push_back(std::move(buffer));
+                }
+                /* custom allocations take effect on the next allocation */
+                if (!m_sharedMem.empty() && m_interpreter->AllocateTensors() != kTfLiteOk)
+                {
+                    LOG_ERROR("Failed to allocate tensors!");
+                    return RETURN_FAIL;
+                }
+            }
+
+            if (options.logLevel <= tidl::utils::DEBUG)
+                tflite::PrintInterpreterState(m_interpreter.get());
+
+            describeTensors();
+            return RETURN_SUCCESS;
+        }
+
+        /**
+         * Fills the IO description from the interpreter tensors.
+         */
+        void TfliteInferer::describeTensors()
+        {
+            m_io.inputs.clear();
+            m_io.outputs.clear();
+            for (int tensorIndex : m_interpreter->inputs())
+            {
+                m_io.inputs.push_back(getTensorInfo(tensorIndex));
+            }
+            for (int tensorIndex : m_interpreter->outputs())
+            {
+                m_io.outputs.push_back(getTensorInfo(tensorIndex));
+            }
+        }
+
+        int32_t TfliteInferer::setBatchSize(int32_t batch)
+        {
+            if (batch < 1)
+            {
+                LOG_ERROR("invalid batch size %d\n", batch);
+                return RETURN_FAIL;
+            }
+            if (!m_sharedMem.empty())
+            {
+                LOG_ERROR("the batch size can not change with device_mem\n");
+                return RETURN_FAIL;
+            }
+            bool resized = false;
+            for (int tensorIndex : m_interpreter->inputs())
+            {
+                const TfLiteIntArray *dims = m_interpreter->tensor(tensorIndex)->dims;
+                if (dims->size == 0 || dims->data[0] == batch)
+                    continue;
+                std::vector<int> shape(dims->data, dims->data + dims->size);
+                shape[0] = batch;
+                if (m_interpreter->ResizeInputTensor(tensorIndex, shape) != kTfLiteOk)
+                {
+                    LOG_ERROR("Failed to resize input %d to a batch of %d\n", tensorIndex, batch);
+                    return RETURN_FAIL;
+                }
+                resized = true;
+            }
+            /* delegates are prepared again for the new shapes, TIDL
+            artifacts compiled for another batch make this fail */
+            if (resized && m_interpreter->AllocateTensors() != kTfLiteOk)
+            {
+                LOG_ERROR("Failed to allocate tensors for a batch of %d\n", batch);
+                return RETURN_FAIL;
+            }
+            describeTensors();
+            return RETURN_SUCCESS;
+        }
+
+        TensorView TfliteInferer::getInput(int32_t index)
+        {
+            TensorView view = Inferer::getInput(index);
+            if (view.type != DlInferType_Invalid)
+            {
+                view.data = m_interpreter->input_tensor(index)->data.data;
+            }
+            return view;
+        }
+
+        int32_t TfliteInferer::bindInput(int32_t index, const TensorView &view)
+        {
+            if (index < 0 || index >= static_cast<int32_t>(m_io.inputs.size()))
+            {
+                LOG_ERROR("invalid input index %d\n", index);
+                return RETURN_FAIL;
+            }
+            TfLiteTensor *tensor = m_interpreter->input_tensor(index);
+            if (view.data == tensor->data.data)
+            {
+                /* filled in place through getInput() */
+                return RETURN_SUCCESS;
+            }
+            if (view.getSizeBytes() != tensor->bytes)
+            {
+                LOG_ERROR("input %d expects %d bytes, got %d\n", index,
+                          (int32_t)tensor->bytes, (int32_t)view.getSizeBytes());
+                return RETURN_FAIL;
+            }
+            memcpy(tensor->data.data, view.data, tensor->bytes);
+            return RETURN_SUCCESS;
+        }
+
+        int32_t TfliteInferer::run()
+        {
+            if (m_interpreter->Invoke() != kTfLiteOk)
+            {
+                LOG_ERROR("Failed to invoke tflite!\n");
+                return RETURN_FAIL;
+            }
+
+            const std::vector<int> &outputs = m_interpreter->outputs();
+            m_outputs.resize(outputs.size());
+            for (size_t i = 0; i < outputs.size(); i++)
+            {
+                const TfLiteTensor *tensor = m_interpreter->tensor(outputs[i]);
+                m_outputs[i].data = tensor->data.data;
+                m_outputs[i].type = toDlInferType(tensor->type);
+                m_outputs[i].shape = getShape(tensor->dims);
+            }
+            return RETURN_SUCCESS;
+        }
+
+    } // namespace tidl::inferer
+}
@@ -0,0 +1,426 @@
+/*
+Copyright (c) 2020 – 2021 Texas Instruments Incorporated
+
+All rights reserved not granted herein.
+
+Limited License.
+
+Texas Instruments Incorporated grants a world-wide, royalty-free, non-exclusive
+license under copyrights and patents it now or hereafter owns or controls to
+make, have made, use, import, offer to sell and sell ("Utilize") this software
+subject to the terms herein.  With respect to the foregoing patent license,
+such license is granted  solely to the extent that any such patent is necessary
+to Utilize the software alone.  The patent license shall not apply to any
+combinations which include this software, other than combinations with devices
+manufactured by or for TI (“TI Devices”).  No hardware patent is licensed
+hereunder.
+
+Redistributions must preserve existing copyright notices and reproduce this
+license (including the above copyright notice and the disclaimer and
+(if applicable) source code license limitations below) in the documentation
+and/or other materials provided with the distribution
+
+Redistribution and use in binary form, without modification, are permitted
+provided that the following conditions are met:
+
+*	No reverse engineering, decompilation, or disassembly of this software is
+    permitted with respect to any software provided in binary form.
+
+*	any redistribution and use are licensed by TI for use only with TI Devices.
+
+*	Nothing shall obligate TI to provide you with source code for the software
+    licensed and provided to you in object code.
+
+If software source code is provided to you, modification and redistribution of
+the source code are permitted provided that the following conditions are met:
+
+*	any redistribution and use of the source code, including any resulting
+    derivative works, are licensed by TI for use only with TI Devices.
+
+*	any redistribution and use of any object code compiled from the source code
+    and any resulting derivative works, are licensed by TI for use only with TI
+    Devices.
+
+Neither the name of Texas Instruments Incorporated nor the names of its
+suppliers may be used to endorse or promote products derived from this software
+without specific prior written permission.
+
+DISCLAIMER.
+
+THIS SOFTWARE IS PROVIDED BY TI AND TI’S LICENSORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+EVENT SHALL TI AND TI’S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/* Standard headers. */
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Third-party headers. */
+#include "itidl_ti.h"
+
+/* Module headers. */
+#include "../include/tidlrt_inferer.h"
+
+namespace tidl
+{
+    namespace inferer
+    {
+        using namespace tidl::modelInfo;
+        using tidl::utils::PooledBuffer;
+        using tidl::utils::SharedTensorPool;
+
+        /**
+         * Finds the first file of a directory, in name order, whose name
+         * ends with suffix.
+         *
+         * @param dir directory to look in
+         * @param suffix end of the file name, like net.bin
+         * @returns path of the file, empty if there is none
+         */
+        static std::string findArtifact(const std::string &dir, const char *suffix)
+        {
+            DIR *dp = opendir(dir.c_str());
+            if (dp == nullptr)
+            {
+                LOG_ERROR("Could not open directory %s\n", dir.c_str());
+                return std::string();
+            }
+            std::string found;
+            size_t suffixLength = strlen(suffix);
+            struct dirent *entry;
+            while ((entry = readdir(dp)) != nullptr)
+            {
+                std::string name(entry->d_name);
+                if (name.size() < suffixLength || name.compare(name.size() - suffixLength, suffixLength, suffix) != 0)
+                    continue;
+                if (found.empty() || name < found)
+                    found = name;
+            }
+            closedir(dp);
+            return found.empty() ? found : dir + "/" + found;
+        }
+
+        /**
+         * Maps a file copy on write, the runtime may patch the buffer but the
+         * file is left untouched.
+         *
+         * @param path file to map
+         * @param size filled with the size of the file
+         * @returns start of the mapping, nullptr on failure
+         */
+        static void *mapFile(const std::string &path, int32_t *size)
+        {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                LOG_ERROR("Could not open %s file for reading \n", path.c_str());
+                return nullptr;
+            }
+            struct stat st;
+            void *addr = nullptr;
+            if (fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                addr = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+                if (addr == MAP_FAILED)
+                    addr = nullptr;
+                *size = (int32_t)st.st_size;
+            }
+            close(fd);
+            return addr;
+        }
+
+        /**
+         * Converts a TIDL element type to the inferer one.
+         */
+        static DlInferType toDlInferType(int32_t elementType)
+        {
+            switch (elementType)
+            {
+            case TIDL_UnsignedChar:
+                return DlInferType_UInt8;
+            case TIDL_SignedChar:
+                return DlInferType_Int8;
+            case TIDL_UnsignedShort:
+                return DlInferType_UInt16;
+            case TIDL_SignedShort:
+                return DlInferType_Int16;
+            case TIDL_UnsignedWord:
+                return DlInferType_UInt32;
+            case TIDL_SignedWord:
+                return DlInferType_Int32;
+            case TIDL_SinglePrecFloat:
+                return DlInferType_Float32;
+            }
+            return DlInferType_Invalid;
+        }
+
+        /**
+         * Converts an inferer element type to the TIDL-RT one.
+         */
+        static int32_t toTidlrtType(DlInferType type)
+        {
+            switch (type)
+            {
+            case DlInferType_UInt8:
+                return TIDLRT_Uint8;
+            case DlInferType_Int8:
+                return TIDLRT_Int8;
+            case DlInferType_UInt16:
+                return TIDLRT_Uint16;
+            case DlInferType_Int16:
+                return TIDLRT_Int16;
+            case DlInferType_UInt32:
+                return TIDLRT_Uint32;
+            case DlInferType_Int32:
+                return TIDLRT_Int32;
+            default:
+                return TIDLRT_Float32;
+            }
+        }
+
+        /**
+         * Fills the inputs and outputs from the IO buffer descriptor. Inputs
+         * are images, given NHWC in the type the network was imported with.
+         * Outputs are requested as float NCHW, TIDL-RT dequantizes them.
+         *
+         * @param data IO buffer descriptor, the *io_1.bin file
+         * @param size size of data in bytes
+         * @param io filled with the inputs and outputs
+         * @returns RETURN_SUCCESS or RETURN_FAIL
+         */
+        static int32_t parseIODesc(const void *data, size_t size, Inferer::IODescription *io)
+        {
+            const sTIDL_IOBufDesc_t *desc = static_cast<const sTIDL_IOBufDesc_t *>(data);
+            if (size < sizeof(sTIDL_IOBufDesc_t) ||
+                desc->numInputBuf <= 0 || desc->numInputBuf > TIDL_MAX_ALG_IN_BUFS ||
+                desc->numOutputBuf <= 0 || desc->numOutputBuf > TIDL_MAX_ALG_OUT_BUFS)
+            {
+                LOG_ERROR("invalid IO buffer descriptor\n");
+                return RETURN_FAIL;
+            }
+
+            io->inputs.resize(desc->numInputBuf);
+            for (int32_t i = 0; i < desc->numInputBuf; i++)
+            {
+                TensorInfo &info = io->inputs[i];
+                info.name = reinterpret_cast<const char *>(desc->inDataName[i]);
+                info.type = toDlInferType(desc->inElementType[i]);
+                info.shape = {1, desc->inHeight[i], desc->inWidth[i], desc->inNumChannels[i]};
+            }
+            io->outputs.resize(desc->numOutputBuf);
+            for (int32_t i = 0; i < desc->numOutputBuf; i++)
+            {
+                TensorInfo &info = io->outputs[i];
+                info.name = reinterpret_cast<const char *>(desc->outDataName[i]);
+                info.type = DlInferType_Float32;
+                info.shape = {1, desc->outNumChannels[i], desc->outHeight[i], desc->outWidth[i]};
+            }
+            return RETURN_SUCCESS;
+        }
+
+        int32_t TidlrtInferer::readIO(const std::string &artifactsPath, IODescription *io)
+        {
+            std::string ioName = findArtifact(artifactsPath, "io_1.bin");
+            if (ioName.empty())
+            {
+                LOG_ERROR("No IO config file in %s\n", artifactsPath.c_str());
+                return RETURN_FAIL;
+            }
+            int32_t size = 0;
+            void *data = mapFile(ioName, &size);
+            if (data == nullptr)
+                return RETURN_FAIL;
+            int32_t status = parseIODesc(data, size, io);
+            munmap(data, size);
+            return status;
+        }
+
+        TidlrtInferer::TidlrtInferer() : m_handle(nullptr),
+                                         m_deviceMem(false),
+                                         m_current(nullptr)
+        {
+            memset(&m_params, 0, sizeof(m_params));
+        }
+
+        TidlrtInferer::~TidlrtInferer()
+        {
+            if (m_handle != nullptr)
+            {
+                TIDLRT_deactivate(m_handle);
+                TIDLRT_delete(m_handle);
+            }
+            m_sets.clear();
+            m_buffers.clear();
+            if (m_params.netPtr != nullptr)
+                munmap(m_params.netPtr, m_params.net_capacity);
+            if (m_params.ioBufDescPtr != nullptr)
+                munmap(m_params.ioBufDescPtr, m_params.io_capacity);
+        }
+
+        int32_t TidlrtInferer::allocTensor(sTIDLRT_Tensor_t *tensor, const TensorInfo &info, int32_t layout)
+        {
+            TIDLRT_setTensorDefault(tensor);
+            tensor->layout = layout;
+            tensor->elementType = toTidlrtType(info.type);
+            strncpy((char *)tensor->name, info.name.c_str(), TIDLRT_STRING_SIZE - 1);
+            size_t size = info.getSizeBytes();
+            PooledBuffer buffer = SharedTensorPool::get().acquire(size, SharedTensorPool::MIN_ALIGNMENT, m_deviceMem);
+            if (!buffer)
+            {
+                LOG_ERROR("Could not allocate %d bytes for %s\n", (int32_t)size, info.name.c_str());
+                return RETURN_FAIL;
+            }
+            if (m_deviceMem)
+                tensor->memType = TIDLRT_MEM_SHARED;
+            tensor->ptr = buffer.data();
+            m_buffers.push_back(std::move(buffer));
+            return RETURN_SUCCESS;
+        }
+
+        int32_t TidlrtInferer::load(const InfererConfig &config,
+                                    const InfererOptions &options)
+        {
+            const std::string &artifactsPath = options.artifactsPath.empty() ? config.artifactsPath : options.artifactsPath;
+            std::string netName = findArtifact(artifactsPath, "net.bin");
+            std::string ioName = findArtifact(artifactsPath, "io_1.bin");
+            LOG_INFO("Model Files names : %s,%s\n", netName.c_str(), ioName.c_str());
+
+            /* the files are mapped, not copied, TIDL-RT reads them once
+            while creating the handle */
+            TIDLRT_setParamsDefault(&m_params);
+            m_params.stats = &m_stats;
+            m_params.netPtr = mapFile(netName, &m_params.net_capacity);
+            if (m_params.netPtr == NULL)
+            {
+                LOG_ERROR("Unable to read network file %s \n", netName.c_str());
+                return RETURN_FAIL;
+            }
+            m_params.ioBufDescPtr = mapFile(ioName, &m_params.io_capacity);
+            if (m_params.ioBufDescPtr == NULL)
+            {
+                LOG_ERROR("Unable to read IO config file %s \n", ioName.c_str());
+                return RETURN_FAIL;
+            }
+            if (RETURN_FAIL == parseIODesc(m_params.ioBufDescPtr, m_params.io_capacity, &m_io))
+                return RETURN_FAIL;
+
+            if (TIDLRT_create(&m_params, &m_handle) != 0)
+            {
+                LOG_ERROR("TIDLRT_create failed\n");
+                m_handle = nullptr;
+                return RETURN_FAIL;
+            }
+
+            m_deviceMem = options.deviceMem;
+            m_sets.clear();
+            return setTensorSets(1);
+        }
+
+        /**
+         * Adds one set of input and output tensors.
+         *
+         * @returns RETURN_SUCCESS or RETURN_FAIL
+         */
+        int32_t TidlrtInferer::addTensorSet()
+        {
+            std::unique_ptr<TensorSet> set(new TensorSet);
+            set->in.resize(m_io.inputs.size());
+            set->out.resize(m_io.outputs.size());
+            for (size_t i = 0; i < set->in.size(); i++)
+            {
+                if (allocTensor(&set->in[i], m_io.inputs[i], TIDLRT_LT_NHWC) == RETURN_FAIL)
+                    return RETURN_FAIL;
+                set->inPtrs.push_back(&set->in[i]);
+            }
+            set->outputs.resize(set->out.size());
+            for (size_t i = 0; i < set->out.size(); i++)
+            {
+                if (allocTensor(&set->out[i], m_io.outputs[i], TIDLRT_LT_NCHW) == RETURN_FAIL)
+                    return RETURN_FAIL;
+                set->outPtrs.push_back(&set->out[i]);
+                set->outputs[i].data = set->out[i].ptr;
+                set->outputs[i].type = m_io.outputs[i].type;
+                set->outputs[i].shape = m_io.outputs[i].shape;
+            }
+            m_sets.push_back(std::move(set));
+            return RETURN_SUCCESS;
+        }
+
+        int32_t TidlrtInferer::setTensorSets(int32_t count)
+        {
+            if (count < 1)
+            {
+                LOG_ERROR("invalid number of tensor sets %d\n", count);
+                return RETURN_FAIL;
+            }
+            while ((int32_t)m_sets.size() < count)
+            {
+                if (addTensorSet() == RETURN_FAIL)
+                    return RETURN_FAIL;
+            }
+            return selectTensorSet(0);
+        }
+
+        int32_t TidlrtInferer::selectTensorSet(int32_t index)
+        {
+            if (index < 0 || index >= (int32_t)m_sets.size())
+            {
+                LOG_ERROR("invalid tensor set %d\n", index);
+                return RETURN_FAIL;
+            }
+            m_current = m_sets[index].get();
+            m_outputs = m_current->outputs;
+            return RETURN_SUCCESS;
+        }
+
+        TensorView TidlrtInferer::getInput(int32_t index)
+        {
+            TensorView view = Inferer::getInput(index);
+            if (view.type != DlInferType_Invalid)
+            {
+                view.data = m_current->in[index].ptr;
+            }
+            return view;
+        }
+
+        int32_t TidlrtInferer::bindInput(int32_t index, const TensorView &view)
+        {
+            if (index < 0 || index >= static_cast<int32_t>(m_current->in.size()))
+            {
+                LOG_ERROR("invalid input index %d\n", index);
+                return RETURN_FAIL;
+            }
+            /* the tensor points at the caller's memory, nothing is copied */
+            sTIDLRT_Tensor_t &tensor = m_current->in[index];
+            tensor.ptr = view.data;
+            tensor.memType = TIDLRT_isSharedMem(view.data) ? TIDLRT_MEM_SHARED : TIDLRT_MEM_USER_SPACE;
+            return RETURN_SUCCESS;
+        }
+
+        int32_t TidlrtInferer::run()
+        {
+            if (TIDLRT_invoke(m_handle, m_current->inPtrs.data(), m_current->outPtrs.data()) != 0)
+            {
+                LOG_ERROR("TIDLRT_invoke failed\n");
+                return RETURN_FAIL;
+            }
+            return RETURN_SUCCESS;
+        }
+
+    } // namespace tidl::inferer
+}
@@ -60,6 +60,12 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
 #include "../include/utility_functs.h"
 namespace tidl
 {
@@ -88,5 +94,127 @@ namespace tidl
             }
             return isFormat;
         }
+
+        /**
+  *  \brief parses a CPU list such as "0,2-3" into cpu ids
+  * @returns RETURN_SUCCESS, RETURN_FAIL for a malformed list or a cpu id
+  *          of CPU_SETSIZE or more
+  */
+        int32_t parseCpuList(const std::string &list, std::vector<int32_t> *cpus)
+        {
+            cpus->clear();
+            const char *p = list.c_str();
+            while (*p)
+            {
+                char *end;
+                long first = strtol(p, &end, 10);
+                if (end == p || first < 0)
+                    return RETURN_FAIL;
+                long last = first;
+                p = end;
+                if (*p == '-')
+                {
+                    last = strtol(p + 1, &end, 10);
+                    if (end == p + 1 || last < first)
+                        return RETURN_FAIL;
+                    p = end;
+                }
+                /* cpu ids past the affinity mask are rejected anyway, stop
+                before a huge range is expanded */
+                if (last >= CPU_SETSIZE)
+                    return RETURN_FAIL;
+                for (long cpu = first; cpu <= last; cpu++)
+                    cpus->push_back(cpu);
+                if (*p == ',')
+                    p++;
+                else if (*p)
+                    return RETURN_FAIL;
+            }
+            return cpus->empty() ? RETURN_FAIL : RETURN_SUCCESS;
+        }
+
+        /**
+  *  \brief pins the calling thread to a set of cpus
+  * @returns RETURN_SUCCESS or RETURN_FAIL
+  */
+        int32_t setThreadAffinity(const std::vector<int32_t> &cpus)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int32_t cpu : cpus)
+            {
+                if (cpu < 0 || cpu >= CPU_SETSIZE)
+                    return RETURN_FAIL;
+                CPU_SET(cpu, &set);
+            }
+            if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+                return RETURN_FAIL;
+            return RETURN_SUCCESS;
+        }
+
+        ScopedThreadAffinity::ScopedThreadAffinity() : m_valid(false),
+                                                       m_changed(false)
+        {
+            CPU_ZERO(&m_saved);
+            m_valid = pthread_getaffinity_np(pthread_self(), sizeof(m_saved), &m_saved) == 0;
+        }
+
+        ScopedThreadAffinity::~ScopedThreadAffinity()
+        {
+            if (m_changed && m_valid)
+                pthread_setaffinity_np(pthread_self(), sizeof(m_saved), &m_saved);
+        }
+
+        int32_t ScopedThreadAffinity::set(const std::vector<int32_t> &cpus)
+        {
+            /* without the saved mask the thread could not be unpinned */
+            if (!m_valid)
+                return RETURN_FAIL;
+            m_changed = true;
+            return setThreadAffinity(cpus);
+        }
+
+        /**
+  *  \brief returns the resident set size of the process in bytes
+  * @returns size_t
+  */
+        size_t getResidentBytes()
+        {
+            long pages = 0, resident = 0;
+            FILE *fp = fopen("/proc/self/statm", "r");
+            if (fp == NULL)
+                return 0;
+            if (fscanf(fp, "%ld %ld", &pages, &resident) != 2)
+                resident = 0;
+            fclose(fp);
+            return (size_t)resident * sysconf(_SC_PAGESIZE);
+        }
+
+        size_t getPeakResidentBytes()
+        {
+            char line[128];
+            size_t peak_kb = 0;
+            FILE *fp = fopen("/proc/self/status", "r");
+            if (fp == NULL)
+                return 0;
+            while (fgets(line, sizeof(line), fp) != NULL)
+            {
+                if (sscanf(line, "VmHWM: %zu kB", &peak_kb) == 1)
+                    break;
+            }
+            fclose(fp);
+            return peak_kb * 1024;
+        }
+
+        int32_t resetPeakResidentBytes()
+        {
+            /* 5 resets VmHWM, since Linux 4.0 */
+            FILE *fp = fopen("/proc/self/clear_refs", "w");
+            if (fp == NULL)
+                return RETURN_FAIL;
+            bool written = fputs("5", fp) >= 0;
+            written = fclose(fp) == 0 && written;
+            return written ? RETURN_SUCCESS : RETURN_FAIL;
+        }
     }
 }
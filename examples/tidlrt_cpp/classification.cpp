@@ -49,294 +49,67 @@ limitations under the License.
 
 
 #include "itidl_rt.h"
+#include "osrt_cpp/runner/runner.h"
+#include "osrt_cpp/utils/include/tidlrt_inferer.h"
+#include "osrt_cpp/utils/include/ti_logger.h"
 
 #define LOG(x) std::cerr
 
-void* in_ptrs[16] = {NULL};
-void* out_ptrs[16]= {NULL};
-
-double get_us(struct timeval t) { return (t.tv_sec * 1000000 + t.tv_usec); }
-
-// Takes a file name, and loads a list of labels from it, one per line, and
-// returns a vector of the strings. It pads with empty strings so the length
-// of the result is a multiple of 16, because our model expects that.
-int32_t ReadLabelsFile(const std::string& file_name,
-                            std::vector<std::string>* result,
-                            size_t* found_label_count) {
-  std::ifstream file(file_name);
-  if (!file) {
-    LOG(FATAL) << "Labels file " << file_name << " not found\n";
-    return -1;
-  }
-  result->clear();
-  std::string line;
-  while (std::getline(file, line)) {
-    result->push_back(line);
-  }
-  *found_label_count = result->size();
-  const int padding = 16;
-  while (result->size() % padding) {
-    result->emplace_back();
-  }
-  return 0;
-}
-
-// Returns the top N confidence values over threshold in the provided vector,
-// sorted by confidence in descending order.
-template <class T>
-void get_top_n(T* prediction, int prediction_size, size_t num_results,
-               float threshold, std::vector<std::pair<float, int>>* top_results,
-               bool input_floating) {
-  // Will contain top N results in ascending order.
-  std::priority_queue<std::pair<float, int>, std::vector<std::pair<float, int>>,
-                      std::greater<std::pair<float, int>>>
-      top_result_pq;
-
-  const long count = prediction_size;  // NOLINT(runtime/int)
-  for (int i = 0; i < count; ++i) {
-    float value;
-    if (input_floating)
-      value = prediction[i];
-    else
-      value = prediction[i] / 255.0;
-    // Only add it if it beats the threshold and has a chance at being in
-    // the top N.
-    if (value < threshold) {
-      continue;
-    }
-
-    top_result_pq.push(std::pair<float, int>(value, i));
-
-    // If at capacity, kick the smallest value out.
-    if (top_result_pq.size() > num_results) {
-      top_result_pq.pop();
-    }
-  }
-
-  // Copy to output vector and reverse into descending order.
-  while (!top_result_pq.empty()) {
-    top_results->push_back(top_result_pq.top());
-    top_result_pq.pop();
-  }
-
-  std::reverse(top_results->begin(), top_results->end());
-}
-
-template <class T>
-int preprocImage(const std::string &input_image_name, T *out, int wanted_height, int wanted_width, int wanted_channels, float mean, float scale)
-{
-    int i;
-    uint8_t *pSrc;
-    cv::Mat image = cv::imread(input_image_name, cv::IMREAD_COLOR);
-    cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
-    cv::resize(image, image, cv::Size(wanted_width, wanted_height), 0, 0, cv::INTER_AREA);
-
-    if (image.channels() != wanted_channels)
-    {
-      printf("Warning : Number of channels wanted differs from number of channels in the actual image \n");
-      return (-1);
-    }
-    pSrc = (uint8_t *)image.data;
-    for (i = 0; i < wanted_height * wanted_width * wanted_channels; i++)
-      out[i] = ((T)pSrc[i] - mean) / scale;
-    return 0;
-}
-
-
-void getModelNameromArtifactsDir(char* path, char * net_name, char *io_name)
-{
-  char sys_cmd[500];
-  sprintf(sys_cmd, "ls %s/*net.bin | head -1", path);
-  FILE * fp = popen(sys_cmd,  "r");
-  if (fp == NULL)
-  {
-    printf("Error while runing command : %s", sys_cmd);
-  }
-  fscanf(fp, "%s", net_name);
-  fclose(fp);
-
-  sprintf(sys_cmd, "ls %s/*io_1.bin | head -1", path);
-  fp = popen(sys_cmd,  "r");
-  if (fp == NULL)
-  {
-    printf("Error while runing command : %s", sys_cmd);
-  }
-  fscanf(fp, "%s", io_name);
-  fclose(fp);
-  return;
-}
-int32_t TIDLReadBinFromFile(const char *fileName, void *addr, int32_t size)
-{
-    FILE *fptr = NULL;
-    fptr = fopen((const char *)fileName, "rb");
-    if (fptr)
-    {
-      fread(addr, size, 1, fptr);
-      fclose(fptr);
-      return 0;
-    }
-    else
-    {
-      printf("Could not open %s file for reading \n", fileName);
-    }
-    return -1;
-}
-
 int RunInference(Settings* s) {
-
-  char net_name[512];
-  char io_name[512];
-
-  getModelNameromArtifactsDir((char *)s->artifact_path.c_str(), net_name, io_name);
-
-  printf("Model Files names : %s,%s\n", net_name, io_name);
-
-  sTIDLRT_Params_t prms;
-  void *handle = NULL;
-  int32_t status;
-
-  status = TIDLRT_setParamsDefault(&prms);
-
-
-  FILE * fp_network = fopen(net_name, "rb");
-  if (fp_network == NULL)
-  {
-    printf("Invoke  : ERROR: Unable to open network file %s \n", net_name);
+  /* describe the model the way a param.yaml would, TIDL-RT takes the
+  network and io config straight from the artifacts folder */
+  tidl::modelInfo::ModelInfo model;
+  model.m_infConfig.rtType = "tidlrt";
+  model.m_infConfig.artifactsPath = s->artifact_path;
+
+  /* the input size comes from the io descriptor of the network */
+  tidl::inferer::Inferer::IODescription io;
+  if (tidl::inferer::TidlrtInferer::readIO(s->artifact_path, &io) == RETURN_FAIL) {
+    LOG(FATAL) << "Could not read the io config in " << s->artifact_path << "\n";
     return -1;
   }
-  sTIDLRT_PerfStats_t *stats = 
-  prms.stats = (sTIDLRT_PerfStats_t*)malloc(sizeof(sTIDLRT_PerfStats_t));
-
-  fseek(fp_network, 0, SEEK_END);
-  prms.net_capacity = ftell(fp_network);
-  fseek(fp_network, 0, SEEK_SET);
-  fclose(fp_network);
-  prms.netPtr = malloc(prms.net_capacity);
-
-  status = TIDLReadBinFromFile(net_name, prms.netPtr, prms.net_capacity);
-
-  FILE * fp_config = fopen(io_name, "rb");
-  if (fp_config == NULL)
-  {
-    printf("Invoke  : ERROR: Unable to open IO config file %s \n", io_name);
+  const std::vector<int64_t> &inShape = io.inputs[0].shape;
+
+  tidl::modelInfo::PreprocessImageConfig &preProcCfg = model.m_preProcCfg;
+  preProcCfg.modelName = "tidlrt_classification";
+  preProcCfg.rtType = "tidlrt";
+  preProcCfg.taskType = "classification";
+  preProcCfg.outDataWidth = inShape[2];
+  preProcCfg.outDataHeight = inShape[1];
+  preProcCfg.numChans = inShape[3];
+  preProcCfg.dataLayout = "NHWC";
+  /* float inputs are normalized here; integer inputs take the raw pixels,
+  the import folds the normalization into the network and (x - mean) / std
+  would not fit the type */
+  if (io.inputs[0].type == tidl::modelInfo::DlInferType_Float32) {
+    preProcCfg.mean = {s->input_mean, s->input_mean, s->input_mean};
+    preProcCfg.scale = {1 / s->input_std, 1 / s->input_std, 1 / s->input_std};
+  } else {
+    preProcCfg.mean = {0, 0, 0};
+    preProcCfg.scale = {1, 1, 1};
+  }
+
+  model.m_labels = tidl::utils::LabelStore::open(s->labels_file_name);
+  if (!model.m_labels) {
+    LOG(FATAL) << "Labels file " << s->labels_file_name << " not found\n";
     return -1;
   }
-  fseek(fp_config, 0, SEEK_END);
-  prms.io_capacity = ftell(fp_config);
-  fseek(fp_config, 0, SEEK_SET);
-  fclose(fp_config);
-  prms.ioBufDescPtr = malloc(prms.io_capacity);
-  status = TIDLReadBinFromFile(io_name, prms.ioBufDescPtr, prms.io_capacity);
-
-  //prms.traceLogLevel = 3;
-  //prms.traceWriteLevel = 3;
-
-  status = TIDLRT_create(&prms, &handle);
-
-  sTIDLRT_Tensor_t *in[16];
-  sTIDLRT_Tensor_t *out[16];
-
-  sTIDLRT_Tensor_t in_tensor;
-  sTIDLRT_Tensor_t out_tensor;
-
-  int32_t j = 0;
-  in[j] = &in_tensor;
-  status = TIDLRT_setTensorDefault(in[j]);
-  in[j]->layout = TIDLRT_LT_NHWC;
-  //strcpy((char *)in[j]->name, tensor->name);
-  in[j]->elementType = TIDLRT_Float32;
-  int32_t in_tensor_szie = 224 * 224 * 3 * sizeof(float);
-
-  if (s->device_mem)
-  { 
-      in_ptrs[j] =
-      in[j]->ptr =  TIDLRT_allocSharedMem(64, in_tensor_szie);
-      in[j]->memType = TIDLRT_MEM_SHARED;
-  }
-  else
-  {
-      in[j]->ptr =  malloc(in_tensor_szie);
-  }
-
-
-  out[j] = &out_tensor;
-  status = TIDLRT_setTensorDefault(out[j]);
-  out[j]->layout = TIDLRT_LT_NHWC;
-  //strcpy((char *)in[j]->name, tensor->name);
-  out[j]->elementType = TIDLRT_Float32;
-  int32_t out_tensor_szie = 1001 * sizeof(float);
-
-  if (s->device_mem)
-  { 
-      out_ptrs[j] =
-      out[j]->ptr =  TIDLRT_allocSharedMem(64, out_tensor_szie);
-      out[j]->memType = TIDLRT_MEM_SHARED;
-  }
-  else
-  {
-      out[j]->ptr =  malloc(out_tensor_szie);
-  }
-
-  status = preprocImage<float>(s->input_image_name, (float*)in[j]->ptr, 224, 224, 3, s->input_mean, s->input_std);
-
-  LOG(INFO) << "invoked \n";
 
-  struct timeval start_time, stop_time;
-  gettimeofday(&start_time, nullptr);
-
-  for (int i = 0; i < s->loop_count; i++)
-  {
-    TIDLRT_invoke(handle, in, out);
-  }
-
-  gettimeofday(&stop_time, nullptr);
-
-  LOG(INFO) << "average time: "
-            << (get_us(stop_time) - get_us(start_time)) / (s->loop_count * 1000)
-            << " ms \n";
-  const float threshold = 0.001f;
-
-  std::vector<std::pair<float, int>> top_results;
-
-  float *output = (float *)out[j]->ptr;
-  int output_size = 1001;
-
-  get_top_n<float>(output, output_size,
-                    s->number_of_results, threshold, &top_results, true);
-
-  std::vector<std::string> labels;
-  size_t label_count;
-
-  if (ReadLabelsFile(s->labels_file_name, &labels, &label_count) != 0)
-    exit(-1);
-
-  for (const auto &result : top_results)
-  {
-    const float confidence = result.first;
-    int index = result.second;
-    LOG(INFO) << confidence << ": " << index << " " << labels[index] << "\n";
-  }
-
-  status = TIDLRT_deactivate(handle);
-  status = TIDLRT_delete(handle);
-
-  if (s->device_mem)
-  {
-    for (uint32_t i = 0; i < 1; i++)
-    {
-      if (in_ptrs[i])
-      {
-        TIDLRT_freeSharedMem(in_ptrs[i]);
-      }
-    }
-    for (uint32_t i = 0; i < 1; i++)
-    {
-      if (out_ptrs[i])
-      {
-        TIDLRT_freeSharedMem(out_ptrs[i]);
-      }
-    }
-  }
+  tidl::arg_parsing::Settings runnerSettings;
+  runnerSettings.accel = s->accel;
+  runnerSettings.device_mem = s->device_mem;
+  runnerSettings.loop_count = s->loop_count;
+  runnerSettings.number_of_warmup_runs = s->number_of_warmup_runs;
+  runnerSettings.tensor_sets = s->tensor_sets;
+  runnerSettings.number_of_results = s->number_of_results;
+  runnerSettings.artifact_path = s->artifact_path;
+  runnerSettings.input_bmp_path = s->input_image_name;
+  runnerSettings.output_mode = tidl::arg_parsing::OUTPUT_MODE_NONE;
+  runnerSettings.log_level = s->verbose ? tidl::utils::DEBUG : tidl::utils::INFO;
+  tidl::utils::logSetLevel((tidl::utils::LogLevel)runnerSettings.log_level);
+
+  if (tidl::runner::runInference(&model, &runnerSettings) == RETURN_FAIL)
+    return -1;
   return 0;
 }
 
@@ -348,8 +121,8 @@ void display_usage() {
       << "--artifact_path, -f: [0|1], Path for Delegate artifacts folder \n"
       << "--count, -c: loop interpreter->Invoke() for certain times\n"
       << "--gl_backend, -g: use GL GPU Delegate on Android\n"
-      << "--input_mean, -b: input mean\n"
-      << "--input_std, -s: input standard deviation\n"
+      << "--input_mean, -b: input mean, float inputs only\n"
+      << "--input_std, -s: input standard deviation, float inputs only\n"
       << "--image, -i: image_name.bmp\n"
       << "--labels, -l: labels for the model\n"
       << "--tflite_model, -m: model_name.tflite\n"
@@ -358,6 +131,8 @@ void display_usage() {
       << "--threads, -t: number of threads\n"
       << "--verbose, -v: [0|1] print more information\n"
       << "--warmup_runs, -w: number of warmup runs\n"
+      << "--tensor_sets, -k: tensor sets, above 1 preprocessing and\n"
+      << "    post-processing overlap with TIDLRT_invoke\n"
       << "\n";
 }
 
@@ -383,13 +158,14 @@ int main(int argc, char** argv) {
         {"max_profiling_buffer_entries", required_argument, nullptr, 'e'},
         {"warmup_runs", required_argument, nullptr, 'w'},
         {"gl_backend", required_argument, nullptr, 'g'},
+        {"tensor_sets", required_argument, nullptr, 'k'},
         {nullptr, 0, nullptr, 0}};
 
     /* getopt_long stores the option index here. */
     int option_index = 0;
 
     c = getopt_long(argc, argv,
-                    "a:b:c:d:e:f:g:i:l:m:p:r:s:t:v:w:", long_options,
+                    "a:b:c:d:e:f:g:i:k:l:m:p:r:s:t:v:w:", long_options,
                     &option_index);
 
     /* Detect the end of the options. */
@@ -424,6 +200,10 @@ int main(int argc, char** argv) {
       case 'i':
         s.input_image_name = optarg;
         break;
+      case 'k':
+        s.tensor_sets =
+            strtol(optarg, nullptr, 10);  // NOLINT(runtime/deprecated_fn)
+        break;
       case 'l':
         s.labels_file_name = optarg;
         break;
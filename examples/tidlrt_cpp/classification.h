@@ -85,6 +85,7 @@ struct Settings {
   int number_of_results = 5;
   int max_profiling_buffer_entries = 1024;
   int number_of_warmup_runs = 2;
+  int tensor_sets = 1;
 };
 
 #endif   //TIDLRT_C_EXAMPLE